@@ -8,14 +8,14 @@ void groupInfo(const Message message, const Api& api){
     std::string ChatInfo;
     try{
         api_types::Chat GChat=api.getChat(std::to_string(message.chat.id));
-        if(GChat.title){
-            ChatInfo+="Title:"+*(GChat.title)+"\n";
+        if(GChat.title()){
+            ChatInfo+="Title:"+*GChat.title()+"\n";
         }
-        if(GChat.username){
-            ChatInfo+="Username or link:"+*(GChat.username)+"\n";
+        if(GChat.username()){
+            ChatInfo+="Username or link:"+*GChat.username()+"\n";
         }
-        if(GChat.firstName){
-            ChatInfo+="First Name:"+*(GChat.firstName)+"\n";
+        if(GChat.firstName()){
+            ChatInfo+="First Name:"+*GChat.firstName()+"\n";
         }
         if(GChat.lastName){
             ChatInfo+="Last Name:"+*(GChat.lastName)+"\n";
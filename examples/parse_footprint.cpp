@@ -0,0 +1,117 @@
+/*
+ * Memory footprint of parsed updates: heap allocations and bytes per update,
+ * on a mix of private texts, group replies, captioned photos and callback
+ * queries.
+ *
+ * g++ -std=c++11 -O2 parse_footprint.cpp -o parse_footprint \
+ *     $(pkg-config --cflags --libs jsoncpp) -lxxtelebot -lcurl -pthread
+ */
+#include <tgbot/types.h>
+#include <json/json.h>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace tgbot;
+
+static std::size_t nAllocations = 0;
+static std::size_t nBytes = 0;
+
+// out of line: GCC would take the free() below for a mismatched deallocation
+__attribute__((noinline)) void *operator new(std::size_t size) {
+	++nAllocations;
+	nBytes += size;
+
+	if (void *memory = std::malloc(size ? size : 1)) return memory;
+	throw std::bad_alloc();
+}
+
+__attribute__((noinline)) void operator delete(void *ptr) noexcept {
+	std::free(ptr);
+}
+
+static const char *const sampleUpdates[] = {
+	// private text
+	R"({"update_id":1,"message":{"message_id":10,"date":1560000000,
+	 "from":{"id":1001,"is_bot":false,"first_name":"Alice","last_name":"Smith",
+	 "username":"alice_s","language_code":"en"},
+	 "chat":{"id":1001,"type":"private","first_name":"Alice","last_name":"Smith",
+	 "username":"alice_s"},
+	 "text":"hello, could you send me the latest report please?"}})",
+
+	// group reply
+	R"({"update_id":2,"message":{"message_id":11,"date":1560000001,
+	 "from":{"id":1002,"is_bot":false,"first_name":"Bob","username":"bob_b",
+	 "language_code":"it"},
+	 "chat":{"id":-2001,"type":"supergroup","title":"Weekend hiking group",
+	 "username":"hiking_we"},
+	 "reply_to_message":{"message_id":9,"date":1559999990,
+	  "from":{"id":1003,"is_bot":false,"first_name":"Carol","language_code":"en"},
+	  "chat":{"id":-2001,"type":"supergroup","title":"Weekend hiking group",
+	  "username":"hiking_we"},
+	  "text":"who is coming on sunday?"},
+	 "text":"count me in"}})",
+
+	// captioned photo
+	R"({"update_id":3,"message":{"message_id":12,"date":1560000002,
+	 "from":{"id":1003,"is_bot":false,"first_name":"Carol","language_code":"en"},
+	 "chat":{"id":-2001,"type":"supergroup","title":"Weekend hiking group",
+	 "username":"hiking_we"},
+	 "photo":[{"file_id":"AgADBAADv6kxGz1kAAHwAAE","file_size":1290,"width":90,"height":67},
+	  {"file_id":"AgADBAADv6kxGz1kAAHwAAF","file_size":19882,"width":320,"height":240},
+	  {"file_id":"AgADBAADv6kxGz1kAAHwAAG","file_size":81273,"width":800,"height":600}],
+	 "caption":"view from the top"}})",
+
+	// callback query
+	R"({"update_id":4,"callback_query":{"id":"4382bfdwdsb323b2d9",
+	 "from":{"id":1001,"is_bot":false,"first_name":"Alice","last_name":"Smith",
+	 "username":"alice_s","language_code":"en"},
+	 "message":{"message_id":13,"date":1560000003,
+	  "from":{"id":5000,"is_bot":true,"first_name":"Report bot","username":"report_bot"},
+	  "chat":{"id":1001,"type":"private","first_name":"Alice","last_name":"Smith",
+	  "username":"alice_s"},
+	  "text":"pick a report"},
+	 "chat_instance":"-8832471239841","data":"report:weekly"}})"
+};
+
+int main() {
+	constexpr int nBatches = 200;
+	constexpr int batchSize = 100;  // getUpdates limit
+
+	std::vector<Json::Value> batch;
+	for (int i = 0; i < batchSize; ++i) {
+		Json::Value update;
+		std::istringstream json(sampleUpdates[i % 4]);
+		json >> update;
+		batch.push_back(update);
+	}
+
+	std::printf("sizeof: Update %zu, Message %zu, Chat %zu, User %zu, "
+	            "CallbackQuery %zu\n\n",
+	            sizeof(types::Update), sizeof(types::Message), sizeof(types::Chat),
+	            sizeof(types::User), sizeof(types::CallbackQuery));
+
+	nAllocations = nBytes = 0;
+
+	for (int n = 0; n < nBatches; ++n) {
+		std::vector<types::Update> parsed;
+		parsed.reserve(batchSize);
+
+		for (const Json::Value &update : batch) parsed.emplace_back(update);
+	}
+
+	const double nUpdates = nBatches * batchSize;
+	const double allocations = (nAllocations - nBatches) / nUpdates;
+	const double bytes =
+			(nBytes - nBatches * batchSize * sizeof(types::Update)) / nUpdates;
+
+	// requested sizes, malloc overhead excluded; the vector of batch updates
+	// is counted as sizeof(Update) each
+	std::printf("heap: %4.1f allocs %6.1f bytes   total: %6.1f bytes/update\n",
+	            allocations, bytes, sizeof(types::Update) + bytes);
+
+	return 0;
+}
@@ -1,11 +1,21 @@
 #ifndef TGBOT_BOT_H
 #define TGBOT_BOT_H
 
+#include <chrono>
 #include <exception>
+#include <functional>
+#include <memory>
+#include <thread>
 #include <utility>
 
 #include "register_callback.h"
+#include "trace.h"
+#include "utils/callback_data.h"
+#include "utils/cancel.h"
+#include "utils/coalescer.h"
+#include "utils/entity_cache.h"
 #include "utils/https.h"
+#include "utils/worker_pool.h"
 
 /*!
  * @brief Main tgbot namespace
@@ -46,16 +56,205 @@ namespace tgbot {
 		 */
 		void notifyEachUpdate(bool t);
 
+		/*!
+		 * @brief run handlers on a worker pool instead of a new thread each
+		 * @param workers : pool, shared with other bots if you like
+		 * @param queue : queue of this bot (see utils::WorkerPool::addQueue())
+		 */
+		void runHandlersOn(std::shared_ptr<utils::WorkerPool> workers,
+		                   std::size_t queue);
+
+		/*!
+		 * @brief deserialize each batch on a parse pool (one thread per core
+		 * and one queue, shared by all bots, apart from handler workers), one
+		 * task per chat: updates are dispatched as soon as they're parsed, in order
+		 * within a chat. Handlers then run as usual, possibly concurrently.
+		 * The next batch is requested once the whole batch is dispatched
+		 * (false by default)
+		 * @param t: true - yes / false - no
+		 */
+		void parseBatchesInParallel(bool t);
+
+		/*!
+		 * @brief write received updates to a journal before dispatching them;
+		 * updates whose handler didn't finish (crash, kill) are dispatched
+		 * again at next start(), and polling resumes after the journaled ones
+		 * @param path : journal file (see utils::UpdateJournal)
+		 * @param syncEachBatch : msync each batch, survives power loss (slower)
+		 * @param maxAttempts : dispatches of an update before it's given up
+		 * on (logged, tgbot_journal_given_up_total), so that one killing the
+		 * process isn't replayed forever
+		 */
+		void useJournal(const std::string &path, bool syncEachBatch = false,
+		                unsigned maxAttempts = 3);
+
+		/*!
+		 * @brief drop updates the filter rejects, looking at their JSON only:
+		 * they're never deserialized nor dispatched. Drops are counted in
+		 * tgbot_updates_dropped_total{type}
+		 * @param keep : returns true to keep an update (see filters namespace)
+		 */
+		void preFilter(filters::UpdateFilter keep);
+
+		/*!
+		 * @brief keep only the newest inline query of each user: queries
+		 * superseded before their handler starts are skipped, running
+		 * handlers get cancelled (their pending Bot API calls throw
+		 * utils::http::TransferCancelled, long searches can check
+		 * utils::CancelToken::current()) (false by default)
+		 * @param t: true - yes / false - no
+		 */
+		void coalesceInlineQueries(bool t);
+
+		/*!
+		 * @brief callback queries whose data is a token of store get the
+		 * payload as data before reaching the handler. Unknown (expired)
+		 * tokens are left as they are, and counted in
+		 * tgbot_callback_data_unresolved_total
+		 * @param store : where buttons' payloads were put
+		 */
+		void resolveCallbackData(std::shared_ptr<utils::CallbackDataStore> store);
+
+		/*!
+		 * @brief reuse responses of getChat, getChatMember,
+		 * getChatAdministrators, getChatMembersCount and getStickerSet;
+		 * entries made stale by incoming updates (members joining or
+		 * leaving, title changes...) are dropped before the pre-filter and
+		 * dispatch. Message and channel post updates are polled for even
+		 * without a callback (then dropped once seen); allowed updates given
+		 * at construction must include them, or the cache can't see changes
+		 * @param cache : responses, shared with other bots if you like
+		 */
+		void cacheChatQueries(std::shared_ptr<methods::ChatQueryCache> cache);
+
+		/*!
+		 * @brief record users and chats of incoming updates in cache, so
+		 * that handlers can look them up by id (see utils::EntityCache)
+		 * @param cache : entities, shared with other bots if you like
+		 */
+		void trackEntities(std::shared_ptr<utils::EntityCache> cache);
+
 	protected:
 		template<typename... TyArgs>
 		explicit Bot(TyArgs &&... many) : Api(std::forward<TyArgs>(many)...) {
 			utils::http::__internal_Curl_GlobalInit();
 		}
 
-		void makeCallback(const std::vector<types::Update> &updates) const;
+		void makeCallback(std::vector<types::Update> &updates) const;
+
+		/*!
+		 * @brief getUpdates(), or dispatchInParallel() if requested
+		 */
+		int fetchUpdates(void *c, std::vector<types::Update> &updates);
+
+		/*!
+		 * @brief parseUpdates(), or dispatchInParallel() if requested
+		 */
+		int receiveUpdates(const std::string &body,
+		                   std::chrono::steady_clock::time_point polledSince,
+		                   std::vector<types::Update> &updates);
+
+		/*!
+		 * @brief dispatch journaled updates left unfinished by a previous run
+		 */
+		void replayJournal();
+
+		/*!
+		 * @brief poll only for update types having a callback (unless
+		 * allowed updates were given explicitly). Done once, when polling
+		 * starts: callbacks are read unlocked, so they're registered before
+		 */
+		void deriveAllowedUpdates();
 
 	private:
+		friend class BotHost;
+
+		/*!
+		 * @brief bookkeeping for one handler run, travels with the handler thread
+		 */
+		struct HandlerTicket {
+			HandlerTicket(const types::Update &update,
+			              std::chrono::steady_clock::time_point _received,
+			              const trace::Context &_batch);
+
+			void started();
+
+			void finished();
+
+			/*!
+			 * @brief handler not run after all
+			 */
+			void dropped();
+
+			types::UpdateType updateType;
+			int updateId;
+			std::chrono::steady_clock::time_point received;
+			std::chrono::steady_clock::time_point queued;
+			std::chrono::steady_clock::time_point start;
+
+			/*!
+			 * @brief root span of this update, if tracing
+			 */
+			trace::Context context;
+
+			/*!
+			 * @brief parse span of the batch it came in, linked from the root
+			 * span
+			 */
+			trace::Context batch;
+
+			utils::CancelToken cancelToken;
+			std::uint64_t watchId{0};
+		};
+
+		/*!
+		 * @brief run a handler: tracks it, makes its cancel token and trace
+		 * context current. A handler cancelled by the Watchdog just ends
+		 */
+		template<typename _Run>
+		static void runTicket(HandlerTicket &ticket, const Bot &bot, _Run &&run);
+
+		/*!
+		 * @brief handler calls, run on their own thread or on a worker pool
+		 */
+		template<typename _Payload>
+		struct HandlerTask;
+
+		struct CommandTask;
+
+		struct InlineQueryTask;
+
+		template<typename _Task>
+		void spawn(_Task &&task) const;
+
+		template<typename _Payload>
+		void spawnHandler(const types::Update &update,
+		                  const __T_UpdateCallback<_Payload> &callback,
+		                  _Payload &payload) const;
+
+		void dispatch(types::Update &update) const;
+
+		/*!
+		 * @brief parse body, deserializing and dispatching its updates on
+		 * the parse pool; returns once they're all dispatched
+		 * @return number of updates dispatched
+		 */
+		int dispatchInParallel(const std::string &body,
+		                       std::chrono::steady_clock::time_point polledSince);
+
+		/*!
+		 * @brief callback data token -> payload
+		 */
+		void expandCallbackData(types::CallbackQuery &query) const;
+
 		bool __notifyEachUpdate{false};
+		std::shared_ptr<utils::WorkerPool> __parsers;
+		std::size_t __parseQueue{0};
+		unsigned __journalAttempts{3};
+		std::shared_ptr<utils::WorkerPool> __workers;
+		std::size_t __workerQueue{0};
+		std::shared_ptr<utils::Coalescer> __inlineQueries;
+		std::shared_ptr<utils::CallbackDataStore> __callbackData;
 	};
 
 /*!
@@ -0,0 +1,75 @@
+#ifndef TGBOT_BOT_HOST_H
+#define TGBOT_BOT_HOST_H
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bot.h"
+#include "utils/worker_pool.h"
+
+namespace tgbot {
+
+	class __HostLoop;
+
+/*!
+ * @brief Runs many long polling bots in one process: one thread drives
+ * every long poll and every outgoing Bot API call over a single curl multi
+ * handle (shared connections), handlers run on a shared worker pool
+ * serving bots round-robin.
+ *
+ * Per bot metrics are labeled bot="name": tgbot_host_polls_total,
+ * tgbot_host_poll_errors_total, tgbot_host_updates_total and the worker
+ * queue ones (see utils::WorkerPool)
+ */
+	class BotHost {
+	public:
+		/*!
+		 * @param nWorkers : handler threads shared by all bots
+		 */
+		explicit BotHost(std::size_t nWorkers = 16);
+
+		BotHost(const BotHost &) = delete;
+
+		BotHost &operator=(const BotHost &) = delete;
+
+		/*!
+		 * @brief stop() and wait for queued handlers. Hosted bots get back
+		 * to a thread per handler
+		 */
+		~BotHost();
+
+		/*!
+		 * @brief host bot, before run(). Bot must outlive this object
+		 * @param bot : bot to run (its start() must not be called)
+		 * @param name : bot label in metrics and logs (default: bot<N>)
+		 */
+		void add(LongPollBot &bot, const std::string &name = "");
+
+		/*!
+		 * @brief poll every bot until stop(). While running, Bot API calls of
+		 * the whole process go through the host event loop
+		 */
+		void run();
+
+		/*!
+		 * @brief make run() return (thread safe). Called before run(), or
+		 * while it's setting up, it makes that run() return right away
+		 */
+		void stop();
+
+	private:
+		struct Hosted {
+			Bot *bot;
+			std::string name;
+		};
+
+		std::shared_ptr<utils::WorkerPool> workers;
+		std::shared_ptr<__HostLoop> loop;
+		std::vector<Hosted> bots;
+	};
+
+}  // namespace tgbot
+
+#endif  // TGBOT_BOT_HOST_H
@@ -0,0 +1,221 @@
+#ifndef TGBOT_BROADCAST_H
+#define TGBOT_BROADCAST_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+
+#include "methods/types.h"
+#include "metrics.h"
+
+namespace tgbot {
+
+/*!
+ * @brief Sends one message to many chats: a few threads, each keeping its
+ * own connection, share a global rate. Flood waits (retry_after) pause
+ * every sender, chats migrated to a supergroup get it at their new id,
+ * transient failures are retried. Network and server errors pause every
+ * sender once they all fail; if nothing gets through while a chat uses up
+ * its attempts, the run stops there rather than giving up chat after chat.
+ *
+ * Chats that can't receive it (bot blocked, user deactivated, chat not
+ * found...) are appended to a file. Progress is checkpointed: run() again
+ * with the same source resumes after the chats already done. After a crash
+ * a few chats (at most those in flight or finished out of order) may get
+ * the message twice.
+ *
+ * Exported as tgbot_broadcast_sent_total, tgbot_broadcast_undeliverable_total,
+ * tgbot_broadcast_failed_total and tgbot_broadcast_retries_total, labeled
+ * broadcast="name"
+ */
+	class Broadcast {
+	public:
+		/*!
+		 * @brief puts the next chat id in chatId
+		 * @return false once there are no more chats
+		 */
+		using ChatSource = std::function<bool(std::int64_t &chatId)>;
+
+		struct Options {
+			/*!
+			 * @brief messages per second, all senders together (Telegram
+			 * allows about 30)
+			 */
+			double messagesPerSecond = 25;
+
+			/*!
+			 * @brief sender threads (and connections)
+			 */
+			std::size_t connections = 4;
+
+			/*!
+			 * @brief attempts per chat on network and server errors. A chat
+			 * is only given up if other sends got through meanwhile, otherwise
+			 * run() stops before it
+			 */
+			int maxAttempts = 3;
+
+			/*!
+			 * @brief progress file, none if empty. Delete it to send again
+			 */
+			std::string checkpointFile;
+
+			/*!
+			 * @brief where chats that didn't get the message are appended
+			 * ("chat id<TAB>error code<TAB>description" lines), none if empty
+			 */
+			std::string undeliverableFile;
+		};
+
+		struct Report {
+			std::uint64_t sent{0};
+			std::uint64_t undeliverable{0};  ///< refused by the chat
+			std::uint64_t failed{0};         ///< attempts exhausted
+			std::uint64_t skipped{0};        ///< done before the checkpoint
+			std::uint64_t retries{0};
+		};
+
+		/*!
+		 * @return chat ids of file, one per line (others are skipped)
+		 */
+		static ChatSource fromFile(const std::string &path);
+
+		/*!
+		 * @return chat ids in [begin, end), which must stay valid during run()
+		 */
+		template<typename _Iterator>
+		static ChatSource fromRange(_Iterator begin, _Iterator end) {
+			return [begin, end](std::int64_t &chatId) mutable {
+				if (begin == end) return false;
+
+				chatId = static_cast<std::int64_t>(*begin++);
+				return true;
+			};
+		}
+
+		/*!
+		 * @param token : bot token
+		 * @param name : broadcast label in metrics
+		 * @param options : see Options
+		 */
+		Broadcast(const std::string &token, const std::string &name,
+		          const Options &options);
+
+		Broadcast(const Broadcast &) = delete;
+
+		Broadcast &operator=(const Broadcast &) = delete;
+
+		/*!
+		 * @brief the message to send, as in methods::Api::sendMessage()
+		 */
+		void message(const std::string &text,
+		             const methods::types::ParseMode &parseMode =
+		             methods::types::ParseMode::DEFAULT,
+		             bool disableWebPagePreview = false, bool disableNotification = false,
+		             const methods::types::ReplyMarkup &replyMarkup = "");
+
+		/*!
+		 * @brief send the message to each chat of source, blocking until
+		 * they're all done or stop() is called. Throws std::runtime_error if
+		 * Telegram refuses the bot itself or the message (e.g. invalid token,
+		 * entities that can't be parsed, text too long) or can't be
+		 * reached; the checkpoint then resumes at the first chat not done
+		 */
+		Report run(ChatSource source);
+
+		/*!
+		 * @brief make run() return once sends in flight are done (thread safe)
+		 */
+		void stop();
+
+	private:
+		enum class Outcome {
+			SENT, UNDELIVERABLE, FAILED, STOPPED
+		};
+
+		void send();
+
+		Outcome sendTo(void *c, std::int64_t chatId);
+
+		/*!
+		 * @return true if the error is about the chat (403, or a 400 such as
+		 * "chat not found"), not about the bot or the message
+		 */
+		static bool refusedByChat(int errorCode, const std::string &description);
+
+		/*!
+		 * @brief record error as the reason run() throws, then stop()
+		 */
+		Outcome stopWith(const std::string &error);
+
+		/*!
+		 * @brief wait for a slot of the global rate
+		 * @return false if stopped meanwhile
+		 */
+		bool acquireSlot();
+
+		void pauseAll(std::chrono::seconds pause);
+
+		/*!
+		 * @brief sleep unless stopped
+		 * @return false if stopped
+		 */
+		bool sleepFor(std::chrono::milliseconds duration);
+
+		/*!
+		 * @brief Telegram answered (sent or refused): it is reachable
+		 */
+		void gotAnswer();
+
+		void retried();
+
+		void completed(std::uint64_t index, Outcome outcome);
+
+		/*!
+		 * @return false if the file couldn't be written
+		 */
+		bool writeCheckpoint();
+
+		void recordUndeliverable(std::int64_t chatId, int errorCode,
+		                         const std::string &description);
+
+		const Options options;
+		std::string baseApi;
+		std::string messageParams;
+
+		std::mutex sourceMtx;
+		ChatSource source;
+		std::uint64_t nextIndex{0};
+
+		std::mutex rateMtx;
+		std::condition_variable wake;
+		std::chrono::steady_clock::time_point nextSlot;
+		std::chrono::steady_clock::time_point pausedUntil;
+		std::atomic<bool> stopping{false};
+		std::atomic<std::uint64_t> answered{0};  // responses from Telegram
+		std::atomic<std::size_t> failingInARow{0};  // network errors since the last answer
+
+		std::mutex progressMtx;
+		std::uint64_t watermark{0};  // chats before it are all done
+		std::set<std::uint64_t> doneAhead;
+		std::chrono::steady_clock::time_point checkpointedAt;
+		std::ofstream undeliverableOut;
+		std::string fatalError;
+		Report report;
+
+		metrics::Counter &sent;
+		metrics::Counter &undeliverable;
+		metrics::Counter &failed;
+		metrics::Counter &retries;
+	};
+
+}  // namespace tgbot
+
+#endif  // TGBOT_BROADCAST_H
@@ -1,10 +1,29 @@
 #ifndef TGBOT_LOGGER_FACILITY_H
 #define TGBOT_LOGGER_FACILITY_H
 
+#include <chrono>
+#include <cstddef>
 #include <iostream>
+#include <memory>
 #include <string>
 
 namespace tgbot {
+
+	class __AsyncLogWriter;
+
+/*!
+ * @brief Logger severity levels, see Logger::setLevel(). Prefixed, since
+ * DEBUG and ERROR are commonly defined as macros (-DDEBUG, windows.h)
+ */
+	enum class LogLevel {
+		LEVEL_TRACE = 0,
+		LEVEL_DEBUG = 1,
+		LEVEL_INFO = 2,
+		LEVEL_WARN = 3,
+		LEVEL_ERROR = 4
+	};
+
+
 /*!
  * @brief Logging facility for telegram-bot-api, see also:
  * tgbot::methods::Api::getLogger()
@@ -13,8 +32,27 @@ namespace tgbot {
 	private:
 		std::ostream *stream{&std::cout};
 		std::string dateFormat{"%Y/%m/%d %H:%M:%S"};
+		std::shared_ptr<__AsyncLogWriter> async;
+		LogLevel level{LogLevel::LEVEL_INFO};
+
+		void write(const char *prefix, std::string const &message) const;
 
 	public:
+		/*!
+		 * @brief what to do when the asynchronous log queue is full
+		 */
+		enum class OverflowPolicy {
+			/*!
+			 * @brief discard the record (see dropped())
+			 */
+			DROP,
+
+			/*!
+			 * @brief wait for the background writer to make room
+			 */
+			BLOCK
+		};
+
 		Logger() = default;
 
 		~Logger();
@@ -29,18 +67,66 @@ namespace tgbot {
 
 		Logger &operator=(Logger &&) = delete;
 
+		/*!
+		 * @brief log with given severity (ignored if below current level)
+		 * @param logLevel: severity
+		 * @param message: log string
+		 */
+		void log(LogLevel logLevel, std::string const &message) const;
+
+		/*!
+		 * @brief log some tracing...
+		 * @param logTrace: trace string
+		 */
+		void trace(std::string const &logTrace) const;
+
+		/*!
+		 * @brief log some debug info...
+		 * @param logDebug: debug string
+		 */
+		void debug(std::string const &logDebug) const;
+
 		/*!
 		 * @brief log some info...
 		 * @param logInfo: info string
 		 */
 		void info(std::string const &logInfo) const;
 
+		/*!
+		 * @brief log some warning...
+		 * @param logWarn: warning string
+		 */
+		void warn(std::string const &logWarn) const;
+
 		/*!
 		 * @brief log some error...
 		 * @param logError: error string
 		 */
 		void error(std::string const &logError) const;
 
+		/*!
+		 * @brief set minimum severity to log, default is LogLevel::LEVEL_INFO
+		 * @param newLevel: minimum severity
+		 */
+		inline void setLevel(LogLevel newLevel) { level = newLevel; }
+
+		/*!
+		 * @return minimum severity being logged
+		 */
+		inline LogLevel getLevel() const { return level; }
+
+		/*!
+		 * @brief checks whether a record with this severity would be written,
+		 * use it (or TGBOT_LOG macros) to avoid building useless strings
+		 * @param logLevel: severity
+		 * @return true if logLevel is enabled and failbit is not set (when
+		 * logging asynchronously, only the background writer looks at the
+		 * stream)
+		 */
+		inline bool isEnabled(LogLevel logLevel) const {
+			return logLevel >= level && (async || !stream->fail());
+		}
+
 		/*!
 		 * @brief checks for failbit
 		 * @return is failbit enabled on the ostream?
@@ -52,16 +138,73 @@ namespace tgbot {
 		 * @param newStream : your new stream (might be std::cout, std::cerr, an
 		 * std::ofstream or whatever...)
 		 */
-		inline void setStream(std::ostream &newStream) { stream = &newStream; }
+		void setStream(std::ostream &newStream);
 
 		/*!
 		 * @brief set new date format, default is: "%Y/%m/%d %H:%M:%S"
 		 * @param newDateFormat: your new date format
 		 */
-		inline void setDateFormat(std::string &newDateFormat) {
-			dateFormat = std::move(newDateFormat);
-		}
+		void setDateFormat(std::string &newDateFormat);
+
+		/*!
+		 * @brief log asynchronously: info() and error() push records into a
+		 * lock-free queue, a background thread formats and writes them in
+		 * batches. Call it before starting the bot: handlers get a copy of
+		 * the logger, sharing the same background writer.
+		 * @param flushInterval : how often the background writer writes and flushes
+		 * @param capacity : queue capacity (records), rounded up to a power of two
+		 * @param policy : what to do when the queue is full
+		 */
+		void setAsync(std::chrono::milliseconds flushInterval =
+		              std::chrono::milliseconds(100),
+		              std::size_t capacity = 4096,
+		              OverflowPolicy policy = OverflowPolicy::DROP);
+
+		/*!
+		 * @brief go back to synchronous logging (pending records get written)
+		 */
+		void setSync();
+
+		/*!
+		 * @return how many records were dropped because the asynchronous
+		 * queue was full
+		 */
+		std::size_t dropped() const;
 	};
 }  // namespace tgbot
 
+/*!
+ * @brief compile-time minimum log level (0 trace ... 4 error), records below
+ * it are removed by the compiler when logged through TGBOT_LOG macros.
+ * Release builds (NDEBUG) remove TRACE records by default.
+ */
+#ifndef TGBOT_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define TGBOT_LOG_MIN_LEVEL 1
+#else
+#define TGBOT_LOG_MIN_LEVEL 0
+#endif
+#endif
+
+/*!
+ * @brief log through logger, message gets evaluated only if level is enabled
+ */
+#define TGBOT_LOG(logger, logLevel, message)                         \
+  do {                                                               \
+    if (static_cast<int>(logLevel) >= TGBOT_LOG_MIN_LEVEL &&         \
+        (logger).isEnabled(logLevel))                                \
+      (logger).log(logLevel, message);                               \
+  } while (0)
+
+#define TGBOT_LOG_TRACE(logger, message) \
+  TGBOT_LOG(logger, ::tgbot::LogLevel::LEVEL_TRACE, message)
+#define TGBOT_LOG_DEBUG(logger, message) \
+  TGBOT_LOG(logger, ::tgbot::LogLevel::LEVEL_DEBUG, message)
+#define TGBOT_LOG_INFO(logger, message) \
+  TGBOT_LOG(logger, ::tgbot::LogLevel::LEVEL_INFO, message)
+#define TGBOT_LOG_WARN(logger, message) \
+  TGBOT_LOG(logger, ::tgbot::LogLevel::LEVEL_WARN, message)
+#define TGBOT_LOG_ERROR(logger, message) \
+  TGBOT_LOG(logger, ::tgbot::LogLevel::LEVEL_ERROR, message)
+
 #endif  // TGBOT_LOGGER_FACILITY_H
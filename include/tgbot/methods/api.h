@@ -1,11 +1,27 @@
 #ifndef TGBOT_METHODS_API_H
 #define TGBOT_METHODS_API_H
 
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+
 #include "../logger.h"
+#include "../trace.h"
+#include "../update_filter.h"
+#include "../utils/https.h"
+#include "chat_query_cache.h"
+#include "inline_pager.h"
+#include "inline_result_cache.h"
 #include "types.h"
 
 namespace tgbot {
 
+	namespace utils {
+		class EntityCache;
+		class UpdateJournal;
+	}  // namespace utils
+
 /*!
  * @brief TG API methods and relative (parameter) types
  */
@@ -272,6 +288,35 @@ namespace tgbot {
 					const std::string &nextOffset = "", const std::string &switchPmText = "",
 					const std::string &switchPmParameter = "") const;
 
+			/*!
+			 * @brief answerInlineQuery through a cache: the payload sent for
+			 * the same query text and offset goes out again as is, without
+			 * building results. On miss, build() makes the answer, which gets
+			 * sent and cached (per user if isPersonal)
+			 * @param query : inline query to answer
+			 * @param cache : payload cache, shared by handlers
+			 * @param build : makes the answer on cache miss
+			 */
+			bool answerInlineQuery(const api_types::InlineQuery &query,
+			                       InlineResultCache &cache,
+			                       const std::function<types::InlineAnswer()> &build) const;
+
+			/*!
+			 * @brief answerInlineQuery with a page of a long result list: the
+			 * list is computed once per query text, then each page (query
+			 * offset) is cut from it, next_offset is filled in
+			 * @param query : inline query to answer
+			 * @param pager : result lists, shared by handlers
+			 * @param compute : makes the full result list, when not held
+			 * @param cacheTime : cache_time of answers
+			 * @param isPersonal : results depend on the user (lists held per
+			 * user)
+			 */
+			bool answerInlineQuery(
+					const api_types::InlineQuery &query, InlinePager &pager,
+					const std::function<types::InlineQueryResultsVector()> &compute,
+					const int &cacheTime = 0, const bool &isPersonal = false) const;
+
 			api_types::Message editMessageText(
 					const std::string &inlineMessageId, const std::string &text,
 					const types::ParseMode &parseMode = types::ParseMode::DEFAULT,
@@ -398,6 +443,15 @@ namespace tgbot {
 
 			inline Logger &getLogger() { return logger; }
 
+			/*!
+			 * @return unix time of the last successful getUpdates of this bot
+			 * (and of its copies), 0 if none yet. Stays readable after the
+			 * bot is gone
+			 */
+			inline std::shared_ptr<const std::atomic<std::int64_t>> lastPollTime() const {
+				return lastPoll;
+			}
+
 		protected:
 			explicit Api(const std::string &token);
 
@@ -415,12 +469,123 @@ namespace tgbot {
 
 			int getUpdates(void *c, std::vector<api_types::Update> &updates);
 
+			/*!
+			 * @brief next getUpdates URL (for event loops driving the poll)
+			 */
+			std::string updatesRequest() const;
+
+			/*!
+			 * @brief deadlines of the next getUpdates
+			 */
+			utils::http::Timeouts updatesTimeouts() const;
+
+			/*!
+			 * @brief parse getUpdates response, advancing the offset
+			 * @param body : response body
+			 * @param polledSince : when the request was sent
+			 * @return number of updates appended to updates
+			 */
+			int parseUpdates(const std::string &body,
+			                 std::chrono::steady_clock::time_point polledSince,
+			                 std::vector<api_types::Update> &updates);
+
+			/*!
+			 * @brief like parseUpdates(), leaving kept updates as JSON to be
+			 * deserialized by the caller (who records the parse duration)
+			 */
+			int parseUpdates(const std::string &body,
+			                 std::chrono::steady_clock::time_point polledSince,
+			                 std::vector<Json::Value> &updates);
+
+			/*!
+			 * @brief ask getUpdates for these update types only (all of them
+			 * if empty). No effect if allowed updates were given at
+			 * construction. Not thread safe: call it before polling starts
+			 * @return true if the request changed
+			 */
+			bool restrictUpdates(const std::vector<api_types::UpdateType> &updateTypes);
+
+			/*!
+			 * @brief journal updates parsed from now on, poll after the
+			 * journaled ones
+			 */
+			void attachJournal(std::shared_ptr<utils::UpdateJournal> journal);
+
 			std::string urlWebhook{""};
 
+			/*!
+			 * @brief when the last getUpdates response arrived
+			 */
+			std::chrono::steady_clock::time_point batchReceivedAt;
+
+			/*!
+			 * @brief parse span of the last getUpdates response, empty if not
+			 * tracing
+			 */
+			trace::Context batchTrace;
+
+			/*!
+			 * @brief where received updates are written before dispatch
+			 * (optional)
+			 */
+			std::shared_ptr<utils::UpdateJournal> updateJournal;
+
+			/*!
+			 * @brief updates it rejects are dropped before deserialization
+			 * (optional)
+			 */
+			filters::UpdateFilter updateFilter;
+
+			/*!
+			 * @brief where users and chats of kept updates are recorded
+			 * (optional)
+			 */
+			std::shared_ptr<utils::EntityCache> entityCache;
+
+			/*!
+			 * @brief where getChat, getChatMember, getChatAdministrators,
+			 * getChatMembersCount and getStickerSet responses are reused from
+			 * (optional). Chat and member changes made through this Api drop
+			 * what they make stale
+			 */
+			std::shared_ptr<ChatQueryCache> chatQueries;
+
+			/*!
+			 * @brief update types polled only for chatQueries to observe, no
+			 * callback handles them: dropped once observed
+			 */
+			std::vector<api_types::UpdateType> observedOnly;
+
 		private:
+			/*!
+			 * @brief parse getUpdates response, advancing the offset: kept
+			 * updates are journaled, recorded in entityCache, then given to keep
+			 * @return number of updates kept
+			 */
+			int scanUpdates(const std::string &body,
+			                std::chrono::steady_clock::time_point polledSince,
+			                const std::function<void(Json::Value &)> &keep);
+
+			/*!
+			 * @brief GET url into value, through chatQueries if set
+			 * @param key : cache key of the response
+			 * @param ttl : how long a successful response is reused
+			 */
+			void chatQuery(const std::string &key,
+			               std::chrono::milliseconds ChatQueryCache::Ttls::*ttl,
+			               const std::string &url, Json::Value &value) const;
+
+			bool sendInlineAnswer(const std::string &inlineQueryId,
+			                      const std::string &params) const;
+
 			std::string baseApi{""};
 			std::string updateApiRequest{""};
+			std::string pollApiRequest{""};  // getUpdates, any update type
+			bool fixedAllowedUpdates{false};
+			std::shared_ptr<std::atomic<std::int64_t>> lastPoll{
+					std::make_shared<std::atomic<std::int64_t>>(0)};
 			int currentOffset{0};
+			int pollTimeout{0};
 			tgbot::Logger logger;
 		};
 
@@ -0,0 +1,87 @@
+#ifndef TGBOT_METHODS_CHAT_QUERY_CACHE_H
+#define TGBOT_METHODS_CHAT_QUERY_CACHE_H
+
+#include <chrono>
+#include <string>
+
+#include "../types.h"
+#include "../utils/lru_cache.h"
+
+namespace tgbot {
+	namespace methods {
+
+/*!
+ * @brief Responses of read-only chat queries (getChat, getChatMember,
+ * getChatAdministrators, getChatMembersCount, getStickerSet), see
+ * Bot::cacheChatQueries(). Errors such as "chat not found" are cached too,
+ * for a shorter time. Responses are keyed by chat id as passed to the
+ * method: invalidation from updates only reaches numeric ids, not
+ * "@username" ones. Metrics labeled cache="chat_queries" (see utils::LruCache)
+ */
+		class ChatQueryCache {
+		public:
+			/*!
+			 * @brief how long each kind of response is reused
+			 */
+			struct Ttls {
+				std::chrono::milliseconds chat = std::chrono::minutes(5);
+				std::chrono::milliseconds chatMember = std::chrono::minutes(1);
+				std::chrono::milliseconds chatAdministrators = std::chrono::minutes(5);
+				std::chrono::milliseconds chatMembersCount = std::chrono::minutes(1);
+				std::chrono::milliseconds stickerSet = std::chrono::hours(1);
+
+				/*!
+				 * @brief errors (bad request, forbidden)
+				 */
+				std::chrono::milliseconds negative = std::chrono::seconds(30);
+			};
+
+			/*!
+			 * @param maxBytes : response bytes kept at most
+			 */
+			explicit ChatQueryCache(std::size_t maxBytes = 8 << 20);
+
+			/*!
+			 * @param maxBytes : response bytes kept at most
+			 * @param _ttls : lifetimes
+			 */
+			ChatQueryCache(std::size_t maxBytes, Ttls _ttls);
+
+			/*!
+			 * @brief forget what's known about chat (getChat,
+			 * getChatAdministrators, getChatMembersCount)
+			 */
+			void invalidateChat(const std::string &chatId);
+
+			/*!
+			 * @brief forget getChatMember of user in chat
+			 */
+			void invalidateMember(const std::string &chatId, int userId);
+
+			/*!
+			 * @brief forget what update makes stale: members joining or
+			 * leaving, new title or photo, pinned message, migration
+			 * @param update : raw JSON of an update, of any type
+			 */
+			void observe(const Json::Value &update);
+
+			/*!
+			 * @return key of method's response for chatId (or sticker set name)
+			 */
+			static std::string keyOf(const char *method, const std::string &chatId);
+
+			/*!
+			 * @return key of method's response for user in chatId
+			 */
+			static std::string keyOf(const char *method, const std::string &chatId,
+			                         int userId);
+
+			const Ttls ttls;
+
+			utils::LruCache<std::string> responses;
+		};
+
+	}  // namespace methods
+}  // namespace tgbot
+
+#endif  // TGBOT_METHODS_CHAT_QUERY_CACHE_H
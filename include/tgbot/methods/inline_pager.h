@@ -0,0 +1,50 @@
+#ifndef TGBOT_METHODS_INLINE_PAGER_H
+#define TGBOT_METHODS_INLINE_PAGER_H
+
+#include <chrono>
+#include <memory>
+
+#include "../utils/lru_cache.h"
+#include "types.h"
+
+namespace tgbot {
+	namespace methods {
+
+/*!
+ * @brief Full result lists of inline queries, computed once, answered a page
+ * at a time: next_offset is the index of the next page, and only the page's
+ * results get serialized, so any page costs the same. Lists are held by
+ * query text (per user for personal answers), metrics labeled
+ * cache="inline_pages" (see utils::LruCache)
+ */
+		class InlinePager {
+		public:
+			/*!
+			 * @brief results of a query
+			 */
+			using Results = std::shared_ptr<const types::InlineQueryResultsVector>;
+
+			/*!
+			 * @param _pageSize : results per answer (Telegram takes 50 at most)
+			 * @param maxResults : results kept at most, all lists together. A
+			 * longer list can't be kept: it's computed again for each of its pages
+			 * (counted in tgbot_cache_oversized_total{cache="inline_pages"})
+			 * @param ttl : how long a result list can be paged
+			 */
+			explicit InlinePager(std::size_t _pageSize = 20,
+			                     std::size_t maxResults = 100000,
+			                     std::chrono::milliseconds ttl = std::chrono::minutes(5))
+					: pageSize(_pageSize < 1 ? 1 : _pageSize > 50 ? 50 : _pageSize),
+					  lists("inline_pages", maxResults, ttl, [](const Results &results) {
+						  return results->size();
+					  }) {}
+
+			const std::size_t pageSize;
+
+			utils::LruCache<Results> lists;
+		};
+
+	}  // namespace methods
+}  // namespace tgbot
+
+#endif  // TGBOT_METHODS_INLINE_PAGER_H
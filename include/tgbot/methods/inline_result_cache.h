@@ -0,0 +1,32 @@
+#ifndef TGBOT_METHODS_INLINE_RESULT_CACHE_H
+#define TGBOT_METHODS_INLINE_RESULT_CACHE_H
+
+#include <chrono>
+#include <string>
+
+#include "../utils/lru_cache.h"
+
+namespace tgbot {
+	namespace methods {
+
+/*!
+ * @brief answerInlineQuery payloads, already serialized and URL encoded, by
+ * query text and offset (per user for personal answers). Metrics labeled
+ * cache="inline_results" (see utils::LruCache)
+ */
+		class InlineResultCache : public utils::LruCache<std::string> {
+		public:
+			/*!
+			 * @param maxBytes : payload bytes kept at most
+			 * @param ttl : how long a payload can be reused
+			 */
+			explicit InlineResultCache(std::size_t maxBytes = 16 << 20,
+			                           std::chrono::milliseconds ttl = std::chrono::minutes(5))
+					: LruCache("inline_results", maxBytes, ttl,
+					           [](const std::string &payload) { return payload.size(); }) {}
+		};
+
+	}  // namespace methods
+}  // namespace tgbot
+
+#endif  // TGBOT_METHODS_INLINE_RESULT_CACHE_H
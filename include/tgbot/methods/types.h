@@ -644,6 +644,19 @@ namespace tgbot {
 				int duration;
 			};
 
+/*!
+ * @brief answerInlineQuery parameters, built on cache miss (see
+ * Api::answerInlineQuery(const tgbot::types::InlineQuery &, InlineResultCache &, ...))
+ */
+			struct InlineAnswer {
+				InlineQueryResultsVector results;
+				int cacheTime = 0;
+				bool isPersonal = false;
+				std::string nextOffset;
+				std::string switchPmText;
+				std::string switchPmParameter;
+			};
+
 		}  // namespace types
 
 	}  // namespace methods
@@ -0,0 +1,290 @@
+#ifndef TGBOT_METRICS_H
+#define TGBOT_METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tgbot {
+
+/*!
+ * @brief Lightweight metrics: lock-free counters, gauges and histograms,
+ * kept by a registry which can be read back or exported (Prometheus text format)
+ */
+	namespace metrics {
+
+/*!
+ * @brief Monotonic counter
+ */
+		class Counter {
+		public:
+			inline void increment(std::uint64_t n = 1) noexcept {
+				value.fetch_add(n, std::memory_order_relaxed);
+			}
+
+			inline std::uint64_t get() const noexcept {
+				return value.load(std::memory_order_relaxed);
+			}
+
+		private:
+			std::atomic<std::uint64_t> value{0};
+		};
+
+/*!
+ * @brief Value which can go up and down
+ */
+		class Gauge {
+		public:
+			inline void set(std::int64_t n) noexcept {
+				value.store(n, std::memory_order_relaxed);
+			}
+
+			inline void add(std::int64_t n = 1) noexcept {
+				value.fetch_add(n, std::memory_order_relaxed);
+			}
+
+			inline void sub(std::int64_t n = 1) noexcept {
+				value.fetch_sub(n, std::memory_order_relaxed);
+			}
+
+			inline std::int64_t get() const noexcept {
+				return value.load(std::memory_order_relaxed);
+			}
+
+		private:
+			std::atomic<std::int64_t> value{0};
+		};
+
+/*!
+ * @brief Point in time copy of a Histogram
+ */
+		struct HistogramSnapshot {
+			std::uint64_t count{0};
+			std::uint64_t sum{0};
+			std::uint64_t max{0};
+
+			/*!
+			 * @brief non-empty buckets: (highest value in bucket, count)
+			 */
+			std::vector<std::pair<std::uint64_t, std::uint64_t>> buckets;
+
+			/*!
+			 * @param q : quantile, between 0 and 1
+			 * @return (upper bound of the) value at quantile q
+			 */
+			std::uint64_t percentile(double q) const;
+		};
+
+/*!
+ * @brief HDR-style histogram of non-negative integers: log-linear buckets,
+ * 8 sub-buckets for each power of two (relative error below 12.5%)
+ */
+		class Histogram {
+		public:
+			static constexpr unsigned subBucketBits = 3;
+			static constexpr std::size_t subBuckets = 1u << subBucketBits;
+			static constexpr std::size_t nBuckets =
+					subBuckets + (64 - subBucketBits) * subBuckets;
+
+			Histogram() = default;
+
+			Histogram(const Histogram &) = delete;
+
+			Histogram &operator=(const Histogram &) = delete;
+
+			void record(std::uint64_t value) noexcept;
+
+			HistogramSnapshot snapshot() const;
+
+		private:
+			static std::size_t bucketOf(std::uint64_t value) noexcept;
+
+			static std::uint64_t upperBoundOf(std::size_t bucket) noexcept;
+
+			std::atomic<std::uint64_t> buckets[nBuckets]{};
+			std::atomic<std::uint64_t> sum{0};
+			std::atomic<std::uint64_t> max{0};
+		};
+
+		enum class MetricType {
+			COUNTER, GAUGE, HISTOGRAM
+		};
+
+/*!
+ * @brief Point in time copy of a registered metric
+ */
+		struct MetricSnapshot {
+			std::string name;
+			std::string labels;
+			std::string help;
+			MetricType type;
+
+			/*!
+			 * @brief histograms only: multiply recorded values by this to get
+			 * base units (e.g. 1e-6, microseconds to seconds)
+			 */
+			double unit;
+
+			/*!
+			 * @brief counters and gauges only
+			 */
+			std::int64_t value;
+
+			/*!
+			 * @brief histograms only
+			 */
+			HistogramSnapshot histogram;
+		};
+
+/*!
+ * @brief Holds metrics by name and labels. Returned references stay valid
+ * for the whole registry lifetime: look them up once on hot paths.
+ * Snapshots don't lock the registry: exporting never holds back lookups
+ */
+		class Registry {
+		public:
+			Registry() = default;
+
+			Registry(const Registry &) = delete;
+
+			Registry &operator=(const Registry &) = delete;
+
+			/*!
+			 * @return registry used by the library
+			 */
+			static Registry &global();
+
+			/*!
+			 * @param name : metric name (e.g. tgbot_api_requests_total)
+			 * @param labels : labels (see label()), empty if none
+			 * @param help : description, only used on first registration
+			 */
+			Counter &counter(const std::string &name, const std::string &labels = "",
+			                 const std::string &help = "");
+
+			Gauge &gauge(const std::string &name, const std::string &labels = "",
+			             const std::string &help = "");
+
+			/*!
+			 * @param unit : factor converting recorded values to base units,
+			 * microseconds by default
+			 */
+			Histogram &histogram(const std::string &name,
+			                     const std::string &labels = "",
+			                     const std::string &help = "",
+			                     double unit = 1e-6);
+
+			/*!
+			 * @brief lock-free: reads the metrics registered so far
+			 */
+			std::vector<MetricSnapshot> snapshot() const;
+
+			/*!
+			 * @return metrics in Prometheus text exposition format
+			 * (histograms are exposed as summaries)
+			 */
+			std::string toPrometheus() const;
+
+		private:
+			struct Entry {
+				std::string help;
+				MetricType type;
+				double unit;
+				std::unique_ptr<Counter> counter;
+				std::unique_ptr<Gauge> gauge;
+				std::unique_ptr<Histogram> histogram;
+			};
+
+			Entry &entry(const std::string &name, const std::string &labels,
+			             const std::string &help, MetricType type, double unit);
+
+			using Node = std::pair<const std::pair<std::string, std::string>, Entry>;
+
+			mutable std::mutex mtx;
+			std::map<std::pair<std::string, std::string>, Entry> entries;
+
+			// entries in name order, replaced (under mtx) at each registration:
+			// read by snapshot() without locking
+			std::shared_ptr<const std::vector<const Node *>> published{
+					std::make_shared<const std::vector<const Node *>>()};
+		};
+
+/*!
+ * @brief Keeps the N slowest operations seen so far. Recording is lock-free
+ * unless the operation is slower than the fastest one kept
+ */
+		class SlowLog {
+		public:
+			struct Entry {
+				std::uint64_t micros;
+				std::string what;
+				std::time_t when;
+			};
+
+			explicit SlowLog(std::size_t _capacity = 32) : capacity(_capacity) {}
+
+			SlowLog(const SlowLog &) = delete;
+
+			SlowLog &operator=(const SlowLog &) = delete;
+
+			/*!
+			 * @param micros : how long it took
+			 * @param what : description, built only if kept
+			 */
+			template<typename _Describe>
+			void record(std::uint64_t micros, _Describe &&what) {
+				if (micros > threshold.load(std::memory_order_relaxed))
+					insert(micros, what());
+			}
+
+			/*!
+			 * @return kept entries, slowest first
+			 */
+			std::vector<Entry> entries() const;
+
+			/*!
+			 * @brief forget everything
+			 */
+			void clear();
+
+		private:
+			void insert(std::uint64_t micros, std::string what);
+
+			const std::size_t capacity;
+			std::atomic<std::uint64_t> threshold{0};
+			mutable std::mutex mtx;
+			std::vector<Entry> heap;
+		};
+
+/*!
+ * @return slowest update handlers run in this process
+ */
+		SlowLog &slowHandlers();
+
+/*!
+ * @brief make a label pair, value gets escaped
+ * @return key="value"
+ */
+		std::string label(const std::string &key, const std::string &value);
+
+/*!
+ * @return microseconds elapsed since start
+ */
+		inline std::uint64_t microsSince(std::chrono::steady_clock::time_point start) {
+			return static_cast<std::uint64_t>(
+					std::chrono::duration_cast<std::chrono::microseconds>(
+							std::chrono::steady_clock::now() - start).count());
+		}
+
+	}  // namespace metrics
+
+}  // namespace tgbot
+
+#endif  // TGBOT_METRICS_H
@@ -52,6 +52,34 @@ namespace tgbot {
 		MessageCallback channelPostCallback;
 		std::vector<__Command_Tuple> commandCallback;
 
+		/*!
+		 * @return update types having a callback (commands count as MESSAGE)
+		 */
+		std::vector<types::UpdateType> handledUpdateTypes() const {
+			std::vector<types::UpdateType> handled;
+
+			if (messageCallback || !commandCallback.empty())
+				handled.push_back(types::UpdateType::MESSAGE);
+			if (editedMessageCallback)
+				handled.push_back(types::UpdateType::EDITED_MESSAGE);
+			if (editedChannelPostCallback)
+				handled.push_back(types::UpdateType::EDITED_CHANNEL_POST);
+			if (inlineQueryCallback)
+				handled.push_back(types::UpdateType::INLINE_QUERY);
+			if (chosenInlineResultCallback)
+				handled.push_back(types::UpdateType::CHOSEN_INLINE_RESULT);
+			if (callbackQueryCallback)
+				handled.push_back(types::UpdateType::CALLBACK_QUERY);
+			if (shippingQueryCallback)
+				handled.push_back(types::UpdateType::SHIPPING_QUERY);
+			if (preCheckoutQueryCallback)
+				handled.push_back(types::UpdateType::PRE_CHECKOUT_QUERY);
+			if (channelPostCallback)
+				handled.push_back(types::UpdateType::CHANNEL_POST);
+
+			return handled;
+		}
+
 	public:
 		/*!
 		 * @brief C-style function pointer callback overload, associate with command
@@ -0,0 +1,96 @@
+#ifndef TGBOT_STATUS_SERVER_H
+#define TGBOT_STATUS_SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace tgbot {
+
+	namespace methods {
+		class Api;
+	}  // namespace methods
+
+/*!
+ * @brief Minimal HTTP listener exposing bot status, running on its own
+ * thread. Serves:
+ *  - /metrics : metrics::Registry::global() in Prometheus text format
+ *  - /healthz : age of the last successful getUpdates of each watched bot
+ *    and handlers in flight, 503 if polling of any of them is stale
+ *  - /debug/handlers : slowest and currently running handlers, as JSON
+ */
+	class StatusServer {
+	public:
+		/*!
+		 * @param _port : TCP port to listen on
+		 * @param _address : IPv4 address to bind (loopback by default)
+		 * @param _staleAfter : /healthz fails if no successful poll since then
+		 */
+		explicit StatusServer(unsigned short _port,
+		                      const std::string &_address = "127.0.0.1",
+		                      std::chrono::seconds _staleAfter = std::chrono::seconds(180));
+
+		StatusServer(const StatusServer &) = delete;
+
+		StatusServer &operator=(const StatusServer &) = delete;
+
+		/*!
+		 * @brief stops the listener, if running
+		 */
+		~StatusServer();
+
+		/*!
+		 * @brief bind and start serving, throws std::runtime_error if it can't
+		 * bind
+		 */
+		void start();
+
+		/*!
+		 * @brief stop serving and wait for the listener thread
+		 */
+		void stop();
+
+		/*!
+		 * @brief report bot on /healthz under name (thread safe). Without
+		 * watched bots, /healthz looks at the last poll of any bot of the
+		 * process
+		 */
+		void watch(const methods::Api &bot, const std::string &name);
+
+		/*!
+		 * @return bound port (useful if constructed with port 0)
+		 */
+		inline unsigned short getPort() const { return port; }
+
+	private:
+		void run();
+
+		void serve(int client) const;
+
+		std::string healthz(int &status) const;
+
+		std::string debugHandlers() const;
+
+		unsigned short port;
+		const std::string address;
+		const std::chrono::seconds staleAfter;
+
+		int listener{-1};
+		int wakeUp[2]{-1, -1};
+		std::atomic<bool> running{false};
+		std::thread server;
+
+		mutable std::mutex watchedMtx;
+		std::vector<std::pair<std::string, std::shared_ptr<const std::atomic<std::int64_t>>>>
+				watched;
+	};
+
+}  // namespace tgbot
+
+#endif  // TGBOT_STATUS_SERVER_H
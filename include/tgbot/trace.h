@@ -0,0 +1,127 @@
+#ifndef TGBOT_TRACE_H
+#define TGBOT_TRACE_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace tgbot {
+
+/*!
+ * @brief Per-update tracing: spans from getUpdates response to handler end,
+ * including Bot API calls made by the handler. Disabled by default, costs
+ * one atomic load per span when disabled
+ */
+	namespace trace {
+
+		using Clock = std::chrono::steady_clock;
+
+/*!
+ * @brief Identifies the running span of a trace
+ */
+		struct Context {
+			std::uint64_t traceId{0};
+			std::uint64_t spanId{0};
+
+			inline explicit operator bool() const { return traceId != 0; }
+		};
+
+/*!
+ * @brief Finished span
+ */
+		struct Span {
+			std::string name;
+			std::string detail;
+			std::uint64_t traceId;
+			std::uint64_t spanId;
+			std::uint64_t parentId;
+			Clock::time_point start;
+			Clock::time_point end;
+			Context link;  ///< span of another trace this one follows from, if any
+		};
+
+/*!
+ * @brief start collecting spans
+ * @param capacity : spans kept in memory, oldest ones get overwritten
+ */
+		void enable(std::size_t capacity = 65536);
+
+/*!
+ * @brief stop collecting spans (already collected ones are kept)
+ */
+		void disable();
+
+		bool enabled();
+
+/*!
+ * @return new trace or span id, never 0
+ */
+		std::uint64_t newId();
+
+/*!
+ * @return context of the span running on this thread, empty if none
+ */
+		Context current();
+
+/*!
+ * @brief store a finished span (no-op if disabled)
+ */
+		void record(Span span);
+
+/*!
+ * @return collected spans, oldest first
+ */
+		std::vector<Span> spans();
+
+		void clear();
+
+/*!
+ * @brief write collected spans as Chrome trace-event JSON
+ * (chrome://tracing, Perfetto), one row per trace, links drawn as arrows
+ */
+		void writeChromeTrace(std::ostream &out);
+
+/*!
+ * @brief write collected spans as Chrome trace-event JSON to a file,
+ * throws std::runtime_error if it can't be written
+ */
+		void writeChromeTrace(const std::string &path);
+
+/*!
+ * @brief Span covering the enclosing scope, made current for this thread.
+ * Child of the current span or, if none, root of a new trace
+ */
+		class ScopedSpan {
+		public:
+			explicit ScopedSpan(const char *_name,
+			                    const std::string &_detail = std::string());
+
+			/*!
+			 * @brief child of parent (e.g. a context coming from another thread),
+			 * nothing recorded if parent is empty
+			 */
+			ScopedSpan(const char *_name, const Context &parent,
+			           const std::string &_detail = std::string());
+
+			ScopedSpan(const ScopedSpan &) = delete;
+
+			ScopedSpan &operator=(const ScopedSpan &) = delete;
+
+			~ScopedSpan();
+
+		private:
+			void open(const char *_name, const Context &parent,
+			          const std::string &_detail);
+
+			bool active{false};
+			Context previous;
+			Span span;
+		};
+
+	}  // namespace trace
+
+}  // namespace tgbot
+
+#endif  // TGBOT_TRACE_H
@@ -5,6 +5,8 @@
 #include <string>
 #include <vector>
 
+#include "utils/optional.h"
+
 namespace Json {
 	struct Value;
 }
@@ -21,6 +23,19 @@ namespace tgbot {
 		template<typename _Ty>
 		using Ptr = std::unique_ptr<_Ty>;
 
+/*!
+ * @typedef Optional, an inline optional value alias (used for frequently
+ * present fields, spares a heap allocation each)
+ */
+		template<typename _Ty>
+		using Optional = utils::Optional<_Ty>;
+
+/*!
+ * @typedef SharedString, an immutable string possibly shared with other
+ * parsed objects (used for low cardinality fields, see utils::StringPool)
+ */
+		using SharedString = std::shared_ptr<const std::string>;
+
 		struct Message;  // forward declaration
 
 		enum class UpdateType {
@@ -35,6 +50,11 @@ namespace tgbot {
 			CHANNEL_POST
 		};
 
+/*!
+ * @return update type name, as used by Bot API (e.g. "callback_query")
+ */
+		const char *updateTypeName(UpdateType updateType) noexcept;
+
 		enum class ChatType {
 			PRIVATE, GROUP, SUPERGROUP, CHANNEL
 		};
@@ -68,12 +88,22 @@ namespace tgbot {
 		public:
 			explicit User(const Json::Value &object);
 
+			/*!
+			 * @return username, nullptr if the user has none
+			 */
+			const std::string *username() const noexcept {
+				return __hasUsername ? &__username : nullptr;
+			}
+
 			std::string firstName;
 			Ptr<std::string> lastName;
-			Ptr<std::string> username;
 			Ptr<std::string> languageCode;
 			int id;
 			bool isBot : 1;
+
+		private:
+			bool __hasUsername : 1;  // packed with isBot
+			std::string __username;
 		};
 
 		struct ChatPhoto {
@@ -114,7 +144,7 @@ namespace tgbot {
 			std::string fileId;
 			Ptr<std::string> performer;
 			Ptr<std::string> title;
-			Ptr<std::string> mimeType;
+			SharedString mimeType;
 			Ptr<PhotoSize> thumb;
 			int fileSize;
 			int duration;
@@ -126,7 +156,7 @@ namespace tgbot {
 			std::string fileId;
 			Ptr<PhotoSize> thumb;
 			Ptr<std::string> fileName;
-			Ptr<std::string> mimeType;
+			SharedString mimeType;
 			int fileSize;
 		};
 
@@ -135,7 +165,7 @@ namespace tgbot {
 			explicit Voice(const Json::Value &object);
 
 			std::string fileId;
-			Ptr<std::string> mimeType;
+			SharedString mimeType;
 			int fileSize;
 			int duration;
 		};
@@ -165,7 +195,7 @@ namespace tgbot {
 			std::string fileId;
 			Ptr<PhotoSize> thumb;
 			Ptr<std::string> fileName;
-			Ptr<std::string> mimeType;
+			SharedString mimeType;
 			int fileSize;
 		};
 
@@ -209,7 +239,7 @@ namespace tgbot {
 			Ptr<MaskPosition> maskPosition;
 			Ptr<PhotoSize> thumb;
 			Ptr<std::string> emoji;
-			Ptr<std::string> setName;
+			SharedString setName;
 			int width;
 			int height;
 			int fileSize;
@@ -231,7 +261,7 @@ namespace tgbot {
 
 			std::string fileId;
 			Ptr<PhotoSize> thumb;
-			Ptr<std::string> mimeType;
+			SharedString mimeType;
 			int fileSize;
 			int width;
 			int height;
@@ -309,19 +339,46 @@ namespace tgbot {
 		public:
 			explicit Chat(const Json::Value &object);
 
+			/*!
+			 * @return title (groups, channels), nullptr if none
+			 */
+			const std::string *title() const noexcept {
+				return __hasTitle ? &__title : nullptr;
+			}
+
+			/*!
+			 * @return username, nullptr if none
+			 */
+			const std::string *username() const noexcept {
+				return __hasUsername ? &__username : nullptr;
+			}
+
+			/*!
+			 * @return first name (private chats), nullptr if none
+			 */
+			const std::string *firstName() const noexcept {
+				return __hasFirstName ? &__firstName : nullptr;
+			}
+
 			ChatType type;
 			Ptr<Message> pinnedMessage;
 			Ptr<ChatPhoto> photo;
-			Ptr<std::string> title;
-			Ptr<std::string> username;
-			Ptr<std::string> firstName;
 			Ptr<std::string> lastName;
 			Ptr<std::string> description;
 			Ptr<std::string> inviteLink;
-			Ptr<std::string> stickerSetName;
+			SharedString stickerSetName;
 			std::int64_t id;
 			bool allMembersAreAdministrators : 1;
 			bool canSetStickerSet : 1;
+
+		private:
+			// packed with the flags above
+			bool __hasTitle : 1;
+			bool __hasUsername : 1;
+			bool __hasFirstName : 1;
+			std::string __title;
+			std::string __username;
+			std::string __firstName;
 		};
 
 		struct PollOptions {
@@ -342,28 +399,25 @@ namespace tgbot {
 			bool isClosed : 1;
 		};
 
-		struct Message {
+/*!
+ * @brief members of Message present in few messages (forwards, channel
+ * posts, media other than photos, service messages), allocated together
+ * only when one of them is
+ */
+		struct MessageExtras {
 		public:
-			explicit Message(const Json::Value &object);
-
-			Chat chat;  // guranteed
-			Ptr<User> from;
 			Ptr<User> forwardFrom;
 			Ptr<Chat> forwardFromChat;
 			Ptr<std::string> forwardSignature;
-			Ptr<Message> replyToMessage;
+			Ptr<std::string> forwardSenderName;
 			Ptr<std::string> authorSignature;
-			Ptr<std::string> text;
-			Ptr<std::vector<MessageEntity>> entities;
 			Ptr<Audio> audio;
 			Ptr<Document> document;
 			Ptr<Game> game;
-			Ptr<std::vector<PhotoSize>> photo;
 			Ptr<Sticker> sticker;
 			Ptr<Video> video;
 			Ptr<Voice> voice;
 			Ptr<VideoNote> videoNote;
-			Ptr<std::string> caption;
 			Ptr<Contact> contact;
 			Ptr<Location> location;
 			Ptr<Venue> venue;
@@ -374,15 +428,33 @@ namespace tgbot {
 			Ptr<Message> pinnedMessage;
 			Ptr<Invoice> invoice;
 			Ptr<SuccessfulPayment> successfulPayment;
-			Ptr<std::vector<MessageEntity>> captionEntities;
 			Ptr<std::string> connectedWebsite;
 			Ptr<Animation> animation;
-			Ptr<std::string> forwardSenderName;
 			Ptr<Poll> poll;
-			std::int64_t migrateToChatId;
-			std::int64_t migrateFromChatId;
-			int forwardFromMessageId;
-			int forwardDate;
+			std::int64_t migrateToChatId{0};
+			std::int64_t migrateFromChatId{0};
+			int forwardFromMessageId{0};
+			int forwardDate{0};
+		};
+
+		struct Message {
+		public:
+			explicit Message(const Json::Value &object);
+
+			/*!
+			 * @return rarely present members, all empty if none is
+			 */
+			const MessageExtras &extrasOrEmpty() const noexcept;
+
+			Chat chat;  // guranteed
+			Ptr<User> from;
+			Ptr<Message> replyToMessage;
+			Optional<std::string> text;
+			Ptr<std::vector<MessageEntity>> entities;
+			Ptr<std::vector<PhotoSize>> photo;
+			Optional<std::string> caption;
+			Ptr<std::vector<MessageEntity>> captionEntities;
+			Ptr<MessageExtras> extras;  // nullptr if none is present
 			int editDate;
 			int messageId;  // guranteed
 			int date;       // guranteed
@@ -450,21 +522,67 @@ namespace tgbot {
 			int totalAmount;
 		};
 
+/*!
+ * @brief Update, holds exactly one payload (by value), selected by updateType.
+ * Payload accessors return nullptr when updateType does not match.
+ */
 		struct Update {
 		public:
 			explicit Update(const Json::Value &object);
 
-			Ptr<Message> message;
-			Ptr<Message> editedMessage;
-			Ptr<Message> channelPost;
-			Ptr<Message> editedChannelPost;
-			Ptr<InlineQuery> inlineQuery;
-			Ptr<ChosenInlineResult> chosenInlineResult;
-			Ptr<CallbackQuery> callbackQuery;
-			Ptr<ShippingQuery> shippingQuery;
-			Ptr<PreCheckoutQuery> preCheckoutQuery;
-			UpdateType updateType;
+			Update(Update &&other) noexcept;
+
+			Update &operator=(Update &&other) noexcept;
+
+			Update(const Update &) = delete;
+
+			Update &operator=(const Update &) = delete;
+
+			~Update();
+
+			/*!
+			 * @return false if update kind is unknown to this library
+			 */
+			inline bool hasPayload() const noexcept { return __hasPayload; }
+
+			Message *message() noexcept;
+			Message *editedMessage() noexcept;
+			Message *channelPost() noexcept;
+			Message *editedChannelPost() noexcept;
+			InlineQuery *inlineQuery() noexcept;
+			ChosenInlineResult *chosenInlineResult() noexcept;
+			CallbackQuery *callbackQuery() noexcept;
+			ShippingQuery *shippingQuery() noexcept;
+			PreCheckoutQuery *preCheckoutQuery() noexcept;
+
+			const Message *message() const noexcept;
+			const Message *editedMessage() const noexcept;
+			const Message *channelPost() const noexcept;
+			const Message *editedChannelPost() const noexcept;
+			const InlineQuery *inlineQuery() const noexcept;
+			const ChosenInlineResult *chosenInlineResult() const noexcept;
+			const CallbackQuery *callbackQuery() const noexcept;
+			const ShippingQuery *shippingQuery() const noexcept;
+			const PreCheckoutQuery *preCheckoutQuery() const noexcept;
+
+			UpdateType updateType{UpdateType::MESSAGE};  // meaningful if hasPayload()
 			int updateId;
+
+		private:
+			void destroyPayload() noexcept;
+
+			void movePayload(Update &other) noexcept;
+
+			union {
+				Message __message;
+				InlineQuery __inlineQuery;
+				ChosenInlineResult __chosenInlineResult;
+				CallbackQuery __callbackQuery;
+				ShippingQuery __shippingQuery;
+				PreCheckoutQuery __preCheckoutQuery;
+			};
+
+			bool __hasPayload{false};
 		};
 
 		struct ResponseParameters {
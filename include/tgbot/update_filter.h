@@ -0,0 +1,78 @@
+#ifndef TGBOT_UPDATE_FILTER_H
+#define TGBOT_UPDATE_FILTER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Json {
+	struct Value;
+}
+
+namespace tgbot {
+
+/*!
+ * @brief Filters run on the JSON of each update, before it becomes a
+ * types::Update: dropped updates are never deserialized nor dispatched
+ * (see Bot::preFilter()).
+ *
+ * Message filters look at message, edited_message, channel_post and
+ * edited_channel_post; any other update passes them.
+ */
+	namespace filters {
+
+/*!
+ * @brief returns true to keep update
+ */
+		using UpdateFilter = std::function<bool(const Json::Value &update)>;
+
+/*!
+ * @return message-like object of update, nullptr if it has none
+ */
+		const Json::Value *messageOf(const Json::Value &update);
+
+/*!
+ * @return update type name (e.g. "callback_query"), as in the JSON
+ */
+		std::string updateTypeOf(const Json::Value &update);
+
+/*!
+ * @brief messages whose text starts with '/'
+ */
+		UpdateFilter commands();
+
+/*!
+ * @brief messages from private chats
+ */
+		UpdateFilter privateChats();
+
+/*!
+ * @brief messages from these chats
+ */
+		UpdateFilter chats(std::vector<long long> chatIds);
+
+/*!
+ * @brief messages having an entity of this type (e.g. "bot_command",
+ * "mention"), in text or caption
+ */
+		UpdateFilter withEntity(std::string entityType);
+
+/*!
+ * @brief messages mentioning @username, in any letter case
+ */
+		UpdateFilter mentioning(const std::string &username);
+
+/*!
+ * @brief keep update if at least one filter keeps it
+ */
+		UpdateFilter anyOf(std::vector<UpdateFilter> any);
+
+/*!
+ * @brief keep update if every filter keeps it
+ */
+		UpdateFilter allOf(std::vector<UpdateFilter> all);
+
+	}  // namespace filters
+}  // namespace tgbot
+
+#endif  // TGBOT_UPDATE_FILTER_H
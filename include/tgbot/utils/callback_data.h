@@ -0,0 +1,75 @@
+#ifndef TGBOT_UTILS_CALLBACK_DATA_H
+#define TGBOT_UTILS_CALLBACK_DATA_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+#include "session_store.h"
+
+namespace tgbot {
+	namespace utils {
+
+/*!
+ * @brief Payloads of any size for inline keyboard buttons: the payload is
+ * kept here and the button gets a 12 bytes token as callback_data
+ * (Telegram allows 64 bytes at most). Tokens are 64 random bits from the
+ * system CSPRNG (/dev/urandom, arc4random_buf() on BSDs and macOS). See
+ * Bot::resolveCallbackData() to have handlers see payloads instead of
+ * tokens.
+ *
+ * Payloads expire when unused for the TTL. With a file, they're snapshotted
+ * periodically and reloaded at construction
+ */
+		class CallbackDataStore {
+		public:
+			/*!
+			 * @param ttl : payloads unused for this long expire
+			 * @param file : snapshot file, none if empty
+			 * @param snapshotInterval : how often to write file
+			 */
+			explicit CallbackDataStore(
+					std::chrono::milliseconds ttl = std::chrono::hours(24),
+					const std::string &file = "",
+					std::chrono::milliseconds snapshotInterval = std::chrono::seconds(10));
+
+			CallbackDataStore(const CallbackDataStore &) = delete;
+
+			CallbackDataStore &operator=(const CallbackDataStore &) = delete;
+
+			/*!
+			 * @brief keep payload
+			 * @return token, to be used as callback data
+			 */
+			std::string put(const std::string &payload);
+
+			/*!
+			 * @return true and the payload of token in payload, if known
+			 */
+			bool get(const std::string &token, std::string &payload);
+
+			/*!
+			 * @brief forget token (e.g. once the button is gone)
+			 */
+			void erase(const std::string &token);
+
+			/*!
+			 * @return true if data is a token made by put() (known or not)
+			 */
+			static bool isToken(const std::string &data);
+
+		private:
+			std::int64_t newId();
+
+			SessionStore<std::string> payloads;
+
+			std::mutex randomMtx;
+			std::uint64_t randomIds[32];
+			std::size_t nextRandom{32};
+		};
+
+	}  // namespace utils
+}  // namespace tgbot
+
+#endif  // TGBOT_UTILS_CALLBACK_DATA_H
@@ -0,0 +1,54 @@
+#ifndef TGBOT_UTILS_CANCEL_H
+#define TGBOT_UTILS_CANCEL_H
+
+#include <atomic>
+#include <memory>
+
+namespace tgbot {
+	namespace utils {
+
+/*!
+ * @brief Cooperative cancellation flag, copies share the same flag.
+ * HTTP transfers started on a thread where a token is current get aborted
+ * (utils::http::TransferCancelled) once it gets cancelled
+ */
+		class CancelToken {
+		public:
+			CancelToken() : state(std::make_shared<std::atomic<bool>>(false)) {}
+
+			inline void cancel() const { state->store(true, std::memory_order_relaxed); }
+
+			inline bool cancelled() const {
+				return state->load(std::memory_order_relaxed);
+			}
+
+			/*!
+			 * @return token current on this thread, nullptr if none
+			 */
+			static const CancelToken *current();
+
+			/*!
+			 * @brief makes token current on this thread for the enclosing scope
+			 */
+			class Scope {
+			public:
+				explicit Scope(const CancelToken &token);
+
+				Scope(const Scope &) = delete;
+
+				Scope &operator=(const Scope &) = delete;
+
+				~Scope();
+
+			private:
+				const CancelToken *previous;
+			};
+
+		private:
+			std::shared_ptr<std::atomic<bool>> state;
+		};
+
+	}  // namespace utils
+}  // namespace tgbot
+
+#endif  // TGBOT_UTILS_CANCEL_H
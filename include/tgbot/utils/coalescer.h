@@ -0,0 +1,74 @@
+#ifndef TGBOT_UTILS_COALESCER_H
+#define TGBOT_UTILS_COALESCER_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "cancel.h"
+
+namespace tgbot {
+
+	namespace metrics {
+		class Counter;
+	}  // namespace metrics
+
+	namespace utils {
+
+/*!
+ * @brief Keeps only the newest piece of work per key: work superseded
+ * before starting is skipped, running work gets its CancelToken cancelled.
+ *
+ * Exported as tgbot_coalesced_superseded_total{work} (skipped) and
+ * tgbot_coalesced_cancelled_total{work} (cancelled while running)
+ */
+		class Coalescer {
+		public:
+			/*!
+			 * @param work : metric label of what's coalesced
+			 */
+			explicit Coalescer(const std::string &work);
+
+			Coalescer(const Coalescer &) = delete;
+
+			Coalescer &operator=(const Coalescer &) = delete;
+
+			/*!
+			 * @brief new work for key, supersedes the previous one
+			 * @return generation of the new work, for start() and finish()
+			 */
+			std::uint64_t submit(std::int64_t key);
+
+			/*!
+			 * @brief work about to run
+			 * @param token : cancelled if the work gets superseded while running
+			 * @return false if superseded meanwhile: don't run it
+			 */
+			bool start(std::int64_t key, std::uint64_t generation,
+			           const CancelToken &token);
+
+			/*!
+			 * @brief work done (or skipped)
+			 */
+			void finish(std::int64_t key, std::uint64_t generation);
+
+		private:
+			struct Latest {
+				std::uint64_t generation;
+				std::uint64_t runningGeneration;
+				CancelToken running;
+			};
+
+			std::mutex mtx;
+			std::unordered_map<std::int64_t, Latest> latest;
+			std::uint64_t nextGeneration{0};
+
+			metrics::Counter &superseded;
+			metrics::Counter &cancelled;
+		};
+
+	}  // namespace utils
+}  // namespace tgbot
+
+#endif  // TGBOT_UTILS_COALESCER_H
@@ -20,6 +20,14 @@ namespace tgbot {
  */
 		std::string encode(const std::string &target);
 
+/*!
+ * @brief Write target as a quoted JSON string (control characters become
+ * spaces)
+ * @param stream
+ * @param target
+ */
+		void encodeJson(std::ostream &stream, const std::string &target);
+
 	}  // namespace utils
 
 }  // namespace tgbot
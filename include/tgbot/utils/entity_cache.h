@@ -0,0 +1,117 @@
+#ifndef TGBOT_UTILS_ENTITY_CACHE_H
+#define TGBOT_UTILS_ENTITY_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "../metrics.h"
+#include "../types.h"
+
+namespace tgbot {
+	namespace utils {
+
+/*!
+ * @brief Lookup cache of the users and chats seen in updates, by id: one
+ * immutable shared instance each, rebuilt only when one of its fields
+ * changes, so handlers can keep (or look up) users and chats for the cost
+ * of a reference count. See Bot::trackEntities().
+ *
+ * Parsed updates are left alone: they still carry their own User and Chat
+ * copies, this doesn't reduce per-update memory. Recording fingerprints
+ * each entity of an update and builds the changed ones outside the lock,
+ * which is taken to look them up and to store them.
+ *
+ * Looks at the sender, chat, forwarded-from, joining and leaving members
+ * of messages, and at the sender of queries. Chats are those of updates:
+ * no photo, description or pinned message (getChat has them).
+ *
+ * When over maxEntities, the least recently seen half is dropped.
+ * Exported as tgbot_entities{kind} and tgbot_entities_refreshed_total{kind}
+ */
+		class EntityCache {
+		public:
+			/*!
+			 * @param maxEntities : users (and chats) kept at most
+			 */
+			explicit EntityCache(std::size_t maxEntities = 65536);
+
+			EntityCache(const EntityCache &) = delete;
+
+			EntityCache &operator=(const EntityCache &) = delete;
+
+			~EntityCache();
+
+			/*!
+			 * @return user with id, nullptr if never seen (or dropped)
+			 */
+			std::shared_ptr<const types::User> user(int id) const;
+
+			/*!
+			 * @return chat with id, nullptr if never seen (or dropped)
+			 */
+			std::shared_ptr<const types::Chat> chat(std::int64_t id) const;
+
+			/*!
+			 * @brief record users and chats of update (JSON, as received)
+			 */
+			void observe(const Json::Value &update);
+
+			std::size_t users() const;
+
+			std::size_t chats() const;
+
+			/*!
+			 * @brief user or chat of an update, and its fingerprint
+			 */
+			struct Seen {
+				const Json::Value *object;
+				std::int64_t id;
+				std::uint64_t fingerprint;
+				bool chat;
+			};
+
+		private:
+			template<typename Entity>
+			struct Slot {
+				std::shared_ptr<const Entity> entity;  // nullptr while being built
+				std::uint64_t lastSeen;
+				std::uint64_t fingerprint;  // of the JSON entity was built from
+			};
+
+			template<typename Entity>
+			using Table = std::unordered_map<std::int64_t, Slot<Entity>>;
+
+			/*!
+			 * @return true if seen has to be (re)built
+			 */
+			template<typename Entity>
+			bool touch(Table<Entity> &table, const Seen &seen);
+
+			template<typename Entity>
+			void store(Table<Entity> &table, const Seen &seen,
+			           std::shared_ptr<const Entity> entity, metrics::Gauge &gauge,
+			           metrics::Counter &refreshed);
+
+			template<typename Entity>
+			void evictOldest(Table<Entity> &table, metrics::Gauge &gauge);
+
+			const std::size_t maxEntities;
+
+			mutable std::mutex mtx;
+			Table<types::User> userTable;
+			Table<types::Chat> chatTable;
+			std::uint64_t tick{0};
+
+			metrics::Gauge &userGauge;
+			metrics::Gauge &chatGauge;
+			metrics::Counter &usersRefreshed;
+			metrics::Counter &chatsRefreshed;
+		};
+
+	}  // namespace utils
+}  // namespace tgbot
+
+#endif  // TGBOT_UTILS_ENTITY_CACHE_H
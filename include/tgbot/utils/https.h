@@ -2,8 +2,11 @@
 #define TGBOT_HTTPS_H
 
 #include <curl/curl.h>
+#include <chrono>
 #include <unordered_map>
 #include <map>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include "../methods/types.h"
 
@@ -17,6 +20,146 @@ namespace utils {
  * @brief HTTP utilities, meant for project internal usage
  */
 namespace http {
+	/*!
+	 * @brief Raised when a transfer is aborted through the current
+	 * utils::CancelToken
+	 */
+	class TransferCancelled : public std::runtime_error {
+	public:
+		TransferCancelled() : std::runtime_error("transfer cancelled") {}
+	};
+
+	/*!
+	 * @brief Raised when a transfer exceeds its deadline or stalls below its
+	 * throughput floor (see Timeouts)
+	 */
+	class TransferTimeout : public std::runtime_error {
+	public:
+		explicit TransferTimeout(const std::string &_what)
+				: std::runtime_error(_what) {}
+	};
+
+	/*!
+	 * @brief Kinds of transfer, each one with its own Timeouts
+	 */
+	enum class Operation {
+		POLL,    ///< getUpdates long poll
+		REQUEST, ///< any other API call
+		UPLOAD   ///< multipart uploads
+	};
+
+	/*!
+	 * @brief Transfer deadlines, 0 disables each one
+	 */
+	struct Timeouts {
+		/*!
+		 * @brief connection (DNS, TCP and TLS handshake) deadline, ms
+		 */
+		long connect;
+
+		/*!
+		 * @brief whole transfer deadline, ms. For Operation::POLL this is
+		 * the margin added to the long poll timeout
+		 */
+		long total;
+
+		/*!
+		 * @brief throughput floor, bytes per second...
+		 */
+		long lowSpeedLimit;
+
+		/*!
+		 * @brief ...for this many seconds before the transfer is abandoned
+		 */
+		long lowSpeedTime;
+	};
+
+	/*!
+	 * @brief change deadlines of a kind of transfer (affects every bot).
+	 * Defaults: POLL 10s connect, long poll timeout + 15s; REQUEST 10s connect,
+	 * 30s total; UPLOAD 10s connect, below 1KiB/s for 30s
+	 */
+	void setTimeouts(Operation operation, const Timeouts &timeouts);
+
+	Timeouts getTimeouts(Operation operation);
+
+	/*!
+	 * @brief Lanes of outgoing requests (see setLanes())
+	 */
+	enum class Priority {
+		INTERACTIVE, ///< answers the user is waiting for (answerCallbackQuery...)
+		NORMAL,      ///< any other API call
+		BULK         ///< uploads, media and broadcasts
+	};
+
+	/*!
+	 * @brief Concurrent requests allowed, all bots of the process together.
+	 * A concurrency limit, not a connection pool: each request still goes
+	 * over the curl handle of its caller
+	 */
+	struct Lanes {
+		/*!
+		 * @brief requests in flight at most, 0: no limit, no lanes (default)
+		 */
+		std::size_t maxInFlight;
+
+		/*!
+		 * @brief of maxInFlight, those only Priority::INTERACTIVE may use
+		 */
+		std::size_t reservedInteractive;
+
+		/*!
+		 * @brief Priority::BULK requests in flight at most, 0: no other
+		 * limit than maxInFlight - reservedInteractive
+		 */
+		std::size_t maxBulk;
+	};
+
+	/*!
+	 * @brief make requests queue for their turn, one queue per Priority:
+	 * a request ending lets in the oldest interactive request, else the
+	 * oldest normal one, else the oldest bulk one, so that callback answers
+	 * don't wait behind uploads. getUpdates isn't limited.
+	 *
+	 * Queueing time is exported as tgbot_api_queue_duration_seconds{lane}
+	 * and requests in flight as tgbot_api_in_flight{lane}
+	 */
+	void setLanes(const Lanes &lanes);
+
+	Lanes getLanes();
+
+	/*!
+	 * @brief change the lane of an API method. Defaults: answerCallbackQuery,
+	 * answerInlineQuery, answerPreCheckoutQuery, answerShippingQuery
+	 * INTERACTIVE; multipart uploads and sendPhoto, sendAudio, sendDocument,
+	 * sendSticker, sendVideo, sendVoice, sendVideoNote, sendMediaGroup
+	 * BULK; others NORMAL
+	 */
+	void setPriority(const std::string &method, Priority priority);
+
+	/*!
+	 * @return lane of method, as requested from this thread
+	 */
+	Priority priorityOf(const std::string &method);
+
+	/*!
+	 * @brief requests made by this thread for the enclosing scope go to
+	 * priority, whatever their method (e.g. Broadcast uses BULK)
+	 */
+	class PriorityScope {
+	public:
+		explicit PriorityScope(Priority priority);
+
+		~PriorityScope();
+
+		PriorityScope(const PriorityScope &) = delete;
+
+		PriorityScope &operator=(const PriorityScope &) = delete;
+
+	private:
+		const Priority *previous;
+		const Priority priority;
+	};
 
 	struct value {
 		const char* basicValue;
@@ -28,6 +171,51 @@ namespace http {
 
 	void __internal_Curl_GlobalInit();
 
+	/*!
+	 * @brief Runs transfers on behalf of get() and multiPartUpload(), in
+	 * place of the calling thread (e.g. BotHost event loop)
+	 */
+	class TransferExecutor {
+	public:
+		virtual ~TransferExecutor() = default;
+
+		/*!
+		 * @brief run transfer to completion, blocking the caller
+		 * @param c : curl instance, ready to go
+		 * @return transfer result
+		 */
+		virtual CURLcode perform(CURL *c) = 0;
+	};
+
+	/*!
+	 * @brief route every transfer of this process through executor
+	 * @param executor : nullptr: perform on the calling thread (default)
+	 */
+	void setTransferExecutor(std::shared_ptr<TransferExecutor> executor);
+
+	/*!
+	 * @brief GET request driven by an event loop (internal usage):
+	 * beginGet(), run instance on a curl multi handle, endGet()
+	 */
+	struct PendingGet {
+		std::string url;
+		std::string method;
+		std::string body;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	/*!
+	 * @brief set up c to GET pending.url
+	 */
+	void beginGet(CURL *c, PendingGet &pending, const Timeouts &timeouts);
+
+	/*!
+	 * @brief account finished transfer, throws on failure (see get())
+	 * @param code : transfer result
+	 * @return HTTP response body
+	 */
+	std::string endGet(CURL *c, PendingGet &pending, CURLcode code);
+
 	/*!
  	* @brief Very easy HTTP GET request using curl (see also: curlEasyInit() )
  	* @param c : curl instance
@@ -36,6 +224,15 @@ namespace http {
  	*/
 	std::string get(CURL *c, const std::string &full);
 
+	/*!
+ 	* @brief HTTP GET request with explicit deadlines
+ 	* @param c : curl instance
+ 	* @param full : complete URL
+ 	* @param timeouts : deadlines for this transfer
+ 	* @return HTTP response body
+ 	*/
+	std::string get(CURL *c, const std::string &full, const Timeouts &timeouts);
+
 	/*!
 	 * @brief Multi part upload utils
 	 * @param c : curl instance
@@ -51,6 +248,19 @@ namespace http {
  	*/
 	CURL *curlEasyInit();
 
+	/*!
+	 * @brief Deleter of CurlHandle
+	 */
+	struct CurlCleanup {
+		void operator()(CURL *c) const { curl_easy_cleanup(c); }
+	};
+
+	/*!
+	 * @brief curl instance released when it goes out of scope, also when
+	 * get() or multiPartUpload() throw
+	 */
+	using CurlHandle = std::unique_ptr<CURL, CurlCleanup>;
+
 }  // namespace http
 
 }  // namespace utils
@@ -0,0 +1,117 @@
+#ifndef TGBOT_UTILS_JOURNAL_H
+#define TGBOT_UTILS_JOURNAL_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace tgbot {
+	namespace utils {
+
+/*!
+ * @brief Append-only, memory mapped journal of received updates (raw JSON).
+ * Updates get appended before dispatch and marked completed when their
+ * handler returns; the checkpoint (first update not completed yet) only
+ * moves over a contiguous run of completed updates. After a crash, updates
+ * from the checkpoint on can be replayed: at-least-once processing. Each
+ * record counts its dispatches (see attempt()), so that an update crashing
+ * the process every time can be given up on.
+ *
+ * Writes land in the page cache, so they survive a process crash; ask for
+ * syncEachBatch to survive a power loss too (one msync per batch).
+ * Throws std::runtime_error on I/O errors.
+ */
+		class UpdateJournal {
+		public:
+			/*!
+			 * @param path : journal file, created if missing
+			 * @param syncEachBatch : flush to disk at each commitBatch()
+			 * @param initialSize : initial file size, grows as needed
+			 */
+			explicit UpdateJournal(const std::string &path, bool syncEachBatch = false,
+			                       std::size_t initialSize = 1 << 20);
+
+			UpdateJournal(const UpdateJournal &) = delete;
+
+			UpdateJournal &operator=(const UpdateJournal &) = delete;
+
+			~UpdateJournal();
+
+			/*!
+			 * @brief record a received update
+			 * @param updateId : its update_id, increasing
+			 * @param json : raw JSON of the update
+			 * @param length : length of json
+			 * @return false if updateId is already journaled (e.g. getUpdates
+			 * retried): don't dispatch it again
+			 */
+			bool append(int updateId, const char *json, std::size_t length);
+
+			/*!
+			 * @brief end of a batch of append()s
+			 */
+			void commitBatch();
+
+			/*!
+			 * @brief update handled, may advance the checkpoint
+			 */
+			void completed(int updateId);
+
+			/*!
+			 * @brief count one more dispatch of a pending update, before
+			 * replaying it
+			 * @return dispatches so far, this one included (0: not pending)
+			 */
+			unsigned attempt(int updateId);
+
+			/*!
+			 * @return first update not completed yet
+			 */
+			int checkpoint() const;
+
+			/*!
+			 * @return offset to continue getUpdates from
+			 */
+			int nextOffset() const;
+
+			/*!
+			 * @return updates appended and not completed yet: (update_id, JSON)
+			 */
+			std::vector<std::pair<int, std::string>> pending() const;
+
+		private:
+			struct Header;
+
+			Header *header() const;
+
+			void map(std::size_t size);
+
+			void reserve(std::size_t recordSize);
+
+			/*!
+			 * @brief if syncEachBatch, flush [from, from + length) to disk
+			 */
+			void sync(std::size_t from, std::size_t length);
+
+			void recover();
+
+			const std::string path;
+			const bool syncEachBatch;
+			int fd{-1};
+			char *base{nullptr};
+			std::size_t capacity{0};
+			int lastAppended{-1};
+
+			// in-flight update_id -> record position
+			std::map<int, std::size_t> inFlight;
+
+			mutable std::mutex mtx;
+		};
+
+	}  // namespace utils
+}  // namespace tgbot
+
+#endif  // TGBOT_UTILS_JOURNAL_H
@@ -0,0 +1,204 @@
+#ifndef TGBOT_UTILS_LRU_CACHE_H
+#define TGBOT_UTILS_LRU_CACHE_H
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "../metrics.h"
+
+namespace tgbot {
+	namespace utils {
+
+/*!
+ * @brief Thread safe string-keyed cache, bounded by total cost of its
+ * values (least recently used go first), entries expire after a TTL.
+ *
+ * Exported as tgbot_cache_hits_total{cache}, tgbot_cache_misses_total{cache},
+ * tgbot_cache_evictions_total{cache}, tgbot_cache_oversized_total{cache} and
+ * tgbot_cache_cost{cache}
+ * @tparam _Value : copyable value
+ */
+		template<typename _Value>
+		class LruCache {
+		public:
+			using Clock = std::chrono::steady_clock;
+			using Cost = std::function<std::size_t(const _Value &)>;
+
+			/*!
+			 * @param name : cache label in metrics
+			 * @param maxCost : total cost kept at most
+			 * @param ttl : entries lifetime
+			 * @param cost : cost of a value (1 each if empty)
+			 */
+			LruCache(const std::string &name, std::size_t _maxCost,
+			         std::chrono::milliseconds _ttl, Cost _cost = nullptr)
+					: maxCost(_maxCost), ttl(_ttl), cost(std::move(_cost)),
+					  hits(metrics::Registry::global().counter(
+							  "tgbot_cache_hits_total", metrics::label("cache", name),
+							  "Cache lookups finding a live entry")),
+					  misses(metrics::Registry::global().counter(
+							  "tgbot_cache_misses_total", metrics::label("cache", name),
+							  "Cache lookups finding nothing, or an expired entry")),
+					  evictions(metrics::Registry::global().counter(
+							  "tgbot_cache_evictions_total", metrics::label("cache", name),
+							  "Entries evicted to stay within the cost bound")),
+					  oversized(metrics::Registry::global().counter(
+							  "tgbot_cache_oversized_total", metrics::label("cache", name),
+							  "Values not cached for costing more than the whole cache")),
+					  totalCost(metrics::Registry::global().gauge(
+							  "tgbot_cache_cost", metrics::label("cache", name),
+							  "Total cost of cached entries")) {}
+
+			LruCache(const LruCache &) = delete;
+
+			LruCache &operator=(const LruCache &) = delete;
+
+			~LruCache() { totalCost.sub(static_cast<std::int64_t>(currentCost)); }
+
+			/*!
+			 * @param countMiss : false if a miss leads to another lookup
+			 * @return true and the value in out if key is cached (and fresh)
+			 */
+			bool get(const std::string &key, _Value &out, bool countMiss = true) {
+				std::lock_guard<std::mutex> guard(mtx);
+
+				auto found = index.find(key);
+				if (found == index.end()) {
+					if (countMiss) misses.increment();
+					return false;
+				}
+
+				if (Clock::now() >= found->second->expires) {
+					drop(found->second);
+					if (countMiss) misses.increment();
+					return false;
+				}
+
+				// most recently used first
+				entries.splice(entries.begin(), entries, found->second);
+				out = found->second->value;
+				hits.increment();
+				return true;
+			}
+
+			/*!
+			 * @brief cache value for key (replaces it if cached)
+			 * @return false if value costs more than the whole cache: not cached
+			 */
+			bool put(const std::string &key, _Value value) {
+				return put(key, std::move(value), ttl);
+			}
+
+			/*!
+			 * @brief cache value for key, for entryTtl instead of the cache TTL
+			 * @return false if value costs more than the whole cache: not cached
+			 */
+			bool put(const std::string &key, _Value value,
+			         std::chrono::milliseconds entryTtl) {
+				const std::size_t valueCost = cost ? cost(value) : 1;
+				if (valueCost > maxCost) {
+					oversized.increment();
+					return false;
+				}
+
+				std::lock_guard<std::mutex> guard(mtx);
+
+				auto found = index.find(key);
+				if (found != index.end()) drop(found->second);
+
+				while (currentCost + valueCost > maxCost) {
+					drop(std::prev(entries.end()));
+					evictions.increment();
+				}
+
+				entries.push_front(Entry{key, std::move(value), valueCost,
+				                         Clock::now() + entryTtl});
+				index.emplace(key, entries.begin());
+				addCost(static_cast<std::int64_t>(valueCost));
+				return true;
+			}
+
+			/*!
+			 * @brief forget key
+			 */
+			void erase(const std::string &key) {
+				std::lock_guard<std::mutex> guard(mtx);
+
+				auto found = index.find(key);
+				if (found != index.end()) drop(found->second);
+			}
+
+			/*!
+			 * @brief forget everything
+			 */
+			void clear() {
+				std::lock_guard<std::mutex> guard(mtx);
+
+				addCost(-static_cast<std::int64_t>(currentCost));
+				entries.clear();
+				index.clear();
+			}
+
+			std::size_t size() const {
+				std::lock_guard<std::mutex> guard(mtx);
+				return entries.size();
+			}
+
+			/*!
+			 * @return hits / lookups of every cache with the same name
+			 */
+			double hitRatio() const {
+				const double nHits = static_cast<double>(hits.get());
+				const double lookups = nHits + static_cast<double>(misses.get());
+				return lookups ? nHits / lookups : 0;
+			}
+
+		private:
+			struct Entry {
+				std::string key;
+				_Value value;
+				std::size_t cost;
+				Clock::time_point expires;
+			};
+
+			using Position = typename std::list<Entry>::iterator;
+
+			void drop(Position position) {
+				addCost(-static_cast<std::int64_t>(position->cost));
+				index.erase(position->key);
+				entries.erase(position);
+			}
+
+			void addCost(std::int64_t delta) {
+				currentCost = static_cast<std::size_t>(
+						static_cast<std::int64_t>(currentCost) + delta);
+				totalCost.add(delta);
+			}
+
+			const std::size_t maxCost;
+			const std::chrono::milliseconds ttl;
+			const Cost cost;
+
+			mutable std::mutex mtx;
+			std::list<Entry> entries;
+			std::unordered_map<std::string, Position> index;
+			std::size_t currentCost{0};
+
+			metrics::Counter &hits;
+			metrics::Counter &misses;
+			metrics::Counter &evictions;
+			metrics::Counter &oversized;
+			metrics::Gauge &totalCost;
+		};
+
+	}  // namespace utils
+}  // namespace tgbot
+
+#endif  // TGBOT_UTILS_LRU_CACHE_H
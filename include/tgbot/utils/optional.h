@@ -0,0 +1,153 @@
+#ifndef TGBOT_UTILS_OPTIONAL_H
+#define TGBOT_UTILS_OPTIONAL_H
+
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace tgbot {
+	namespace utils {
+
+/*!
+ * @brief Optional value stored inline (no heap allocation).
+ * Same access interface of tgbot::types::Ptr: test it as a bool,
+ * dereference it with * or ->. Converts from and to std::unique_ptr, so
+ * code written against Ptr fields (reset(new ...), moves) keeps compiling
+ * @tparam _Ty : value type
+ */
+		template<typename _Ty>
+		class Optional {
+		public:
+			Optional() noexcept = default;
+
+			Optional(const Optional &other) {
+				if (other.engaged) emplace(*other);
+			}
+
+			Optional(Optional &&other) noexcept(
+					std::is_nothrow_move_constructible<_Ty>::value) {
+				if (other.engaged) emplace(std::move(*other));
+			}
+
+			Optional &operator=(const Optional &other) {
+				if (this != &other) {
+					if (other.engaged)
+						assign(*other);
+					else
+						reset();
+				}
+				return *this;
+			}
+
+			Optional &operator=(Optional &&other) noexcept(
+					std::is_nothrow_move_assignable<_Ty>::value &&
+					std::is_nothrow_move_constructible<_Ty>::value) {
+				if (other.engaged)
+					assign(std::move(*other));
+				else
+					reset();
+				return *this;
+			}
+
+			/*!
+			 * @brief takes the value owned by ptr, if any
+			 */
+			Optional(std::unique_ptr<_Ty> &&ptr) {
+				if (ptr) emplace(std::move(*ptr));
+				ptr.reset();
+			}
+
+			Optional &operator=(std::unique_ptr<_Ty> &&ptr) {
+				reset(ptr.release());
+				return *this;
+			}
+
+			/*!
+			 * @brief gives the value away to a heap allocated one
+			 */
+			operator std::unique_ptr<_Ty>() && {
+				std::unique_ptr<_Ty> ptr;
+				if (engaged) ptr.reset(new _Ty(std::move(**this)));
+				reset();
+				return ptr;
+			}
+
+			~Optional() { reset(); }
+
+			/*!
+			 * @brief construct value in place, destroying the previous one
+			 * @param args : forwarded to _Ty constructor
+			 * @return reference to the new value
+			 */
+			template<typename... _TyArgs>
+			_Ty &emplace(_TyArgs &&... args) {
+				reset();
+				::new(&storage) _Ty(std::forward<_TyArgs>(args)...);
+				engaged = true;
+				return **this;
+			}
+
+			/*!
+			 * @brief destroy value, if any
+			 */
+			void reset() noexcept {
+				if (engaged) {
+					(**this).~_Ty();
+					engaged = false;
+				}
+			}
+
+			/*!
+			 * @brief take the value of a heap allocated one (as Ptr::reset()),
+			 * destroying the previous one
+			 * @param ptr : deleted here, nullptr empties
+			 */
+			void reset(_Ty *ptr) {
+				std::unique_ptr<_Ty> owned(ptr);
+				if (owned)
+					assign(std::move(*owned));
+				else
+					reset();
+			}
+
+			/*!
+			 * @return pointer to value, nullptr if empty
+			 */
+			inline _Ty *get() noexcept { return engaged ? &**this : nullptr; }
+
+			inline const _Ty *get() const noexcept {
+				return engaged ? &**this : nullptr;
+			}
+
+			inline explicit operator bool() const noexcept { return engaged; }
+
+			inline _Ty &operator*() noexcept {
+				return *reinterpret_cast<_Ty *>(&storage);
+			}
+
+			inline const _Ty &operator*() const noexcept {
+				return *reinterpret_cast<const _Ty *>(&storage);
+			}
+
+			inline _Ty *operator->() noexcept { return &**this; }
+
+			inline const _Ty *operator->() const noexcept { return &**this; }
+
+		private:
+			template<typename _TyValue>
+			void assign(_TyValue &&value) {
+				if (engaged)
+					**this = std::forward<_TyValue>(value);
+				else
+					emplace(std::forward<_TyValue>(value));
+			}
+
+			typename std::aligned_storage<sizeof(_Ty), alignof(_Ty)>::type storage;
+			bool engaged{false};
+		};
+
+	}  // namespace utils
+}  // namespace tgbot
+
+#endif  // TGBOT_UTILS_OPTIONAL_H
@@ -0,0 +1,380 @@
+#ifndef TGBOT_UTILS_SESSION_STORE_H
+#define TGBOT_UTILS_SESSION_STORE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "../metrics.h"
+
+namespace tgbot {
+	namespace utils {
+
+/*!
+ * @brief session as stored in a snapshot
+ */
+		struct SessionRecord {
+			std::int64_t key;
+			std::int64_t expiresAt;  // unix time, milliseconds
+			std::string value;
+		};
+
+/*!
+ * @brief write records to path, atomically (temporary file, then rename)
+ */
+		void __writeSessionSnapshot(const std::string &path,
+		                            const std::vector<SessionRecord> &records);
+
+/*!
+ * @return records in snapshot at path, none if there's no such file
+ */
+		std::vector<SessionRecord> __readSessionSnapshot(const std::string &path);
+
+/*!
+ * @brief How SessionStore<T> snapshots values: bytes as they are for
+ * trivially copyable types, specialize it for others
+ */
+		template<typename T>
+		struct SessionCodec {
+			static_assert(std::is_trivially_copyable<T>::value,
+			              "specialize tgbot::utils::SessionCodec for this type");
+
+			static std::string encode(const T &value) {
+				return std::string(reinterpret_cast<const char *>(&value), sizeof(T));
+			}
+
+			static T decode(const std::string &bytes) {
+				if (bytes.size() != sizeof(T))
+					throw std::runtime_error("session snapshot: value size mismatch");
+
+				T value;
+				std::memcpy(&value, bytes.data(), sizeof(T));
+				return value;
+			}
+		};
+
+		template<>
+		struct SessionCodec<std::string> {
+			static std::string encode(const std::string &value) { return value; }
+
+			static std::string decode(const std::string &bytes) { return bytes; }
+		};
+
+/*!
+ * @brief Per chat (or per user) state, for handlers running on many threads:
+ * sessions are spread over independently locked shards, expire when not
+ * used for a while, and can be snapshotted to a file to survive restarts.
+ *
+ * Exported as tgbot_sessions{store} and tgbot_sessions_expired_total{store}
+ * @tparam T : session type, default constructible
+ * @tparam Codec : snapshot encoding of T (see SessionCodec)
+ */
+		template<typename T, typename Codec = SessionCodec<T>>
+		class SessionStore {
+		public:
+			/*!
+			 * @param name : store label in metrics
+			 * @param _ttl : sessions unused for this long expire
+			 * @param nShards : independently locked parts
+			 */
+			SessionStore(const std::string &name, std::chrono::milliseconds _ttl,
+			             std::size_t nShards = 64)
+					: ttl(_ttl), shards(nShards ? nShards : 1),
+					  sessions(metrics::Registry::global().gauge(
+							  "tgbot_sessions", metrics::label("store", name),
+							  "Sessions held")),
+					  expired(metrics::Registry::global().counter(
+							  "tgbot_sessions_expired_total", metrics::label("store", name),
+							  "Sessions dropped after their TTL")) {}
+
+			SessionStore(const SessionStore &) = delete;
+
+			SessionStore &operator=(const SessionStore &) = delete;
+
+			/*!
+			 * @brief stops periodic snapshots, taking a last one
+			 */
+			~SessionStore() {
+				stopSnapshots();
+				sessions.sub(static_cast<std::int64_t>(size()));
+			}
+
+			/*!
+			 * @brief call f with the session of key (created if missing), while
+			 * holding its shard: keep f short
+			 * @return what f returns
+			 */
+			template<typename F>
+			auto with(std::int64_t key, F &&f) -> decltype(f(std::declval<T &>())) {
+				Shard &shard = shardOf(key);
+				std::lock_guard<std::mutex> guard(shard.mtx);
+
+				auto found = shard.entries.find(key);
+				if (found == shard.entries.end()) {
+					found = shard.entries.emplace(key, Entry()).first;
+					sessions.add();
+				} else if (expiredAt(found->second, Clock::now())) {
+					found->second.value = T();
+					expired.increment();
+				}
+
+				found->second.lastUsed = Clock::now();
+				return f(found->second.value);
+			}
+
+			/*!
+			 * @return true and a copy of the session of key in out, if any
+			 */
+			bool get(std::int64_t key, T &out) {
+				Shard &shard = shardOf(key);
+				std::lock_guard<std::mutex> guard(shard.mtx);
+
+				auto found = shard.entries.find(key);
+				if (found == shard.entries.end()) return false;
+
+				const Clock::time_point now = Clock::now();
+				if (expiredAt(found->second, now)) {
+					shard.entries.erase(found);
+					sessions.sub();
+					expired.increment();
+					return false;
+				}
+
+				found->second.lastUsed = now;
+				out = found->second.value;
+				return true;
+			}
+
+			/*!
+			 * @brief set the session of key
+			 */
+			void put(std::int64_t key, T value) {
+				with(key, [&value](T &session) { session = std::move(value); });
+			}
+
+			/*!
+			 * @brief set the session of key, unless it has one already
+			 * @return true if value was stored
+			 */
+			bool insert(std::int64_t key, T value) {
+				Shard &shard = shardOf(key);
+				std::lock_guard<std::mutex> guard(shard.mtx);
+
+				auto found = shard.entries.find(key);
+				if (found == shard.entries.end()) {
+					found = shard.entries.emplace(key, Entry()).first;
+					sessions.add();
+				} else if (expiredAt(found->second, Clock::now())) {
+					expired.increment();
+				} else {
+					return false;
+				}
+
+				found->second.value = std::move(value);
+				found->second.lastUsed = Clock::now();
+				return true;
+			}
+
+			/*!
+			 * @return true if key had a session
+			 */
+			bool erase(std::int64_t key) {
+				Shard &shard = shardOf(key);
+				std::lock_guard<std::mutex> guard(shard.mtx);
+
+				if (!shard.entries.erase(key)) return false;
+
+				sessions.sub();
+				return true;
+			}
+
+			std::size_t size() const {
+				std::size_t n = 0;
+				for (const Shard &shard : shards) {
+					std::lock_guard<std::mutex> guard(shard.mtx);
+					n += shard.entries.size();
+				}
+
+				return n;
+			}
+
+			/*!
+			 * @brief drop expired sessions (done at each periodic snapshot)
+			 * @return sessions dropped
+			 */
+			std::size_t evictExpired() {
+				const Clock::time_point now = Clock::now();
+				std::size_t dropped = 0;
+
+				for (Shard &shard : shards) {
+					std::lock_guard<std::mutex> guard(shard.mtx);
+
+					for (auto entry = shard.entries.begin(); entry != shard.entries.end();) {
+						if (expiredAt(entry->second, now)) {
+							entry = shard.entries.erase(entry);
+							++dropped;
+						} else
+							++entry;
+					}
+				}
+
+				sessions.sub(static_cast<std::int64_t>(dropped));
+				expired.increment(dropped);
+				return dropped;
+			}
+
+			/*!
+			 * @brief write live sessions to path (one shard locked at a time)
+			 */
+			void snapshot(const std::string &path) const {
+				const Clock::time_point now = Clock::now();
+				const std::int64_t wallNow = unixMillisNow();
+
+				std::vector<SessionRecord> records;
+				for (const Shard &shard : shards) {
+					std::lock_guard<std::mutex> guard(shard.mtx);
+
+					for (const auto &entry : shard.entries) {
+						if (expiredAt(entry.second, now)) continue;
+
+						const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+								entry.second.lastUsed + ttl - now);
+						records.push_back(SessionRecord{entry.first, wallNow + left.count(),
+						                                Codec::encode(entry.second.value)});
+					}
+				}
+
+				__writeSessionSnapshot(path, records);
+			}
+
+			/*!
+			 * @brief load sessions from a snapshot written by snapshot(), those
+			 * still alive. Sessions already held are kept
+			 * @return sessions loaded
+			 */
+			std::size_t restore(const std::string &path) {
+				const Clock::time_point now = Clock::now();
+				const std::int64_t wallNow = unixMillisNow();
+				std::size_t loaded = 0;
+
+				for (const SessionRecord &record : __readSessionSnapshot(path)) {
+					if (record.expiresAt <= wallNow) continue;
+
+					Entry entry;
+					try {
+						entry.value = Codec::decode(record.value);
+					} catch (const std::exception &) {
+						continue;
+					}
+
+					// as if last used so that it expires when it would have
+					entry.lastUsed = now - ttl +
+					                 std::chrono::milliseconds(record.expiresAt - wallNow);
+
+					Shard &shard = shardOf(record.key);
+					std::lock_guard<std::mutex> guard(shard.mtx);
+					if (shard.entries.emplace(record.key, std::move(entry)).second) {
+						sessions.add();
+						++loaded;
+					}
+				}
+
+				return loaded;
+			}
+
+			/*!
+			 * @brief on a background thread, every interval: evict expired
+			 * sessions and snapshot the others to path. A last snapshot is
+			 * taken at destruction
+			 */
+			void snapshotEvery(const std::string &path, std::chrono::milliseconds interval) {
+				stopSnapshots();
+
+				std::lock_guard<std::mutex> guard(snapshotMtx);
+				stopping = false;
+				snapshotter = std::thread([this, path, interval] {
+					std::unique_lock<std::mutex> lock(snapshotMtx);
+
+					for (bool last = false; !last;) {
+						last = snapshotWake.wait_for(lock, interval, [this] { return stopping; });
+
+						lock.unlock();
+						evictExpired();
+						try {
+							snapshot(path);
+						} catch (const std::exception &) {
+							// next round may succeed (e.g. disk full)
+						}
+						lock.lock();
+					}
+				});
+			}
+
+		private:
+			using Clock = std::chrono::steady_clock;
+
+			struct Entry {
+				T value{};
+				Clock::time_point lastUsed;
+			};
+
+			struct Shard {
+				mutable std::mutex mtx;
+				std::unordered_map<std::int64_t, Entry> entries;
+			};
+
+			Shard &shardOf(std::int64_t key) {
+				// chat ids are far from uniform: mix bits before picking a shard
+				std::uint64_t h = static_cast<std::uint64_t>(key);
+				h ^= h >> 33;
+				h *= 0xff51afd7ed558ccdULL;
+				h ^= h >> 33;
+				return shards[h % shards.size()];
+			}
+
+			bool expiredAt(const Entry &entry, Clock::time_point now) const {
+				return now - entry.lastUsed >= ttl;
+			}
+
+			static std::int64_t unixMillisNow() {
+				return std::chrono::duration_cast<std::chrono::milliseconds>(
+						std::chrono::system_clock::now().time_since_epoch()).count();
+			}
+
+			void stopSnapshots() {
+				{
+					std::lock_guard<std::mutex> guard(snapshotMtx);
+					if (!snapshotter.joinable()) return;
+					stopping = true;
+				}
+
+				snapshotWake.notify_all();
+				snapshotter.join();
+			}
+
+			const std::chrono::milliseconds ttl;
+			std::vector<Shard> shards;
+
+			metrics::Gauge &sessions;
+			metrics::Counter &expired;
+
+			std::mutex snapshotMtx;
+			std::condition_variable snapshotWake;
+			bool stopping{false};
+			std::thread snapshotter;
+		};
+
+	}  // namespace utils
+}  // namespace tgbot
+
+#endif  // TGBOT_UTILS_SESSION_STORE_H
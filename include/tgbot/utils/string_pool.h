@@ -0,0 +1,81 @@
+#ifndef TGBOT_UTILS_STRING_POOL_H
+#define TGBOT_UTILS_STRING_POOL_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../metrics.h"
+
+namespace tgbot {
+	namespace utils {
+
+/*!
+ * @brief Interning pool for short strings repeating across updates (MIME
+ * types, sticker set names): equal strings share one immutable instance.
+ *
+ * Disabled (capacity 0) by default: each string is then allocated on its
+ * own. Once capacity strings are pooled, those no longer referenced
+ * outside of the pool are swept; if none is, new strings aren't pooled.
+ *
+ * Exported as tgbot_string_pool_strings and tgbot_string_pool_hits_total
+ */
+		class StringPool {
+		public:
+			/*!
+			 * @return pool used while parsing updates
+			 */
+			static StringPool &global();
+
+			StringPool();
+
+			StringPool(const StringPool &) = delete;
+
+			StringPool &operator=(const StringPool &) = delete;
+
+			~StringPool();
+
+			/*!
+			 * @brief resize the pool, dropping pooled strings
+			 * @param capacity : strings pooled at most, 0 disables pooling
+			 * @param _maxLength : longer strings are never pooled
+			 */
+			void setCapacity(std::size_t capacity, std::size_t _maxLength = 64);
+
+			/*!
+			 * @return string equal to [data, data + size), shared if pooled
+			 */
+			std::shared_ptr<const std::string> intern(const char *data, std::size_t size);
+
+			std::size_t size() const;
+
+		private:
+			struct Slot {
+				std::uint64_t hash;
+				std::shared_ptr<const std::string> string;
+			};
+
+			Slot *find(std::uint64_t hash, const char *data, std::size_t size);
+
+			std::size_t sweep();
+
+			// read by intern() before locking
+			std::atomic<std::size_t> maxStrings{0};
+			std::atomic<std::size_t> maxLength{64};
+
+			mutable std::mutex mtx;
+			std::vector<Slot> slots;  // open addressing, at most half full
+			std::size_t used{0};
+			std::size_t missesBeforeSweep{0};
+
+			metrics::Gauge &strings;
+			metrics::Counter &hits;
+		};
+
+	}  // namespace utils
+}  // namespace tgbot
+
+#endif  // TGBOT_UTILS_STRING_POOL_H
@@ -1,6 +1,7 @@
 #ifndef TGBOT_UTILS_TIME_H
 #define TGBOT_UTILS_TIME_H
 
+#include <ctime>
 #include <string>
 
 namespace tgbot {
@@ -12,6 +13,14 @@ namespace tgbot {
  */
 		std::string get_current_time(const std::string &fmt);
 
+/*!
+ * @brief format a point in time as localtime (thread safe)
+ * @param when: time to format
+ * @param fmt: format string for time
+ * @return "when" with "fmt" formatting
+ */
+		std::string format_time(std::time_t when, const std::string &fmt);
+
 	}  // namespace utils
 }  // namespace tgbot
 
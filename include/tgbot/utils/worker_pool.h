@@ -0,0 +1,109 @@
+#ifndef TGBOT_UTILS_WORKER_POOL_H
+#define TGBOT_UTILS_WORKER_POOL_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tgbot {
+
+	namespace metrics {
+		class Counter;
+
+		class Gauge;
+
+		class Histogram;
+	}  // namespace metrics
+
+	namespace utils {
+
+/*!
+ * @brief Fixed set of threads serving many task queues round-robin, so a
+ * busy queue (e.g. one bot) can't starve the others
+ */
+		class WorkerPool {
+		public:
+			/*!
+			 * @param nThreads : worker threads (at least 1)
+			 */
+			explicit WorkerPool(std::size_t nThreads);
+
+			WorkerPool(const WorkerPool &) = delete;
+
+			WorkerPool &operator=(const WorkerPool &) = delete;
+
+			/*!
+			 * @brief join()
+			 */
+			~WorkerPool();
+
+			/*!
+			 * @brief run what's still queued, then join workers; submit()
+			 * throws afterwards. Fine from a task (e.g. it drops the last Bot
+			 * copy sharing the pool): that worker is detached and stops once
+			 * the queues are empty
+			 */
+			void join();
+
+			/*!
+			 * @brief add a queue. Its depth and wait time are exported as
+			 * tgbot_worker_queue_depth and tgbot_worker_queue_wait_seconds,
+			 * tasks that threw as tgbot_worker_task_errors_total (tasks
+			 * should handle their errors: nothing else reports them)
+			 * @param labels : metric labels identifying the queue (see
+			 * metrics::label())
+			 * @return queue id, for submit()
+			 */
+			std::size_t addQueue(const std::string &labels);
+
+			/*!
+			 * @brief queue task
+			 * @param queue : id returned by addQueue()
+			 * @throw std::logic_error after join()
+			 */
+			void submit(std::size_t queue, std::function<void()> task);
+
+			/*!
+			 * @return tasks waiting on queue
+			 */
+			std::size_t pending(std::size_t queue) const;
+
+		private:
+			struct Task {
+				std::function<void()> run;
+				std::chrono::steady_clock::time_point queued;
+			};
+
+			struct Queue {
+				std::deque<Task> tasks;
+				metrics::Gauge *depth;
+				metrics::Histogram *wait;
+				metrics::Counter *errors;
+			};
+
+			// shared with the workers, so that one may outlive the pool
+			struct State {
+				std::mutex mtx;
+				std::condition_variable ready;
+				std::vector<Queue> queues;
+				std::size_t nextQueue{0};
+				std::size_t nQueued{0};
+				bool stopping{false};
+			};
+
+			static void run(std::shared_ptr<State> state);
+
+			const std::shared_ptr<State> state;
+			std::vector<std::thread> workers;
+		};
+
+	}  // namespace utils
+}  // namespace tgbot
+
+#endif  // TGBOT_UTILS_WORKER_POOL_H
@@ -0,0 +1,104 @@
+#ifndef TGBOT_WATCHDOG_H
+#define TGBOT_WATCHDOG_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "logger.h"
+#include "methods/types.h"
+#include "utils/cancel.h"
+
+namespace tgbot {
+
+/*!
+ * @brief Handler currently running
+ */
+	struct InFlightHandler {
+		int updateId;
+		types::UpdateType updateType;
+		std::chrono::steady_clock::time_point start;
+
+		/*!
+		 * @brief exceeded the watchdog budget
+		 */
+		bool overBudget;
+
+		/*!
+		 * @brief its transfers got cancelled by the watchdog
+		 */
+		bool cancelled;
+	};
+
+/*!
+ * @return handlers running right now, tracked whether a Watchdog runs or not
+ */
+	std::vector<InFlightHandler> inFlightHandlers();
+
+/*!
+ * @brief track handler start (internal usage)
+ * @return id to pass to __handlerFinished()
+ */
+	std::uint64_t __handlerStarted(int updateId, types::UpdateType updateType,
+	                               const utils::CancelToken &cancelToken);
+
+/*!
+ * @brief track handler end (internal usage)
+ */
+	void __handlerFinished(std::uint64_t id);
+
+/*!
+ * @brief Periodically checks running handlers: logs and counts
+ * (tgbot_handlers_over_budget_total) the ones exceeding budget, and
+ * cancels HTTP transfers (tgbot_handlers_cancelled_total) of the ones
+ * exceeding a hard deadline. A cancelled handler gets
+ * utils::http::TransferCancelled from its current and next Api calls.
+ */
+	class Watchdog {
+	public:
+		/*!
+		 * @param _logger : where to report slow handlers
+		 * @param _budget : handlers running longer get reported
+		 * @param _hardDeadline : handlers running longer get their transfers
+		 * cancelled (zero: never)
+		 * @param _checkInterval : how often to check
+		 */
+		Watchdog(const Logger &_logger, std::chrono::milliseconds _budget,
+		         std::chrono::milliseconds _hardDeadline =
+		         std::chrono::milliseconds::zero(),
+		         std::chrono::milliseconds _checkInterval =
+		         std::chrono::milliseconds(1000));
+
+		Watchdog(const Watchdog &) = delete;
+
+		Watchdog &operator=(const Watchdog &) = delete;
+
+		~Watchdog();
+
+		void start();
+
+		void stop();
+
+	private:
+		void run();
+
+		void check();
+
+		const Logger logger;
+		const std::chrono::milliseconds budget;
+		const std::chrono::milliseconds hardDeadline;
+		const std::chrono::milliseconds checkInterval;
+
+		std::atomic<bool> running{false};
+		std::mutex waitMutex;
+		std::condition_variable wakeUp;
+		std::thread checker;
+	};
+
+}  // namespace tgbot
+
+#endif  // TGBOT_WATCHDOG_H
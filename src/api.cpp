@@ -1,8 +1,15 @@
 ﻿#include <json/json.h>
 #include <tgbot/bot.h>
 #include <tgbot/methods/api.h>
+#include <tgbot/metrics.h>
+#include <tgbot/trace.h>
 #include <tgbot/utils/encode.h>
+#include <tgbot/utils/entity_cache.h>
 #include <tgbot/utils/https.h>
+#include <tgbot/utils/journal.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 
 #define unused __attribute__((__unused__))
 #define BOOL_TOSTR(xvalue) ((xvalue) ? "true" : "false")
@@ -11,6 +18,7 @@
 
 using namespace tgbot::methods;
 using namespace tgbot::utils;
+namespace metrics = tgbot::metrics;
 
 template<typename _Ty>
 using Ptr = ::tgbot::types::Ptr<_Ty>;
@@ -213,11 +221,15 @@ tgbot::methods::Api::Api(
 		const std::string &token,
 		const std::vector<api_types::UpdateType> &allowedUpdates,
 		const int &timeout, const int &limit)
-		: baseApi("https://api.telegram.org/bot" + token), currentOffset(0) {
+		: baseApi("https://api.telegram.org/bot" + token), currentOffset(0),
+		  pollTimeout(timeout) {
 	std::stringstream fullApiRequest;
 	fullApiRequest << baseApi << "/getUpdates?limit=" << limit
 	               << "&timeout=" << timeout;
 
+	pollApiRequest = fullApiRequest.str();
+	fixedAllowedUpdates = !allowedUpdates.empty();
+
 	if (!allowedUpdates.empty()) {
 		fullApiRequest << "&allowed_updates=";
 		allowedUpdatesToString(allowedUpdates, fullApiRequest);
@@ -233,11 +245,141 @@ tgbot::methods::Api::Api(
 // getUpdates (internal usage)
 int tgbot::methods::Api::getUpdates(void *c,
                                     std::vector<api_types::Update> &updates) {
-	std::stringstream updatesRequest;
-	updatesRequest << updateApiRequest << "&offset=" << currentOffset;
+	const auto start = std::chrono::steady_clock::now();
+	const std::string &body =
+			utils::http::get(c, updatesRequest(), updatesTimeouts());
+
+	return parseUpdates(body, start, updates);
+}
+
+bool tgbot::methods::Api::restrictUpdates(
+		const std::vector<api_types::UpdateType> &updateTypes) {
+	if (fixedAllowedUpdates || pollApiRequest.empty()) return false;
+
+	std::string request;
+	if (updateTypes.empty()) {
+		if (updateApiRequest == pollApiRequest) return false;
+
+		// Telegram remembers the last allowed_updates: reset it explicitly
+		request = pollApiRequest + "&allowed_updates=[]";
+	} else {
+		std::stringstream fullApiRequest;
+		fullApiRequest << pollApiRequest << "&allowed_updates=";
+		allowedUpdatesToString(updateTypes, fullApiRequest);
+		removeComma(fullApiRequest, request);
+	}
+
+	if (request == updateApiRequest) return false;
+
+	updateApiRequest = std::move(request);
+	return true;
+}
+
+void tgbot::methods::Api::attachJournal(
+		std::shared_ptr<utils::UpdateJournal> journal) {
+	updateJournal = std::move(journal);
+	currentOffset = std::max(currentOffset, updateJournal->nextOffset());
+}
+
+std::string tgbot::methods::Api::updatesRequest() const {
+	std::stringstream request;
+	request << updateApiRequest << "&offset=" << currentOffset;
+
+	return request.str();
+}
+
+tgbot::utils::http::Timeouts tgbot::methods::Api::updatesTimeouts() const {
+	// the server holds the request up to pollTimeout seconds
+	utils::http::Timeouts timeouts =
+			utils::http::getTimeouts(utils::http::Operation::POLL);
+	if (timeouts.total) timeouts.total += 1000L * pollTimeout;
+
+	return timeouts;
+}
+
+static metrics::Histogram &parseDuration() {
+	static metrics::Histogram &histogram = metrics::Registry::global().histogram(
+			"tgbot_updates_parse_duration_seconds", "",
+			"Time spent parsing a getUpdates batch");
+	return histogram;
+}
+
+static metrics::Counter &droppedCounterOf(const Json::Value &update) {
+	static const char help[] = "Updates dropped by the pre-filter, before parsing";
+	static const std::vector<metrics::Counter *> byType = [] {
+		std::vector<metrics::Counter *> counters;
+		for (int i = 0; i <= static_cast<int>(api_types::UpdateType::CHANNEL_POST); ++i)
+			counters.push_back(&metrics::Registry::global().counter(
+					"tgbot_updates_dropped_total",
+					metrics::label("type", api_types::updateTypeName(
+							static_cast<api_types::UpdateType>(i))),
+					help));
+
+		return counters;
+	}();
+
+	for (auto member = update.begin(); member != update.end(); ++member) {
+		const char *end;
+		const char *name = member.memberName(&end);
+		if (!std::strcmp(name, "update_id")) continue;
+
+		for (int i = 0; i < static_cast<int>(byType.size()); ++i)
+			if (!std::strcmp(name, api_types::updateTypeName(
+					static_cast<api_types::UpdateType>(i))))
+				return *byType[static_cast<std::size_t>(i)];
+
+		break;
+	}
+
+	// types this library doesn't model: only polled for if asked explicitly
+	return metrics::Registry::global().counter(
+			"tgbot_updates_dropped_total",
+			metrics::label("type", tgbot::filters::updateTypeOf(update)), help);
+}
+
+int tgbot::methods::Api::parseUpdates(
+		const std::string &body, std::chrono::steady_clock::time_point polledSince,
+		std::vector<api_types::Update> &updates) {
+	const int kept = scanUpdates(body, polledSince, [&updates](Json::Value &update) {
+		updates.emplace_back(update);
+	});
+
+	if (kept) parseDuration().record(metrics::microsSince(batchReceivedAt));
+	return kept;
+}
+
+int tgbot::methods::Api::parseUpdates(
+		const std::string &body, std::chrono::steady_clock::time_point polledSince,
+		std::vector<Json::Value> &updates) {
+	return scanUpdates(body, polledSince, [&updates](Json::Value &update) {
+		updates.push_back(std::move(update));
+	});
+}
+
+int tgbot::methods::Api::scanUpdates(
+		const std::string &body, std::chrono::steady_clock::time_point polledSince,
+		const std::function<void(Json::Value &)> &keep) {
+	static metrics::Histogram &pollDuration = metrics::Registry::global().histogram(
+			"tgbot_updates_poll_duration_seconds", "",
+			"Time spent waiting for getUpdates response");
+	static metrics::Histogram &batchSize = metrics::Registry::global().histogram(
+			"tgbot_updates_batch_size", "", "Updates received per getUpdates", 1);
+	static metrics::Counter &received = metrics::Registry::global().counter(
+			"tgbot_updates_received_total", "", "Updates received");
+	static metrics::Gauge &lastPollGauge = metrics::Registry::global().gauge(
+			"tgbot_updates_last_poll_timestamp_seconds", "",
+			"Unix time of the last successful getUpdates");
+
+	const auto start = batchReceivedAt = std::chrono::steady_clock::now();
+	pollDuration.record(static_cast<std::uint64_t>(
+			std::chrono::duration_cast<std::chrono::microseconds>(
+					start - polledSince).count()));
+
+	trace::ScopedSpan parseSpan("parse");
+	batchTrace = trace::current();
 
 	Json::Value rootUpdate;
-	parseJsonObject(utils::http::get(c, updatesRequest.str()), rootUpdate);
+	parseJsonObject(body, rootUpdate);
 
 	try {
 		if (!rootUpdate.get("ok", "").asBool()) {
@@ -250,17 +392,60 @@ int tgbot::methods::Api::getUpdates(void *c,
 		return 0;
 	}
 
+	const std::int64_t now = static_cast<std::int64_t>(std::time(nullptr));
+	lastPollGauge.set(now);
+	lastPoll->store(now, std::memory_order_relaxed);
+
 	Json::Value valueUpdates = rootUpdate.get("result", "");
 	const int &updatesCount = valueUpdates.size();
 	if (!updatesCount) return 0;
 
-	for (auto const &singleUpdate : valueUpdates)
-		updates.emplace_back(singleUpdate);
+	const int lastUpdateId =
+			valueUpdates[updatesCount - 1].get("update_id", "").asInt();
+
+	int kept = 0;
+	for (auto &singleUpdate : valueUpdates) {
+		// before the pre-filter: a dropped update still makes entries stale
+		if (chatQueries) {
+			chatQueries->observe(singleUpdate);
+
+			if (std::any_of(observedOnly.begin(), observedOnly.end(),
+			                [&singleUpdate](api_types::UpdateType updateType) {
+				                return singleUpdate.isMember(
+						                api_types::updateTypeName(updateType));
+			                }))
+				continue;
+		}
+
+		if (updateFilter && !updateFilter(singleUpdate)) {
+			droppedCounterOf(singleUpdate).increment();
+			continue;
+		}
+
+		// raw JSON of the update, straight from the body; already journaled
+		// ones were dispatched when first received
+		if (updateJournal &&
+		    !updateJournal->append(
+				    singleUpdate.get("update_id", "").asInt(),
+				    body.data() + singleUpdate.getOffsetStart(),
+				    static_cast<std::size_t>(singleUpdate.getOffsetLimit() -
+				                             singleUpdate.getOffsetStart())))
+			continue;
 
-	currentOffset =
-			1 + valueUpdates[updatesCount - 1].get("update_id", "").asInt();
+		if (entityCache) entityCache->observe(singleUpdate);
 
-	return updatesCount;
+		keep(singleUpdate);
+		++kept;
+	}
+
+	if (updateJournal) updateJournal->commitBatch();
+
+	currentOffset = 1 + lastUpdateId;
+
+	batchSize.record(static_cast<std::uint64_t>(updatesCount));
+	received.increment(static_cast<std::uint64_t>(updatesCount));
+
+	return kept;
 }
 
 //
@@ -283,11 +468,10 @@ bool tgbot::methods::Api::setWebhook(
 	} else
 		setWebhookRequest = request.str();
 
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
-	parseJsonObject(http::get(inst, setWebhookRequest), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), setWebhookRequest), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -300,7 +484,7 @@ bool tgbot::methods::Api::setWebhook(
 		const std::string &url, const std::string &certificate,
 		const int &maxConnections,
 		const std::vector<api_types::UpdateType> &allowedUpdates) {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	http::PostForms forms;
@@ -309,7 +493,7 @@ bool tgbot::methods::Api::setWebhook(
 	forms["max_connections"] = http::value{std::to_string(maxConnections).c_str(), nullptr, nullptr};
 
 	if (allowedUpdates.empty()) {
-		parseJsonObject(http::multiPartUpload(inst, baseApi + "/setWebhook", forms), value);
+		parseJsonObject(http::multiPartUpload(inst.get(), baseApi + "/setWebhook", forms), value);
 	} else {
 		std::stringstream request;
 		std::string final;
@@ -320,12 +504,10 @@ bool tgbot::methods::Api::setWebhook(
 		forms["allowed_updates"] = http::value{final.c_str(), nullptr, nullptr};
 
 		parseJsonObject(
-				http::multiPartUpload(inst, baseApi + "/setWebhook", forms),
+				http::multiPartUpload(inst.get(), baseApi + "/setWebhook", forms),
 				value);
 	}
 
-	curl_easy_cleanup(inst);
-
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
@@ -335,11 +517,10 @@ bool tgbot::methods::Api::setWebhook(
 
 // deleteWebhook
 bool tgbot::methods::Api::deleteWebhook() const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	bool isOk =
-			(http::get(inst, baseApi + "/deleteWebhook").find("\"ok\":true") !=
+			(http::get(inst.get(), baseApi + "/deleteWebhook").find("\"ok\":true") !=
 			 std::string::npos);
-	curl_easy_cleanup(inst);
 
 	if (!isOk) throw TelegramException("Cannot delete webhook");
 
@@ -348,11 +529,10 @@ bool tgbot::methods::Api::deleteWebhook() const {
 
 // getWebhookInfo
 api_types::WebhookInfo tgbot::methods::Api::getWebhookInfo() const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
-	parseJsonObject(http::get(inst, baseApi + "/getWebhookInfo"), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), baseApi + "/getWebhookInfo"), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -362,11 +542,10 @@ api_types::WebhookInfo tgbot::methods::Api::getWebhookInfo() const {
 
 // getMe
 api_types::User tgbot::methods::Api::getMe() const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
-	parseJsonObject(http::get(inst, baseApi + "/getMe"), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), baseApi + "/getMe"), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -374,17 +553,40 @@ api_types::User tgbot::methods::Api::getMe() const {
 	return api_types::User(value.get("result", ""));
 }
 
-// getChat
-api_types::Chat tgbot::methods::Api::getChat(const std::string &chatId) const {
-	CURL *inst = http::curlEasyInit();
-	Json::Value value;
+void tgbot::methods::Api::chatQuery(
+		const std::string &key, std::chrono::milliseconds ChatQueryCache::Ttls::*ttl,
+		const std::string &url, Json::Value &value) const {
+	std::string body;
+	if (chatQueries && chatQueries->responses.get(key, body)) {
+		parseJsonObject(body, value);
+	} else {
+		http::CurlHandle inst(http::curlEasyInit());
+		body = http::get(inst.get(), url);
 
-	parseJsonObject(http::get(inst, baseApi + "/getChat?chat_id=" + chatId),
-	                value);
-	curl_easy_cleanup(inst);
+		parseJsonObject(body, value);
+
+		if (chatQueries) {
+			const int errorCode = value.get("error_code", 0).asInt();
+
+			// flood waits and server errors say nothing about the chat
+			if (value.get("ok", "").asBool())
+				chatQueries->responses.put(key, std::move(body), chatQueries->ttls.*ttl);
+			else if (errorCode == 400 || errorCode == 403)
+				chatQueries->responses.put(key, std::move(body),
+				                           chatQueries->ttls.negative);
+		}
+	}
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
+}
+
+// getChat
+api_types::Chat tgbot::methods::Api::getChat(const std::string &chatId) const {
+	Json::Value value;
+
+	chatQuery(ChatQueryCache::keyOf("getChat", chatId), &ChatQueryCache::Ttls::chat,
+	          baseApi + "/getChat?chat_id=" + chatId, value);
 
 	return api_types::Chat(value.get("result", ""));
 }
@@ -392,28 +594,22 @@ api_types::Chat tgbot::methods::Api::getChat(const std::string &chatId) const {
 // getChatMembersCount
 unsigned tgbot::methods::Api::getChatMembersCount(
 		const std::string &chatId) const {
-	CURL *inst = http::curlEasyInit();
 	Json::Value value;
 
-	parseJsonObject(
-			http::get(inst, baseApi + "/getChatMembersCount?chat_id=" + chatId),
-			value);
-	curl_easy_cleanup(inst);
-
-	if (!value.get("ok", "").asBool())
-		throw TelegramException(value.get("description", "").asCString());
+	chatQuery(ChatQueryCache::keyOf("getChatMembersCount", chatId),
+	          &ChatQueryCache::Ttls::chatMembersCount,
+	          baseApi + "/getChatMembersCount?chat_id=" + chatId, value);
 
 	return value.get("result", "").asUInt();
 }
 
 // getFile
 api_types::File tgbot::methods::Api::getFile(const std::string &fileId) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
-	parseJsonObject(http::get(inst, baseApi + "/getFile?file_id=" + fileId),
+	parseJsonObject(http::get(inst.get(), baseApi + "/getFile?file_id=" + fileId),
 	                value);
-	curl_easy_cleanup(inst);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -424,18 +620,14 @@ api_types::File tgbot::methods::Api::getFile(const std::string &fileId) const {
 // getChatMember
 api_types::ChatMember tgbot::methods::Api::getChatMember(
 		const std::string &chatId, const int &userId) const {
-	CURL *inst = http::curlEasyInit();
 	Json::Value value;
 
 	std::stringstream url;
 	url << baseApi << "/getChatMember?chat_id=" << chatId
 	    << "&user_id=" << userId;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
-
-	if (!value.get("ok", "").asBool())
-		throw TelegramException(value.get("description", "").asCString());
+	chatQuery(ChatQueryCache::keyOf("getChatMember", chatId, userId),
+	          &ChatQueryCache::Ttls::chatMember, url.str(), value);
 
 	return api_types::ChatMember(value.get("result", ""));
 }
@@ -443,15 +635,11 @@ api_types::ChatMember tgbot::methods::Api::getChatMember(
 // getStickerSet
 api_types::StickerSet tgbot::methods::Api::getStickerSet(
 		const std::string &name) const {
-	CURL *inst = http::curlEasyInit();
 	Json::Value value;
 
-	parseJsonObject(
-			http::get(inst, baseApi + "/getStickerSet?name=" + encode(name)), value);
-	curl_easy_cleanup(inst);
-
-	if (!value.get("ok", "").asBool())
-		throw TelegramException(value.get("description", "").asCString());
+	chatQuery(ChatQueryCache::keyOf("getStickerSet", name),
+	          &ChatQueryCache::Ttls::stickerSet,
+	          baseApi + "/getStickerSet?name=" + encode(name), value);
 
 	return api_types::StickerSet(value.get("result", ""));
 }
@@ -460,15 +648,14 @@ api_types::StickerSet tgbot::methods::Api::getStickerSet(
 api_types::UserProfilePhotos tgbot::methods::Api::getUserProfilePhotos(
 		const int &userId, const unsigned int &offset,
 		const unsigned int &limit) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
 	url << baseApi << "/getUserProfilePhotos?user_id=" << userId
 	    << "&offset=" << offset << "&limit=" << limit;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -479,16 +666,11 @@ api_types::UserProfilePhotos tgbot::methods::Api::getUserProfilePhotos(
 // getChatAdministrators
 std::vector<api_types::ChatMember> tgbot::methods::Api::getChatAdministrators(
 		const std::string &chatId) const {
-	CURL *inst = http::curlEasyInit();
 	Json::Value value;
 
-	parseJsonObject(
-			http::get(inst, baseApi + "/getChatAdministrators?chat_id=" + chatId),
-			value);
-	curl_easy_cleanup(inst);
-
-	if (!value.get("ok", "").asBool())
-		throw TelegramException(value.get("description", "").asCString());
+	chatQuery(ChatQueryCache::keyOf("getChatAdministrators", chatId),
+	          &ChatQueryCache::Ttls::chatAdministrators,
+	          baseApi + "/getChatAdministrators?chat_id=" + chatId, value);
 
 	std::vector<api_types::ChatMember> members;
 	for (auto const& member : value.get("result", ""))
@@ -500,15 +682,14 @@ std::vector<api_types::ChatMember> tgbot::methods::Api::getChatAdministrators(
 // getGameHighScores
 std::vector<api_types::GameHighScore> tgbot::methods::Api::getGameHighScores(
 		const int &userId, const int &chatId, const int &messageId) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
 	url << baseApi << "/getGameHighScores?user_id=" << userId
 	    << "&chat_id=" << chatId << "&message_id=" << messageId;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -522,15 +703,14 @@ std::vector<api_types::GameHighScore> tgbot::methods::Api::getGameHighScores(
 
 std::vector<api_types::GameHighScore> tgbot::methods::Api::getGameHighScores(
 		const int &userId, const std::string &inlineMessageId) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
 	url << baseApi << "/getGameHighScores?user_id=" << userId
 	    << "&inline_message_id=" << inlineMessageId;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -544,31 +724,31 @@ std::vector<api_types::GameHighScore> tgbot::methods::Api::getGameHighScores(
 
 // deleteChatPhoto
 bool tgbot::methods::Api::deleteChatPhoto(const std::string &chatId) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	parseJsonObject(
-			http::get(inst, baseApi + "/deleteChatPhoto?chat_id=" + chatId), value);
-	curl_easy_cleanup(inst);
+			http::get(inst.get(), baseApi + "/deleteChatPhoto?chat_id=" + chatId), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) chatQueries->invalidateChat(chatId);
+
 	return true;
 }
 
 // deleteMessage
 bool tgbot::methods::Api::deleteMessage(const std::string &chatId,
                                         const std::string &messageId) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
 	url << baseApi << "/deleteMessage?chat_id=" << chatId
 	    << "&message_id=" << messageId;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -579,13 +759,12 @@ bool tgbot::methods::Api::deleteMessage(const std::string &chatId,
 // deleteStickerFromSet
 bool tgbot::methods::Api::deleteStickerFromSet(
 		const std::string &sticker) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	parseJsonObject(
-			http::get(inst, baseApi + "/deleteStickerFromSet?sticker=" + sticker),
+			http::get(inst.get(), baseApi + "/deleteStickerFromSet?sticker=" + sticker),
 			value);
-	curl_easy_cleanup(inst);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -596,17 +775,18 @@ bool tgbot::methods::Api::deleteStickerFromSet(
 // exportChatInviteLink
 std::string tgbot::methods::Api::exportChatInviteLink(
 		const std::string &chatId) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	parseJsonObject(
-			http::get(inst, baseApi + "/exportChatInviteLink?chat_id=" + chatId),
+			http::get(inst.get(), baseApi + "/exportChatInviteLink?chat_id=" + chatId),
 			value);
-	curl_easy_cleanup(inst);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) chatQueries->invalidateChat(chatId);
+
 	return value.get("result", "").asCString();
 }
 
@@ -614,7 +794,7 @@ std::string tgbot::methods::Api::exportChatInviteLink(
 bool tgbot::methods::Api::kickChatMember(const std::string &chatId,
                                          const int &userId,
                                          const int &untilDate) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -623,27 +803,32 @@ bool tgbot::methods::Api::kickChatMember(const std::string &chatId,
 
 	if (untilDate != -1) url << "&until_date=" << untilDate;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) {
+		chatQueries->invalidateChat(chatId);
+		chatQueries->invalidateMember(chatId, userId);
+	}
+
 	return true;
 }
 
 // leaveChat
 bool tgbot::methods::Api::leaveChat(const std::string &chatId) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
-	parseJsonObject(http::get(inst, baseApi + "/leaveChat?chat_id=" + chatId),
+	parseJsonObject(http::get(inst.get(), baseApi + "/leaveChat?chat_id=" + chatId),
 	                value);
-	curl_easy_cleanup(inst);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) chatQueries->invalidateChat(chatId);
+
 	return true;
 }
 
@@ -651,7 +836,7 @@ bool tgbot::methods::Api::leaveChat(const std::string &chatId) const {
 bool tgbot::methods::Api::pinChatMessage(
 		const std::string &chatId, const std::string &messageId,
 		const bool &disableNotification) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -660,12 +845,13 @@ bool tgbot::methods::Api::pinChatMessage(
 
 	if (disableNotification) url << "&disable_notification=true";
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) chatQueries->invalidateChat(chatId);
+
 	return true;
 }
 
@@ -673,7 +859,7 @@ bool tgbot::methods::Api::pinChatMessage(
 bool tgbot::methods::Api::promoteChatMember(
 		const std::string &chatId, const int &userId,
 		const types::ChatMemberPromote &permissions) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -688,12 +874,16 @@ bool tgbot::methods::Api::promoteChatMember(
 	    << "&can_pin_messages=" << BOOL_TOSTR(permissions.canPinMessages)
 	    << "&can_promote_members=" << BOOL_TOSTR(permissions.canPromoteMembers);
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) {
+		chatQueries->invalidateChat(chatId);
+		chatQueries->invalidateMember(chatId, userId);
+	}
+
 	return true;
 }
 
@@ -701,7 +891,7 @@ bool tgbot::methods::Api::promoteChatMember(
 bool tgbot::methods::Api::restrictChatMember(
 		const std::string &chatId, const int &userId,
 		const types::ChatMemberRestrict &permissions, const int &untilDate) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -717,86 +907,91 @@ bool tgbot::methods::Api::restrictChatMember(
 
 	if (untilDate != -1) url << "&until_date=" << untilDate;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) chatQueries->invalidateMember(chatId, userId);
+
 	return true;
 }
 
 // unbanChatMember
 bool tgbot::methods::Api::unbanChatMember(const std::string &chatId,
                                           const int &userId) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
 	url << baseApi << "/unbanChatMember?chat_id=" << chatId
 	    << "&user_id=" << userId;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) chatQueries->invalidateMember(chatId, userId);
+
 	return true;
 }
 
 // unpinChatMessage
 bool tgbot::methods::Api::unpinChatMessage(const std::string &chatId) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
 	url << baseApi << "/unpinChatMessage?chat_id=" << chatId;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) chatQueries->invalidateChat(chatId);
+
 	return true;
 }
 
 // setChatDescription
 bool tgbot::methods::Api::setChatDescription(
 		const std::string &chatId, const std::string &description) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
 	url << baseApi << "/setChatDescription?chat_id=" << chatId << "&description=";
 	encode(url, description);
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) chatQueries->invalidateChat(chatId);
+
 	return true;
 }
 
 // setChatTitle
 bool tgbot::methods::Api::setChatTitle(const std::string &chatId,
                                        const std::string &title) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
 	url << baseApi << "/setChatTitle?chat_id=" << chatId << "&title=";
 	encode(url, title);
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) chatQueries->invalidateChat(chatId);
+
 	return true;
 }
 
@@ -804,20 +999,21 @@ bool tgbot::methods::Api::setChatTitle(const std::string &chatId,
 bool tgbot::methods::Api::setChatPhoto(const std::string &chatId,
                                        const std::string &filename,
                                        const std::string &mimeType) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	http::PostForms forms;
 	forms["chat_id"] = http::value{chatId.c_str(), nullptr, nullptr};
 	forms["photo"] = http::value{nullptr, filename.c_str(), mimeType.c_str()};
 
-	parseJsonObject(http::multiPartUpload(inst, baseApi + "/setChatPhoto", forms),
+	parseJsonObject(http::multiPartUpload(inst.get(), baseApi + "/setChatPhoto", forms),
 	                value);
-	curl_easy_cleanup(inst);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) chatQueries->invalidateChat(chatId);
+
 	return true;
 }
 
@@ -826,7 +1022,7 @@ api_types::Message tgbot::methods::Api::setGameScore(
 		const std::string &userId, const int &score, const int &chatId,
 		const int &messageId, const bool &force,
 		const bool &disableEditMessage) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -837,8 +1033,7 @@ api_types::Message tgbot::methods::Api::setGameScore(
 
 	if (disableEditMessage) url << "&disable_edit_message=true";
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -850,7 +1045,7 @@ api_types::Message tgbot::methods::Api::setGameScore(
 		const std::string &userId, const int &score,
 		const std::string &inlineMessageId, const bool &force,
 		const bool &disableEditMessage) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -861,8 +1056,7 @@ api_types::Message tgbot::methods::Api::setGameScore(
 
 	if (disableEditMessage) url << "&disable_edit_message=true";
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -873,15 +1067,14 @@ api_types::Message tgbot::methods::Api::setGameScore(
 // setStickerPositionInSet
 bool tgbot::methods::Api::setStickerPositionInSet(const std::string &sticker,
                                                   const int &position) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
 	url << baseApi << "/setStickerPositionInSet?sticker=" << sticker
 	    << "&position=" << position;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -893,7 +1086,7 @@ bool tgbot::methods::Api::setStickerPositionInSet(const std::string &sticker,
 api_types::File tgbot::methods::Api::uploadStickerFile(
 		const int &userId, const std::string &pngSticker,
 		const types::FileSource &source) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	if (source == types::FileSource::EXTERNAL) {
@@ -901,15 +1094,14 @@ api_types::File tgbot::methods::Api::uploadStickerFile(
 		url << baseApi << "/uploadStickerFile?user_id=" << userId
 		    << "&png_sticker=" << pngSticker;
 
-		parseJsonObject(http::get(inst, url.str()), value);
+		parseJsonObject(http::get(inst.get(), url.str()), value);
 	} else {
 		http::PostForms forms;
 		forms["user_id"] = http::value{std::to_string(userId).c_str(), nullptr, nullptr};
 		forms["png_sticker"] = http::value{nullptr, pngSticker.c_str(), "image/png"};
-		parseJsonObject(http::multiPartUpload(inst, baseApi + "/uploadStickerFile", forms),
+		parseJsonObject(http::multiPartUpload(inst.get(), baseApi + "/uploadStickerFile", forms),
 		                value);
 	}
-	curl_easy_cleanup(inst);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -921,7 +1113,7 @@ api_types::File tgbot::methods::Api::uploadStickerFile(
 bool tgbot::methods::Api::addStickerToSet(
 		const int &userId, const std::string &name, const std::string &emoji,
 		const std::string &pngSticker, const types::FileSource &source) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	if (source == types::FileSource::EXTERNAL) {
@@ -931,17 +1123,16 @@ bool tgbot::methods::Api::addStickerToSet(
 		encode(url, name);
 		url << "&emoji=" << emoji;
 
-		parseJsonObject(http::get(inst, url.str()), value);
+		parseJsonObject(http::get(inst.get(), url.str()), value);
 	} else {
 		http::PostForms forms;
 		forms["user_id"] = http::value{std::to_string(userId).c_str(), nullptr, nullptr};
 		forms["name"] = http::value{name.c_str(), nullptr, nullptr};
 		forms["emoji"] = http::value{emoji.c_str(), nullptr, nullptr};
 		forms["png_sticker"] = http::value{nullptr, pngSticker.c_str(), "image/png"};
-		parseJsonObject(http::multiPartUpload(inst, baseApi + "/addStickerToSet", forms),
+		parseJsonObject(http::multiPartUpload(inst.get(), baseApi + "/addStickerToSet", forms),
 		                value);
 	}
-	curl_easy_cleanup(inst);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -953,7 +1144,7 @@ bool tgbot::methods::Api::addStickerToSet(
 		const int &userId, const std::string &name, const std::string &emoji,
 		const std::string &pngSticker, const api_types::MaskPosition &maskPosition,
 		const types::FileSource &source) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	const std::string &&serMaskPosition = toString(maskPosition);
@@ -965,7 +1156,7 @@ bool tgbot::methods::Api::addStickerToSet(
 		encode(url, name);
 		url << "&emoji=" << emoji << "&mask_position=" << serMaskPosition;
 
-		parseJsonObject(http::get(inst, url.str()), value);
+		parseJsonObject(http::get(inst.get(), url.str()), value);
 	} else {
 		http::PostForms forms;
 		forms["user_id"] = http::value{std::to_string(userId).c_str(), nullptr, nullptr};
@@ -975,10 +1166,9 @@ bool tgbot::methods::Api::addStickerToSet(
 		forms["mask_position"] = http::value{serMaskPosition.c_str(), nullptr, nullptr};
 
 		parseJsonObject(
-				http::multiPartUpload(inst, baseApi + "/addStickerToSet", forms),
+				http::multiPartUpload(inst.get(), baseApi + "/addStickerToSet", forms),
 				value);
 	}
-	curl_easy_cleanup(inst);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -991,7 +1181,7 @@ bool tgbot::methods::Api::createNewStickerSet(
 		const int &userId, const std::string &name, const std::string &title,
 		const std::string &emoji, const std::string &pngSticker,
 		const types::FileSource &source) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	if (source == types::FileSource::EXTERNAL) {
@@ -1001,7 +1191,7 @@ bool tgbot::methods::Api::createNewStickerSet(
 		encode(url, name);
 		url << "&emoji=" << emoji << "&title=" << title;
 
-		parseJsonObject(http::get(inst, url.str()), value);
+		parseJsonObject(http::get(inst.get(), url.str()), value);
 	} else {
 		http::PostForms forms;
 		forms["user_id"] = http::value{std::to_string(userId).c_str(), nullptr, nullptr};
@@ -1011,10 +1201,9 @@ bool tgbot::methods::Api::createNewStickerSet(
 		forms["title"] = http::value{title.c_str(), nullptr, nullptr};
 
 		parseJsonObject(
-				http::multiPartUpload(inst, baseApi + "/addStickerToSet", forms),
+				http::multiPartUpload(inst.get(), baseApi + "/addStickerToSet", forms),
 				value);
 	}
-	curl_easy_cleanup(inst);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1027,7 +1216,7 @@ bool tgbot::methods::Api::createNewStickerSet(
 		const std::string &emoji, const std::string &pngSticker,
 		const api_types::MaskPosition &maskPosition,
 		const types::FileSource &source) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	const std::string &&serMaskPosition = toString(maskPosition);
@@ -1040,7 +1229,7 @@ bool tgbot::methods::Api::createNewStickerSet(
 		url << "&emoji=" << emoji << "&title=" << title
 		    << "&mask_position=" << serMaskPosition;
 
-		parseJsonObject(http::get(inst, url.str()), value);
+		parseJsonObject(http::get(inst.get(), url.str()), value);
 	} else {
 		http::PostForms forms;
 		forms["user_id"] = http::value{std::to_string(userId).c_str(), nullptr, nullptr};
@@ -1051,12 +1240,10 @@ bool tgbot::methods::Api::createNewStickerSet(
 		forms["mask_position"] = http::value{serMaskPosition.c_str(), nullptr, nullptr};
 
 		parseJsonObject(
-				http::multiPartUpload(inst, baseApi + "/addStickerToSet", forms),
+				http::multiPartUpload(inst.get(), baseApi + "/addStickerToSet", forms),
 				value);
 	}
 
-	curl_easy_cleanup(inst);
-
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
@@ -1066,7 +1253,7 @@ bool tgbot::methods::Api::createNewStickerSet(
 // answerPreCheckoutQuery
 bool tgbot::methods::Api::answerPreCheckoutQuery(
 		const std::string &preCheckoutQueryId) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1074,8 +1261,7 @@ bool tgbot::methods::Api::answerPreCheckoutQuery(
 	    << "/answerPreCheckoutQuery?pre_checkout_query_id=" << preCheckoutQueryId
 	    << "&ok=true";
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1086,7 +1272,7 @@ bool tgbot::methods::Api::answerPreCheckoutQuery(
 bool tgbot::methods::Api::answerPreCheckoutQuery(
 		const std::string &preCheckoutQueryId,
 		const std::string &errorMessage) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1095,8 +1281,7 @@ bool tgbot::methods::Api::answerPreCheckoutQuery(
 	    << "&ok=false"
 	    << "&error_message=" << errorMessage;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1107,7 +1292,7 @@ bool tgbot::methods::Api::answerPreCheckoutQuery(
 // answerShippingQuery
 bool tgbot::methods::Api::answerShippingQuery(
 		const std::string &shippingQueryId, const std::string &errorMessage) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1116,8 +1301,7 @@ bool tgbot::methods::Api::answerShippingQuery(
 	    << "&error_message=";
 	encode(url, errorMessage);
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1128,7 +1312,7 @@ bool tgbot::methods::Api::answerShippingQuery(
 bool tgbot::methods::Api::answerShippingQuery(
 		const std::string &shippingQueryId,
 		const std::vector<types::ShippingOption> &shippingOptions) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1145,8 +1329,7 @@ bool tgbot::methods::Api::answerShippingQuery(
 	encode(url, optionsStream.str());
 	url << "%5D";
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1158,7 +1341,7 @@ bool tgbot::methods::Api::answerShippingQuery(
 bool tgbot::methods::Api::answerCallbackQuery(
 		const std::string &callbackQueryId, const std::string &text,
 		const bool &showAlert, const std::string &url, const int &cacheTime) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream surl;
@@ -1176,8 +1359,7 @@ bool tgbot::methods::Api::answerCallbackQuery(
 
 	if (cacheTime) surl << "&cache_time=" << cacheTime;
 
-	parseJsonObject(http::get(inst, surl.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), surl.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1186,19 +1368,8 @@ bool tgbot::methods::Api::answerCallbackQuery(
 }
 
 // answerInlineQuery
-bool tgbot::methods::Api::answerInlineQuery(
-		const std::string &inlineQueryId,
-		const std::vector<Ptr<types::InlineQueryResult>> &results,
-		const int &cacheTime, const bool &isPersonal, const std::string &nextOffset,
-		const std::string &switchPmText,
-		const std::string &switchPmParameter) const {
-	CURL *inst = http::curlEasyInit();
-	Json::Value value;
-
-	std::stringstream url;
-	url << baseApi << "/answerInlineQuery?inline_query_id=" << inlineQueryId
-	    << "&results=%5B";
-
+static std::string resultsToString(
+		const std::vector<Ptr<types::InlineQueryResult>> &results) {
 	std::stringstream resultsStream;
 	const size_t &nResults = results.size();
 	for (size_t i = 0; i < nResults; i++) {
@@ -1206,27 +1377,47 @@ bool tgbot::methods::Api::answerInlineQuery(
 		resultsStream << results.at(i)->toString();
 	}
 
-	encode(url, resultsStream.str());
-	url << "%5D";
+	return resultsStream.str();
+}
+
+// results: serialized results, comma separated
+static std::string inlineAnswerParams(
+		const std::string &results,
+		const int &cacheTime, const bool &isPersonal, const std::string &nextOffset,
+		const std::string &switchPmText, const std::string &switchPmParameter) {
+	std::stringstream params;
+	params << "&results=%5B";
+
+	encode(params, results);
+	params << "%5D";
 
-	if (cacheTime) url << "&cache_time=" << cacheTime;
+	if (cacheTime) params << "&cache_time=" << cacheTime;
 
-	if (isPersonal) url << "&is_personal=true";
+	if (isPersonal) params << "&is_personal=true";
 
-	if (!nextOffset.empty()) url << "&next_offset=" << nextOffset;
+	if (!nextOffset.empty()) params << "&next_offset=" << nextOffset;
 
 	if (!switchPmText.empty()) {
-		url << "&switch_pm_text=";
-		encode(url, switchPmText);
+		params << "&switch_pm_text=";
+		encode(params, switchPmText);
 	}
 
 	if (!switchPmParameter.empty()) {
-		url << "&switch_pm_parameter=";
-		encode(url, switchPmParameter);
+		params << "&switch_pm_parameter=";
+		encode(params, switchPmParameter);
 	}
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	return params.str();
+}
+
+bool tgbot::methods::Api::sendInlineAnswer(const std::string &inlineQueryId,
+                                           const std::string &params) const {
+	http::CurlHandle inst(http::curlEasyInit());
+	Json::Value value;
+
+	parseJsonObject(http::get(inst.get(), baseApi + "/answerInlineQuery?inline_query_id=" +
+	                                inlineQueryId + params),
+	                value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1234,13 +1425,80 @@ bool tgbot::methods::Api::answerInlineQuery(
 	return true;
 }
 
+bool tgbot::methods::Api::answerInlineQuery(
+		const std::string &inlineQueryId,
+		const std::vector<Ptr<types::InlineQueryResult>> &results,
+		const int &cacheTime, const bool &isPersonal, const std::string &nextOffset,
+		const std::string &switchPmText,
+		const std::string &switchPmParameter) const {
+	return sendInlineAnswer(
+			inlineQueryId,
+			inlineAnswerParams(resultsToString(results), cacheTime, isPersonal,
+			                   nextOffset, switchPmText, switchPmParameter));
+}
+
+bool tgbot::methods::Api::answerInlineQuery(
+		const api_types::InlineQuery &query, InlineResultCache &cache,
+		const std::function<types::InlineAnswer()> &build) const {
+	const std::string &sharedKey = query.query + '\0' + query.offset;
+	const std::string &personalKey = sharedKey + '\0' + std::to_string(query.from.id);
+
+	std::string params;
+	if (cache.get(sharedKey, params, false) || cache.get(personalKey, params))
+		return sendInlineAnswer(query.id, params);
+
+	const types::InlineAnswer &answer = build();
+	params = inlineAnswerParams(resultsToString(answer.results), answer.cacheTime,
+	                            answer.isPersonal, answer.nextOffset,
+	                            answer.switchPmText, answer.switchPmParameter);
+
+	cache.put(answer.isPersonal ? personalKey : sharedKey, params);
+	return sendInlineAnswer(query.id, params);
+}
+
+bool tgbot::methods::Api::answerInlineQuery(
+		const api_types::InlineQuery &query, InlinePager &pager,
+		const std::function<types::InlineQueryResultsVector()> &compute,
+		const int &cacheTime, const bool &isPersonal) const {
+	const std::string &key = isPersonal ? query.query + '\0' + std::to_string(query.from.id)
+	                                    : query.query;
+
+	InlinePager::Results results;
+	if (!pager.lists.get(key, results)) {
+		results = std::make_shared<const types::InlineQueryResultsVector>(compute());
+		pager.lists.put(key, results);
+	}
+
+	// offset: index of the first result of the page
+	std::size_t first = 0;
+	if (!query.offset.empty()) {
+		char *end;
+		const unsigned long parsed = std::strtoul(query.offset.c_str(), &end, 10);
+		if (!*end) first = std::min<std::size_t>(parsed, results->size());
+	}
+
+	const std::size_t last = std::min(first + pager.pageSize, results->size());
+
+	// just this page gets serialized
+	std::string page;
+	for (std::size_t i = first; i < last; ++i) {
+		if (i != first) page += ',';
+		page += (*results)[i]->toString();
+	}
+
+	return sendInlineAnswer(
+			query.id, inlineAnswerParams(page, cacheTime, isPersonal,
+			                             last < results->size() ? std::to_string(last) : "",
+			                             "", ""));
+}
+
 // sendMessage
 api_types::Message tgbot::methods::Api::sendMessage(
 		const std::string &chatId, const std::string &text,
 		const types::ParseMode &parseMode, const bool &disableWebPagePreview,
 		const bool &disableNotification,
 		const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1262,8 +1520,7 @@ api_types::Message tgbot::methods::Api::sendMessage(
 		encode(url, markup);
 	}
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1276,7 +1533,7 @@ api_types::Message tgbot::methods::Api::sendMessage(
 		const int &replyToMessageId, const types::ParseMode &parseMode,
 		const bool &disableWebPagePreview, const bool &disableNotification,
 		const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1299,8 +1556,7 @@ api_types::Message tgbot::methods::Api::sendMessage(
 		encode(url, markup);
 	}
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1312,7 +1568,7 @@ api_types::Message tgbot::methods::Api::sendMessage(
 api_types::Message tgbot::methods::Api::forwardMessage(
 		const std::string &chatId, const std::string &fromChatId,
 		const int &messageId, const bool &disableNotification) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1321,8 +1577,7 @@ api_types::Message tgbot::methods::Api::forwardMessage(
 
 	if (disableNotification) url << "&disable_notification=true";
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1335,7 +1590,7 @@ api_types::Message tgbot::methods::Api::editMessageText(
 		const std::string &chatId, const std::string &messageId,
 		const std::string &text, const types::ParseMode &parseMode,
 		const bool &disableWebPagePreview) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1350,8 +1605,7 @@ api_types::Message tgbot::methods::Api::editMessageText(
 
 	if (disableWebPagePreview) url << "&disable_web_page_preview=true";
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1364,7 +1618,7 @@ api_types::Message tgbot::methods::Api::editMessageText(
 		const types::InlineKeyboardMarkup &replyMarkup, const std::string &text,
 		const types::ParseMode &parseMode,
 		const bool &disableWebPagePreview) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1382,8 +1636,7 @@ api_types::Message tgbot::methods::Api::editMessageText(
 
 	if (disableWebPagePreview) url << "&disable_web_page_preview=true";
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1395,7 +1648,7 @@ api_types::Message tgbot::methods::Api::editMessageText(
 		const std::string &inlineMessageId, const std::string &text,
 		const types::ParseMode &parseMode,
 		const bool &disableWebPagePreview) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1410,8 +1663,7 @@ api_types::Message tgbot::methods::Api::editMessageText(
 
 	if (disableWebPagePreview) url << "&disable_web_page_preview=true";
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1424,7 +1676,7 @@ api_types::Message tgbot::methods::Api::editMessageText(
 		const types::InlineKeyboardMarkup &replyMarkup, const std::string &text,
 		const types::ParseMode &parseMode,
 		const bool &disableWebPagePreview) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1441,8 +1693,7 @@ api_types::Message tgbot::methods::Api::editMessageText(
 
 	if (disableWebPagePreview) url << "&disable_web_page_preview=true";
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1454,7 +1705,7 @@ api_types::Message tgbot::methods::Api::editMessageText(
 api_types::Message tgbot::methods::Api::editMessageCaption(
 		const std::string &chatId, const std::string &messageId,
 		const std::string &caption) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1462,8 +1713,7 @@ api_types::Message tgbot::methods::Api::editMessageCaption(
 	    << "&message_id=" << messageId << "&caption=";
 	encode(url, caption);
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1475,7 +1725,7 @@ api_types::Message tgbot::methods::Api::editMessageCaption(
 		const std::string &chatId, const std::string &messageId,
 		const types::InlineKeyboardMarkup &replyMarkup,
 		const std::string &caption) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1485,8 +1735,7 @@ api_types::Message tgbot::methods::Api::editMessageCaption(
 	url << "&reply_markup=";
 	encode(url, replyMarkup.toString());
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1496,7 +1745,7 @@ api_types::Message tgbot::methods::Api::editMessageCaption(
 
 api_types::Message tgbot::methods::Api::editMessageCaption(
 		const std::string &inlineMessageId, const std::string &caption) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1504,8 +1753,7 @@ api_types::Message tgbot::methods::Api::editMessageCaption(
 	    << "&caption=";
 	encode(url, caption);
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1517,7 +1765,7 @@ api_types::Message tgbot::methods::Api::editMessageCaption(
 		const std::string &inlineMessageId,
 		const types::InlineKeyboardMarkup &replyMarkup,
 		const std::string &caption) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1527,8 +1775,7 @@ api_types::Message tgbot::methods::Api::editMessageCaption(
 	url << "&reply_markup=";
 	encode(url, replyMarkup.toString());
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1540,7 +1787,7 @@ api_types::Message tgbot::methods::Api::editMessageCaption(
 api_types::Message tgbot::methods::Api::editMessageReplyMarkup(
 		const std::string &chatId, const std::string &messageId,
 		const types::InlineKeyboardMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1548,8 +1795,7 @@ api_types::Message tgbot::methods::Api::editMessageReplyMarkup(
 	    << "&message_id=" << messageId << "&reply_markup=";
 	encode(url, replyMarkup.toString());
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1560,7 +1806,7 @@ api_types::Message tgbot::methods::Api::editMessageReplyMarkup(
 api_types::Message tgbot::methods::Api::editMessageReplyMarkup(
 		const std::string &inlineMessageId,
 		const types::InlineKeyboardMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1569,8 +1815,7 @@ api_types::Message tgbot::methods::Api::editMessageReplyMarkup(
 	    << "&reply_markup=";
 	encode(url, replyMarkup.toString());
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1581,7 +1826,7 @@ api_types::Message tgbot::methods::Api::editMessageReplyMarkup(
 // sendChatAction
 bool tgbot::methods::Api::sendChatAction(
 		const std::string &chatId, const types::ChatAction &action) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1608,8 +1853,7 @@ bool tgbot::methods::Api::sendChatAction(
 	else if (action == types::ChatAction::UPLOAD_VIDEO_NOTE)
 		url << "upload_video_note";
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1624,7 +1868,7 @@ api_types::Message tgbot::methods::Api::sendContact(
 		const std::string &lastName,
 		const bool &disableNotification, const int &replyToMessageId,
 		const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1654,8 +1898,7 @@ api_types::Message tgbot::methods::Api::sendContact(
 		encode(url, markup);
 	}
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1668,7 +1911,7 @@ api_types::Message tgbot::methods::Api::sendGame(
 		const int &chatId, const std::string &gameShortName,
 		const bool &disableNotification, const int &replyToMessageId,
 		const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1685,8 +1928,7 @@ api_types::Message tgbot::methods::Api::sendGame(
 		encode(url, markup);
 	}
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1699,7 +1941,7 @@ api_types::Message tgbot::methods::Api::sendLocation(
 		const std::string &chatId, const double &latitude, const double &longitude,
 		const int &liveLocation, const bool &disableNotification,
 		const int &replyToMessageId, const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1718,8 +1960,7 @@ api_types::Message tgbot::methods::Api::sendLocation(
 		encode(url, markup);
 	}
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1733,7 +1974,7 @@ api_types::Message tgbot::methods::Api::sendVenue(
 		const std::string &title, const std::string &address, const std::string &foursquareType,
 		const std::string &foursquareId, const bool &disableNotification,
 		const int &replyToMessageId, const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1757,8 +1998,7 @@ api_types::Message tgbot::methods::Api::sendVenue(
 		encode(url, markup);
 	}
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1770,7 +2010,7 @@ api_types::Message tgbot::methods::Api::sendVenue(
 api_types::Message tgbot::methods::Api::sendInvoice(
 		const int &chatId, const types::Invoice &invoice,
 		const bool &disableNotification, const int &replyToMessageId) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1781,8 +2021,7 @@ api_types::Message tgbot::methods::Api::sendInvoice(
 
 	if (replyToMessageId != -1) url << "&replyToMessageId=" << replyToMessageId;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1794,7 +2033,7 @@ api_types::Message tgbot::methods::Api::sendInvoice(
 		const int &chatId, const types::Invoice &invoice,
 		const types::InlineKeyboardMarkup &replyMarkup,
 		const bool &disableNotification, const int &replyToMessageId) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -1806,8 +2045,7 @@ api_types::Message tgbot::methods::Api::sendInvoice(
 
 	if (replyToMessageId != -1) url << "&replyToMessageId=" << replyToMessageId;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1823,7 +2061,7 @@ api_types::Message tgbot::methods::Api::sendVideo(
 		const std::string &caption, const bool &supportsStreaming,
 		const bool &disableNotification, const int &replyToMessageId,
 		const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 	const std::string &&markup = replyMarkup.toString();
 
@@ -1857,7 +2095,7 @@ api_types::Message tgbot::methods::Api::sendVideo(
 			encode(url, markup);
 		}
 
-		parseJsonObject(http::get(inst, url.str()), value);
+		parseJsonObject(http::get(inst.get(), url.str()), value);
 	} else {
 		http::PostForms forms;
 		forms["chat_id"] = http::value{chatId.c_str(), nullptr, nullptr};
@@ -1888,10 +2126,9 @@ api_types::Message tgbot::methods::Api::sendVideo(
 			forms["supports_streaming"] = http::value{"true", nullptr, nullptr};
 
 		parseJsonObject(
-				http::multiPartUpload(inst, baseApi + "/sendVideo", forms),
+				http::multiPartUpload(inst.get(), baseApi + "/sendVideo", forms),
 				value);
 	}
-	curl_easy_cleanup(inst);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -1905,7 +2142,7 @@ api_types::Message tgbot::methods::Api::sendDocument(
 		const types::FileSource &source, const std::string &mimeType,
 		const std::string &caption, const bool &disableNotification,
 		const int &replyToMessageId, const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 	const std::string &&markup = replyMarkup.toString();
 
@@ -1930,7 +2167,7 @@ api_types::Message tgbot::methods::Api::sendDocument(
 			encode(url, markup);
 		}
 
-		parseJsonObject(http::get(inst, url.str()), value);
+		parseJsonObject(http::get(inst.get(), url.str()), value);
 	} else {
 		http::PostForms forms;
 		forms["chat_id"] = http::value{chatId.c_str(), nullptr, nullptr};
@@ -1949,12 +2186,10 @@ api_types::Message tgbot::methods::Api::sendDocument(
 			forms["reply_markup"] = http::value{replyMarkup.toString().c_str(), nullptr, nullptr};
 
 		parseJsonObject(http::multiPartUpload(
-				inst, baseApi + "/sendDocument", forms),
+				inst.get(), baseApi + "/sendDocument", forms),
 		                value);
 	}
 
-	curl_easy_cleanup(inst);
-
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
@@ -1967,7 +2202,7 @@ api_types::Message tgbot::methods::Api::sendPhoto(
 		const types::FileSource &source, const std::string &mimeType,
 		const std::string &caption, const bool &disableNotification,
 		const int &replyToMessageId, const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 	const std::string &&markup = replyMarkup.toString();
 
@@ -1992,7 +2227,7 @@ api_types::Message tgbot::methods::Api::sendPhoto(
 			encode(url, markup);
 		}
 
-		parseJsonObject(http::get(inst, url.str()), value);
+		parseJsonObject(http::get(inst.get(), url.str()), value);
 	} else {
 		http::PostForms forms;
 		forms["chat_id"] = http::value{chatId.c_str(), nullptr, nullptr};
@@ -2011,12 +2246,10 @@ api_types::Message tgbot::methods::Api::sendPhoto(
 			forms["reply_markup"] = http::value{replyMarkup.toString().c_str(), nullptr, nullptr};
 
 		parseJsonObject(
-				http::multiPartUpload(inst, baseApi + "/sendPhoto", forms),
+				http::multiPartUpload(inst.get(), baseApi + "/sendPhoto", forms),
 				value);
 	}
 
-	curl_easy_cleanup(inst);
-
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
@@ -2031,7 +2264,7 @@ api_types::Message tgbot::methods::Api::sendAudio(
 		const std::string &performer, const std::string &title,
 		const bool &disableNotification, const int &replyToMessageId,
 		const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 	const std::string &&markup = replyMarkup.toString();
 
@@ -2070,7 +2303,7 @@ api_types::Message tgbot::methods::Api::sendAudio(
 			encode(url, markup);
 		}
 
-		parseJsonObject(http::get(inst, url.str()), value);
+		parseJsonObject(http::get(inst.get(), url.str()), value);
 	} else {
 		http::PostForms forms;
 		forms["chat_id"] = http::value{chatId.c_str(), nullptr, nullptr};
@@ -2098,12 +2331,10 @@ api_types::Message tgbot::methods::Api::sendAudio(
 			forms["reply_markup"] = http::value{replyMarkup.toString().c_str(), nullptr, nullptr};
 
 		parseJsonObject(
-				http::multiPartUpload(inst, baseApi + "/sendAudio", forms),
+				http::multiPartUpload(inst.get(), baseApi + "/sendAudio", forms),
 				value);
 	}
 
-	curl_easy_cleanup(inst);
-
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
@@ -2116,7 +2347,7 @@ api_types::Message tgbot::methods::Api::sendVoice(
 		const types::FileSource &source, const std::string &caption,
 		const int &duration, const bool &disableNotification,
 		const int &replyToMessageId, const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 	const std::string &&markup = replyMarkup.toString();
 
@@ -2142,7 +2373,7 @@ api_types::Message tgbot::methods::Api::sendVoice(
 			encode(url, markup);
 		}
 
-		parseJsonObject(http::get(inst, url.str()), value);
+		parseJsonObject(http::get(inst.get(), url.str()), value);
 	} else {
 		http::PostForms forms;
 		forms["chat_id"] = http::value{chatId.c_str(), nullptr, nullptr};
@@ -2164,10 +2395,9 @@ api_types::Message tgbot::methods::Api::sendVoice(
 			forms["reply_markup"] = http::value{replyMarkup.toString().c_str(), nullptr, nullptr};
 
 		parseJsonObject(http::multiPartUpload(
-				inst, baseApi + "/sendVoice", forms),
+				inst.get(), baseApi + "/sendVoice", forms),
 		                value);
 	}
-	curl_easy_cleanup(inst);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -2180,7 +2410,7 @@ api_types::Message tgbot::methods::Api::sendSticker(
 		const std::string &chatId, const std::string &sticker,
 		const types::FileSource &source, const bool &disableNotification,
 		const int &replyToMessageId, const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 	const std::string &&markup = replyMarkup.toString();
 
@@ -2200,7 +2430,7 @@ api_types::Message tgbot::methods::Api::sendSticker(
 			encode(url, markup);
 		}
 
-		parseJsonObject(http::get(inst, url.str()), value);
+		parseJsonObject(http::get(inst.get(), url.str()), value);
 	} else {
 
 		http::PostForms forms;
@@ -2216,10 +2446,9 @@ api_types::Message tgbot::methods::Api::sendSticker(
 		if(!markup.empty())
 			forms["reply_markup"] = http::value{replyMarkup.toString().c_str(), nullptr, nullptr};
 		parseJsonObject(
-				http::multiPartUpload(inst, baseApi + "/sendSticker", forms),
+				http::multiPartUpload(inst.get(), baseApi + "/sendSticker", forms),
 				value);
 	}
-	curl_easy_cleanup(inst);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -2233,7 +2462,7 @@ api_types::Message tgbot::methods::Api::sendVideoNote(
 		const types::FileSource &source, const std::string &caption,
 		const int &duration, const bool &disableNotification,
 		const int &replyToMessageId, const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 	const std::string &&markup = replyMarkup.toString();
 
@@ -2260,7 +2489,7 @@ api_types::Message tgbot::methods::Api::sendVideoNote(
 			encode(url, markup);
 		}
 
-		parseJsonObject(http::get(inst, url.str()), value);
+		parseJsonObject(http::get(inst.get(), url.str()), value);
 	} else {
 
 		http::PostForms forms;
@@ -2283,10 +2512,9 @@ api_types::Message tgbot::methods::Api::sendVideoNote(
 			forms["reply_markup"] = http::value{replyMarkup.toString().c_str(), nullptr, nullptr};
 
 		parseJsonObject(
-				http::multiPartUpload(inst, baseApi + "/sendVideoNote", forms),
+				http::multiPartUpload(inst.get(), baseApi + "/sendVideoNote", forms),
 				value);
 	}
-	curl_easy_cleanup(inst);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -2298,7 +2526,7 @@ api_types::Message tgbot::methods::Api::sendVideoNote(
 api_types::Message tgbot::methods::Api::editMessageLiveLocation(
 		const double &longitude, const double &latitude, const int &chatId,
 		const int &messageId, const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -2312,8 +2540,7 @@ api_types::Message tgbot::methods::Api::editMessageLiveLocation(
 		encode(url, markup);
 	}
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -2325,7 +2552,7 @@ api_types::Message tgbot::methods::Api::editMessageLiveLocation(
 		const double &longitude, const double &latitude,
 		const std::string &inlineMessageId,
 		const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -2338,8 +2565,7 @@ api_types::Message tgbot::methods::Api::editMessageLiveLocation(
 		encode(url, markup);
 	}
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -2351,7 +2577,7 @@ api_types::Message tgbot::methods::Api::editMessageLiveLocation(
 api_types::Message tgbot::methods::Api::stopMessageLiveLocation(
 		const int &chatId, const int &messageId,
 		const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -2364,8 +2590,7 @@ api_types::Message tgbot::methods::Api::stopMessageLiveLocation(
 		encode(url, markup);
 	}
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -2376,7 +2601,7 @@ api_types::Message tgbot::methods::Api::stopMessageLiveLocation(
 api_types::Message tgbot::methods::Api::stopMessageLiveLocation(
 		const std::string &inlineMessageId,
 		const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -2389,8 +2614,7 @@ api_types::Message tgbot::methods::Api::stopMessageLiveLocation(
 		encode(url, markup);
 	}
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -2401,7 +2625,7 @@ api_types::Message tgbot::methods::Api::stopMessageLiveLocation(
 // setChatStickerSet
 bool tgbot::methods::Api::setChatStickerSet(
 		const int &chatId, const std::string &stickerSetName) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -2409,18 +2633,19 @@ bool tgbot::methods::Api::setChatStickerSet(
 	url << baseApi << "/setChatStickerSet?chat_id=" << chatId
 	    << "&sticker_set_name=" << stickerSetName;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) chatQueries->invalidateChat(std::to_string(chatId));
+
 	return true;
 }
 
 bool tgbot::methods::Api::setChatStickerSet(
 		const std::string &chatId, const std::string &stickerSetName) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -2428,48 +2653,51 @@ bool tgbot::methods::Api::setChatStickerSet(
 	url << baseApi << "/setChatStickerSet?chat_id=" << chatId
 	    << "&sticker_set_name=" << stickerSetName;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) chatQueries->invalidateChat(chatId);
+
 	return true;
 }
 
 // deleteChatStickerSet
 bool tgbot::methods::Api::deleteChatStickerSet(const int &chatId) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
 
 	url << baseApi << "/deleteChatStickerSet?chat_id=" << chatId;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) chatQueries->invalidateChat(std::to_string(chatId));
+
 	return true;
 }
 
 bool tgbot::methods::Api::deleteChatStickerSet(
 		const std::string &chatId) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
 
 	url << baseApi << "/deleteChatStickerSet?chat_id=" << chatId;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
 
+	if (chatQueries) chatQueries->invalidateChat(chatId);
+
 	return true;
 }
 
@@ -2477,7 +2705,7 @@ std::vector<api_types::Message> tgbot::methods::Api::sendMediaGroup(
 		const std::string &chatId,
 		const std::vector<tgbot::types::Ptr<types::InputMedia>> &media,
 		const bool &disableNotification, const int &replyToMessageId) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	http::PostForms forms;
@@ -2491,9 +2719,8 @@ std::vector<api_types::Message> tgbot::methods::Api::sendMediaGroup(
 		forms["reply_to_message_id"] = http::value{std::to_string(replyToMessageId).c_str(), nullptr, nullptr};
 
 	parseJsonObject(
-			http::multiPartUpload(inst, baseApi + "/sendMediaGroup", forms),
+			http::multiPartUpload(inst.get(), baseApi + "/sendMediaGroup", forms),
 			value);
-	curl_easy_cleanup(inst);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -2510,7 +2737,7 @@ api_types::Message tgbot::methods::Api::editMessageMedia(
 		const types::InputMedia &media,
 		const types::ReplyMarkup &replyMarkup) const {
 
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -2525,8 +2752,7 @@ api_types::Message tgbot::methods::Api::editMessageMedia(
 		encode(url, markup);
 	}
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -2540,7 +2766,7 @@ tgbot::methods::Api::editMessageMedia(
 		const int &messageId,
 		const types::InputMedia &media,
 		const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -2555,8 +2781,7 @@ tgbot::methods::Api::editMessageMedia(
 		encode(url, markup);
 	}
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -2568,7 +2793,7 @@ api_types::Message Api::sendPoll(const std::string &chatId,
 		const std::string &question, const std::vector<std::string> &options,
 		const bool &disableNotification, const int &replyToMessageId,
               const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -2593,8 +2818,7 @@ api_types::Message Api::sendPoll(const std::string &chatId,
 	if (replyToMessageId != -1)
 		url << "&reply_to_message_id=" << replyToMessageId;
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
@@ -2604,7 +2828,7 @@ api_types::Message Api::sendPoll(const std::string &chatId,
 
 tgbot::types::Poll Api::stopPoll(const std::string &chatId,
 		const int &messageId, const types::ReplyMarkup &replyMarkup) const {
-	CURL *inst = http::curlEasyInit();
+	http::CurlHandle inst(http::curlEasyInit());
 	Json::Value value;
 
 	std::stringstream url;
@@ -2616,8 +2840,7 @@ tgbot::types::Poll Api::stopPoll(const std::string &chatId,
 		encode(url, markup);
 	}
 
-	parseJsonObject(http::get(inst, url.str()), value);
-	curl_easy_cleanup(inst);
+	parseJsonObject(http::get(inst.get(), url.str()), value);
 
 	if (!value.get("ok", "").asBool())
 		throw TelegramException(value.get("description", "").asCString());
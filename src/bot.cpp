@@ -1,8 +1,15 @@
 #include <tgbot/bot.h>
 #include <tgbot/logger.h>
+#include <tgbot/metrics.h>
 #include <tgbot/utils/https.h>
+#include <tgbot/utils/journal.h>
+#include <tgbot/watchdog.h>
+#include <json/json.h>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
 #include <sstream>
-#include <thread>
+#include <unordered_map>
 
 using namespace tgbot;
 
@@ -12,33 +19,276 @@ tgbot::LongPollBot::LongPollBot(
 		const int &timeout)
 		: Bot(token, filterUpdates, limit, timeout) {}
 
+static utils::http::CurlHandle longPollConnection() {
+	utils::http::CurlHandle fetchConnection(utils::http::curlEasyInit());
+
+	curl_easy_setopt(fetchConnection.get(), CURLOPT_TCP_KEEPALIVE, 1L);
+	curl_easy_setopt(fetchConnection.get(), CURLOPT_TCP_KEEPIDLE, 60);
+
+	return fetchConnection;
+}
+
 void tgbot::LongPollBot::start() {
-	getLogger().info("starting HTTP long poll...");
+	static metrics::Counter &recycled = metrics::Registry::global().counter(
+			"tgbot_updates_poll_recycled_total", "",
+			"Long poll connections dropped after a stalled getUpdates");
 
-	CURL *fetchConnection = utils::http::curlEasyInit();
+	replayJournal();
+	deriveAllowedUpdates();
 
-	curl_easy_setopt(fetchConnection, CURLOPT_TCP_KEEPALIVE, 1L);
-	curl_easy_setopt(fetchConnection, CURLOPT_TCP_KEEPIDLE, 60);
+	getLogger().info("starting HTTP long poll...");
+
+	utils::http::CurlHandle fetchConnection = longPollConnection();
 
 	std::vector<types::Update> updates;
 	while (true) {
-		if (getUpdates(fetchConnection, updates)) {
+		int nUpdates;
+
+		try {
+			nUpdates = fetchUpdates(fetchConnection.get(), updates);
+		} catch (const utils::http::TransferTimeout &e) {
+			// half-open or stuck connection: start over with a new one
+			getLogger().warn(std::string("getUpdates stalled (") + e.what() +
+			                 "), reconnecting");
+			recycled.increment();
+
+			updates.clear();
+			fetchConnection = longPollConnection();
+			continue;
+		}
+
+		if (nUpdates) {
 			makeCallback(updates);
 			updates.clear();
 		}
 	}
 }
 
-void tgbot::Bot::makeCallback(const std::vector<types::Update> &updates) const {
-	std::thread tmpHolder;
-
-	for (auto const &update : updates) {
+void tgbot::Bot::makeCallback(std::vector<types::Update> &updates) const {
+	for (auto &update : updates) {
 		if (__notifyEachUpdate)
-			getLogger().info("received update - " + std::to_string(update.updateId));
+			TGBOT_LOG_INFO(getLogger(),
+			               "received update - " + std::to_string(update.updateId));
+
+		dispatch(update);
+	}
+}
+
+namespace {
+
+	struct DispatchMetrics {
+		tgbot::metrics::Histogram &wait;
+		tgbot::metrics::Histogram &duration;
+		tgbot::metrics::Counter &unhandled;
+	};
+
+}  // namespace
+
+static DispatchMetrics &dispatchMetricsOf(types::UpdateType updateType) {
+	static const std::vector<DispatchMetrics> byType = [] {
+		tgbot::metrics::Registry &registry = tgbot::metrics::Registry::global();
+		std::vector<DispatchMetrics> metrics;
+
+		for (int i = 0; i <= static_cast<int>(types::UpdateType::CHANNEL_POST); ++i) {
+			const std::string &typeLabel = tgbot::metrics::label(
+					"type", types::updateTypeName(static_cast<types::UpdateType>(i)));
+
+			metrics.push_back(DispatchMetrics{
+					registry.histogram("tgbot_dispatch_wait_seconds", typeLabel,
+					                   "Time between dispatch and handler start"),
+					registry.histogram("tgbot_handler_duration_seconds", typeLabel,
+					                   "Handler run time"),
+					registry.counter("tgbot_updates_unhandled_total", typeLabel,
+					                 "Updates without a registered handler")});
+		}
+
+		return metrics;
+	}();
+
+	return const_cast<DispatchMetrics &>(byType[static_cast<int>(updateType)]);
+}
+
+static tgbot::metrics::Gauge &handlersInFlight() {
+	static tgbot::metrics::Gauge &inFlight = tgbot::metrics::Registry::global().gauge(
+			"tgbot_handlers_in_flight", "", "Handlers dispatched and not yet finished");
+	return inFlight;
+}
+
+tgbot::Bot::HandlerTicket::HandlerTicket(
+		const types::Update &update,
+		std::chrono::steady_clock::time_point _received,
+		const trace::Context &_batch)
+		: updateType(update.updateType), updateId(update.updateId),
+		  received(_received), queued(std::chrono::steady_clock::now()),
+		  batch(_batch) {
+	handlersInFlight().add();
+
+	if (trace::enabled()) {
+		context.traceId = trace::newId();
+		context.spanId = trace::newId();
+	}
+}
+
+void tgbot::Bot::HandlerTicket::started() {
+	start = std::chrono::steady_clock::now();
+	dispatchMetricsOf(updateType).wait.record(metrics::microsSince(queued));
+	watchId = __handlerStarted(updateId, updateType, cancelToken);
+
+	if (context)
+		trace::record(trace::Span{"queue", "", context.traceId, trace::newId(),
+		                          context.spanId, queued, start, trace::Context()});
+}
+
+void tgbot::Bot::HandlerTicket::finished() {
+	const std::uint64_t took = metrics::microsSince(start);
+	__handlerFinished(watchId);
+
+	dispatchMetricsOf(updateType).duration.record(took);
+	if (context)
+		trace::record(trace::Span{
+				"update",
+				std::string(types::updateTypeName(updateType)) + " " +
+				std::to_string(updateId),
+				context.traceId, context.spanId, 0, received,
+				std::chrono::steady_clock::now(), batch});
+
+	metrics::slowHandlers().record(took, [this] {
+		return std::string(types::updateTypeName(updateType)) + " update " +
+		       std::to_string(updateId);
+	});
+	handlersInFlight().sub();
+}
+
+void tgbot::Bot::HandlerTicket::dropped() { handlersInFlight().sub(); }
+
+template<typename _Run>
+void tgbot::Bot::runTicket(HandlerTicket &ticket, const Bot &bot, _Run &&run) {
+	// however the handler ends: no longer in flight, done for the journal
+	struct Finish {
+		~Finish() {
+			ticket.finished();
+			if (bot.updateJournal) bot.updateJournal->completed(ticket.updateId);
+		}
 
-		if (update.updateType == types::UpdateType::MESSAGE) {
-			types::Message messageObject = std::move(*update.message);
-			bool byCommandStart = false;
+		HandlerTicket &ticket;
+		const Bot &bot;
+	};
+
+	ticket.started();
+	Finish finish{ticket, bot};
+
+	auto handler = [&ticket] {
+		return "handler for update " + std::to_string(ticket.updateId);
+	};
+
+	try {
+		utils::CancelToken::Scope cancelScope(ticket.cancelToken);
+		trace::ScopedSpan handlerSpan("handler", ticket.context);
+		run();
+	} catch (const utils::http::TransferCancelled &) {
+		bot.getLogger().warn(handler() + " cancelled");
+	} catch (const std::exception &e) {
+		// would terminate the process, every other handler with it
+		bot.getLogger().error(handler() + " threw: " + e.what());
+	} catch (...) {
+		bot.getLogger().error(handler() + " threw an unknown exception");
+	}
+}
+
+template<typename _Payload>
+struct tgbot::Bot::HandlerTask {
+	void operator()() {
+		runTicket(ticket, bot, [this] { callback(std::move(payload), bot); });
+	}
+
+	HandlerTicket ticket;
+	__T_UpdateCallback<_Payload> callback;
+	_Payload payload;
+	Bot bot;
+};
+
+struct tgbot::Bot::CommandTask {
+	void operator()() {
+		runTicket(ticket, bot, [this] {
+			callback(std::move(message), bot, std::move(args));
+		});
+	}
+
+	HandlerTicket ticket;
+	std::function<void(const types::Message, const methods::Api &,
+	                   const std::vector<std::string>)> callback;
+	types::Message message;
+	Bot bot;
+	std::vector<std::string> args;
+};
+
+struct tgbot::Bot::InlineQueryTask {
+	void operator()() {
+		if (!coalescer->start(userId, generation, ticket.cancelToken)) {
+			// user typed on meanwhile
+			ticket.dropped();
+			if (bot.updateJournal) bot.updateJournal->completed(ticket.updateId);
+			return;
+		}
+
+		runTicket(ticket, bot, [this] { callback(std::move(query), bot); });
+		coalescer->finish(userId, generation);
+	}
+
+	HandlerTicket ticket;
+	InlineQueryCallback callback;
+	types::InlineQuery query;
+	Bot bot;
+	std::shared_ptr<utils::Coalescer> coalescer;
+	std::int64_t userId;
+	std::uint64_t generation;
+};
+
+template<typename _Task>
+void tgbot::Bot::spawn(_Task &&task) const {
+	if (!__workers) {
+		std::thread(std::forward<_Task>(task)).detach();
+		return;
+	}
+
+	// payloads are move-only, std::function wants a copyable target
+	const std::shared_ptr<typename std::decay<_Task>::type> &boxed =
+			std::make_shared<typename std::decay<_Task>::type>(
+					std::forward<_Task>(task));
+
+	__workers->submit(__workerQueue, [boxed] { (*boxed)(); });
+}
+
+template<typename _Payload>
+void tgbot::Bot::spawnHandler(const types::Update &update,
+                              const __T_UpdateCallback<_Payload> &callback,
+                              _Payload &payload) const {
+	spawn(HandlerTask<_Payload>{HandlerTicket(update, batchReceivedAt, batchTrace),
+	                            callback, std::move(payload), *this});
+}
+
+void tgbot::Bot::expandCallbackData(types::CallbackQuery &query) const {
+	static metrics::Counter &unresolved = metrics::Registry::global().counter(
+			"tgbot_callback_data_unresolved_total", "",
+			"Callback data tokens without a payload (expired or unknown)");
+
+	if (!query.data || !utils::CallbackDataStore::isToken(*query.data)) return;
+
+	std::string payload;
+	if (__callbackData->get(*query.data, payload))
+		*query.data = std::move(payload);
+	else
+		unresolved.increment();
+}
+
+void tgbot::Bot::dispatch(types::Update &update) const {
+	bool handled = true;
+
+	if (!update.hasPayload())
+		handled = false;
+	else switch (update.updateType) {
+		case types::UpdateType::MESSAGE: {
+			types::Message &messageObject = *update.message();
 
 			if (!commandCallback.empty() && messageObject.text) {
 				for (auto const &c : commandCallback) {
@@ -49,67 +299,346 @@ void tgbot::Bot::makeCallback(const std::vector<types::Update> &updates) const {
 
 						while (getline(istr, arg, ' ')) args.push_back(std::move(arg));
 
-						tmpHolder = std::thread(std::get<3>(c), std::move(messageObject),
-						                        *this, std::move(args));
-						byCommandStart = true;
-						break;
+						spawn(CommandTask{HandlerTicket(update, batchReceivedAt, batchTrace),
+						                  std::get<3>(c), std::move(messageObject), *this,
+						                  std::move(args)});
+						return;
 					}
 				}
 			}
 
-			if (messageCallback && !byCommandStart)
-				tmpHolder =
-						std::thread(messageCallback, std::move(messageObject), *this);
-			else if (!messageCallback && !byCommandStart)
-				getLogger().error(
-						"could not make any call to handler... Did you forgot "
-						"Bot::callback() or something else?");
-		} else if (update.updateType == types::UpdateType::EDITED_MESSAGE &&
-		           editedMessageCallback)
-			tmpHolder = std::thread(editedMessageCallback,
-			                        std::move(*update.editedMessage), *this);
-
-		else if (update.updateType == types::UpdateType::CALLBACK_QUERY &&
-		         callbackQueryCallback)
-			tmpHolder = std::thread(callbackQueryCallback,
-			                        std::move(*update.callbackQuery), *this);
-
-		else if (update.updateType == types::UpdateType::CHOSEN_INLINE_RESULT &&
-		         chosenInlineResultCallback)
-			tmpHolder = std::thread(chosenInlineResultCallback,
-			                        std::move(*update.chosenInlineResult), *this);
-
-		else if (update.updateType == types::UpdateType::EDITED_CHANNEL_POST &&
-		         editedChannelPostCallback)
-			tmpHolder = std::thread(editedChannelPostCallback,
-			                        std::move(*update.editedChannelPost), *this);
-
-		else if (update.updateType == types::UpdateType::INLINE_QUERY &&
-		         inlineQueryCallback)
-			tmpHolder = std::thread(inlineQueryCallback,
-			                        std::move(*update.inlineQuery), *this);
-
-		else if (update.updateType == types::UpdateType::PRE_CHECKOUT_QUERY &&
-		         preCheckoutQueryCallback)
-			tmpHolder = std::thread(preCheckoutQueryCallback,
-			                        std::move(*update.preCheckoutQuery), *this);
-
-		else if (update.updateType == types::UpdateType::SHIPPING_QUERY &&
-		         shippingQueryCallback)
-			tmpHolder = std::thread(shippingQueryCallback,
-			                        std::move(*update.shippingQuery), *this);
-
-		else if (update.updateType == types::UpdateType::CHANNEL_POST &&
-		         channelPostCallback)
-			tmpHolder = std::thread(channelPostCallback,
-			                        std::move(*update.channelPost), *this);
-		else
-			getLogger().error(
-					"could not make any call to handler... Did you forgot "
-					"Bot::callback() or something else?");
-
-		if (tmpHolder.joinable()) tmpHolder.detach();
+			if (messageCallback)
+				spawnHandler(update, messageCallback, messageObject);
+			else
+				handled = false;
+			break;
+		}
+
+		case types::UpdateType::EDITED_MESSAGE:
+			if ((handled = static_cast<bool>(editedMessageCallback)))
+				spawnHandler(update, editedMessageCallback, *update.editedMessage());
+			break;
+
+		case types::UpdateType::CALLBACK_QUERY:
+			if (!(handled = static_cast<bool>(callbackQueryCallback)))
+				break;
+
+			if (__callbackData) expandCallbackData(*update.callbackQuery());
+
+			spawnHandler(update, callbackQueryCallback, *update.callbackQuery());
+			break;
+
+		case types::UpdateType::CHOSEN_INLINE_RESULT:
+			if ((handled = static_cast<bool>(chosenInlineResultCallback)))
+				spawnHandler(update, chosenInlineResultCallback,
+				             *update.chosenInlineResult());
+			break;
+
+		case types::UpdateType::EDITED_CHANNEL_POST:
+			if ((handled = static_cast<bool>(editedChannelPostCallback)))
+				spawnHandler(update, editedChannelPostCallback,
+				             *update.editedChannelPost());
+			break;
+
+		case types::UpdateType::INLINE_QUERY:
+			if (!(handled = static_cast<bool>(inlineQueryCallback)))
+				break;
+
+			if (__inlineQueries) {
+				types::InlineQuery &query = *update.inlineQuery();
+				const std::int64_t userId = query.from.id;
+
+				spawn(InlineQueryTask{HandlerTicket(update, batchReceivedAt, batchTrace),
+				                      inlineQueryCallback, std::move(query), *this,
+				                      __inlineQueries, userId,
+				                      __inlineQueries->submit(userId)});
+			} else
+				spawnHandler(update, inlineQueryCallback, *update.inlineQuery());
+			break;
+
+		case types::UpdateType::PRE_CHECKOUT_QUERY:
+			if ((handled = static_cast<bool>(preCheckoutQueryCallback)))
+				spawnHandler(update, preCheckoutQueryCallback,
+				             *update.preCheckoutQuery());
+			break;
+
+		case types::UpdateType::SHIPPING_QUERY:
+			if ((handled = static_cast<bool>(shippingQueryCallback)))
+				spawnHandler(update, shippingQueryCallback, *update.shippingQuery());
+			break;
+
+		case types::UpdateType::CHANNEL_POST:
+			if ((handled = static_cast<bool>(channelPostCallback)))
+				spawnHandler(update, channelPostCallback, *update.channelPost());
+			break;
 	}
+
+	if (!handled) {
+		if (update.hasPayload())
+			dispatchMetricsOf(update.updateType).unhandled.increment();
+
+		getLogger().error(
+				"could not make any call to handler... Did you forgot "
+				"Bot::callback() or something else?");
+
+		if (updateJournal) updateJournal->completed(update.updateId);
+	}
+}
+
+int tgbot::Bot::fetchUpdates(void *c, std::vector<types::Update> &updates) {
+	trace::ScopedSpan pollSpan("poll");
+
+	if (__parsers) {
+		const auto start = std::chrono::steady_clock::now();
+		return dispatchInParallel(
+				utils::http::get(c, updatesRequest(), updatesTimeouts()), start);
+	}
+
+	return getUpdates(c, updates);
+}
+
+int tgbot::Bot::receiveUpdates(const std::string &body,
+                               std::chrono::steady_clock::time_point polledSince,
+                               std::vector<types::Update> &updates) {
+	if (__parsers) return dispatchInParallel(body, polledSince);
+
+	return parseUpdates(body, polledSince, updates);
+}
+
+// updates of a chat (or of a user, outside of chats) keep their order
+static std::int64_t orderingKeyOf(const Json::Value &update) {
+	const Json::Value *message = tgbot::filters::messageOf(update);
+	if (message) return (*message)["chat"]["id"].asInt64();
+
+	for (auto member = update.begin(); member != update.end(); ++member) {
+		if (!member->isObject()) continue;
+
+		// callback queries go with the chat of their message
+		const Json::Value &inner = (*member)["message"];
+		if (inner.isObject()) return inner["chat"]["id"].asInt64();
+
+		return (*member)["from"]["id"].asInt64();
+	}
+
+	return 0;
+}
+
+int tgbot::Bot::dispatchInParallel(const std::string &body,
+                                   std::chrono::steady_clock::time_point polledSince) {
+	static metrics::Histogram &parseDuration = metrics::Registry::global().histogram(
+			"tgbot_updates_parse_duration_seconds", "",
+			"Time spent parsing a getUpdates batch");
+	static metrics::Histogram &parseTasks = metrics::Registry::global().histogram(
+			"tgbot_updates_parse_tasks", "",
+			"Parallel parse tasks (chats) per getUpdates batch", 1);
+
+	std::vector<Json::Value> raw;
+	const int nUpdates = parseUpdates(body, polledSince, raw);
+	if (!nUpdates) return 0;
+
+	const std::uint64_t scanned = metrics::microsSince(batchReceivedAt);
+
+	std::unordered_map<std::int64_t, std::vector<Json::Value>> chats;
+	std::vector<std::int64_t> order;  // chats, by their first update
+	for (Json::Value &update : raw) {
+		const std::int64_t key = orderingKeyOf(update);
+		std::vector<Json::Value> &chat = chats[key];
+		if (chat.empty()) order.push_back(key);
+		chat.push_back(std::move(update));
+	}
+
+	struct Batch {
+		std::mutex mtx;
+		std::condition_variable done;
+		std::size_t pending;
+		std::uint64_t slowestParse{0};  // of a chat, dispatch excluded
+	};
+
+	const std::shared_ptr<Batch> &batch = std::make_shared<Batch>();
+	batch->pending = order.size();
+
+	// this bot outlives the tasks: the poll waits for the whole batch, even
+	// when submitting the rest of it fails
+	std::size_t submitted = 0;
+	try {
+		for (std::int64_t key : order) {
+			const std::shared_ptr<std::vector<Json::Value>> &chat =
+					std::make_shared<std::vector<Json::Value>>(std::move(chats[key]));
+
+			__parsers->submit(__parseQueue, [this, chat, batch] {
+				std::uint64_t parsing = 0;
+
+				for (const Json::Value &object : *chat) {
+					try {
+						const auto start = std::chrono::steady_clock::now();
+						types::Update update(object);
+						parsing += metrics::microsSince(start);
+
+						if (__notifyEachUpdate)
+							TGBOT_LOG_INFO(getLogger(), "received update - " +
+							                            std::to_string(update.updateId));
+
+						dispatch(update);
+					} catch (const std::exception &e) {
+						getLogger().error(std::string("could not dispatch update: ") + e.what());
+
+						// dispatch() throws before spawning a handler (parse error, no
+						// thread, pool joined): none will finish it, don't replay it
+						// at each restart
+						if (updateJournal && object["update_id"].isInt())
+							updateJournal->completed(object["update_id"].asInt());
+					}
+				}
+
+				std::lock_guard<std::mutex> guard(batch->mtx);
+				batch->slowestParse = std::max(batch->slowestParse, parsing);
+				if (!--batch->pending) batch->done.notify_all();
+			});
+
+			++submitted;
+		}
+	} catch (...) {
+		// unsubmitted chats aren't dispatched (nor completed in the journal)
+		std::unique_lock<std::mutex> lock(batch->mtx);
+		batch->pending -= order.size() - submitted;
+		batch->done.wait(lock, [&batch] { return !batch->pending; });
+		throw;
+	}
+
+	std::unique_lock<std::mutex> lock(batch->mtx);
+	batch->done.wait(lock, [&batch] { return !batch->pending; });
+
+	// JSON scan, then the chat slowest to deserialize: waits excluded
+	parseDuration.record(scanned + batch->slowestParse);
+	parseTasks.record(static_cast<std::uint64_t>(order.size()));
+
+	return nUpdates;
+}
+
+void tgbot::Bot::deriveAllowedUpdates() {
+	std::vector<types::UpdateType> handled = handledUpdateTypes();
+
+	// the chat query cache learns what's stale from messages, handled or not
+	observedOnly.clear();
+	if (chatQueries && !handled.empty())
+		for (const auto updateType : {types::UpdateType::MESSAGE,
+		                              types::UpdateType::CHANNEL_POST})
+			if (std::find(handled.begin(), handled.end(), updateType) == handled.end())
+				observedOnly.push_back(updateType);
+
+	handled.insert(handled.end(), observedOnly.begin(), observedOnly.end());
+
+	if (!restrictUpdates(handled)) return;
+
+	std::string names;
+	for (const auto &updateType : handled)
+		names += (names.empty() ? "" : ", ") + std::string(types::updateTypeName(updateType));
+
+	getLogger().info("polling for: " + (names.empty() ? "any update" : names));
+}
+
+void tgbot::Bot::replayJournal() {
+	static metrics::Counter &givenUp = metrics::Registry::global().counter(
+			"tgbot_journal_given_up_total", "",
+			"Journaled updates not replayed anymore, too many attempts");
+
+	if (!updateJournal) return;
+
+	std::vector<types::Update> updates;
+	for (const auto &record : updateJournal->pending()) {
+		Json::Value object;
+		std::string errors;
+
+		std::unique_ptr<Json::CharReader> reader(Json::CharReaderBuilder().newCharReader());
+		if (!reader->parse(record.second.data(),
+		                   record.second.data() + record.second.size(), &object,
+		                   &errors)) {
+			getLogger().error("journaled update " + std::to_string(record.first) +
+			                  " is not valid JSON, skipping it");
+			updateJournal->completed(record.first);
+			continue;
+		}
+
+		// counted before dispatch: a crash in the handler counts too
+		const unsigned attempts = updateJournal->attempt(record.first);
+		if (attempts > __journalAttempts) {
+			getLogger().error("journaled update " + std::to_string(record.first) +
+			                  " didn't complete in " +
+			                  std::to_string(attempts - 1) +
+			                  " attempts, giving up on it");
+			givenUp.increment();
+			updateJournal->completed(record.first);
+			continue;
+		}
+
+		updates.emplace_back(object);
+	}
+
+	if (updates.empty()) return;
+
+	getLogger().warn("replaying " + std::to_string(updates.size()) +
+	                 " journaled updates left unfinished");
+
+	batchReceivedAt = std::chrono::steady_clock::now();
+	batchTrace = trace::Context();
+	makeCallback(updates);
 }
 
 void tgbot::Bot::notifyEachUpdate(bool t) { __notifyEachUpdate = t; }
+
+// apart from handler workers: a batch must not wait behind handlers, which
+// may be waiting for the poll to end (BotHost event loop). Bots share its one
+// queue: each waits for its own tasks only, and a queue per bot would outlive
+// the bot
+static const std::shared_ptr<utils::WorkerPool> &parsePool(std::size_t &queue) {
+	static const std::shared_ptr<utils::WorkerPool> pool =
+			std::make_shared<utils::WorkerPool>(
+					std::max(2u, std::thread::hardware_concurrency()));
+	static const std::size_t parseQueue =
+			pool->addQueue(metrics::label("pool", "parse"));
+
+	queue = parseQueue;
+	return pool;
+}
+
+void tgbot::Bot::parseBatchesInParallel(bool t) {
+	if (!t) {
+		__parsers = nullptr;
+		return;
+	}
+
+	if (!__parsers) __parsers = parsePool(__parseQueue);
+}
+
+void tgbot::Bot::resolveCallbackData(
+		std::shared_ptr<utils::CallbackDataStore> store) {
+	__callbackData = std::move(store);
+}
+
+void tgbot::Bot::cacheChatQueries(std::shared_ptr<methods::ChatQueryCache> cache) {
+	chatQueries = std::move(cache);
+}
+
+void tgbot::Bot::trackEntities(std::shared_ptr<utils::EntityCache> cache) {
+	entityCache = std::move(cache);
+}
+
+void tgbot::Bot::coalesceInlineQueries(bool t) {
+	__inlineQueries = t ? std::make_shared<utils::Coalescer>("inline_query") : nullptr;
+}
+
+void tgbot::Bot::runHandlersOn(std::shared_ptr<utils::WorkerPool> workers,
+                               std::size_t queue) {
+	__workers = std::move(workers);
+	__workerQueue = queue;
+}
+
+void tgbot::Bot::preFilter(filters::UpdateFilter keep) {
+	updateFilter = std::move(keep);
+}
+
+void tgbot::Bot::useJournal(const std::string &path, bool syncEachBatch,
+                            unsigned maxAttempts) {
+	attachJournal(std::make_shared<utils::UpdateJournal>(path, syncEachBatch));
+	__journalAttempts = maxAttempts;
+}
@@ -0,0 +1,370 @@
+#include <tgbot/bot_host.h>
+#include <tgbot/metrics.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace metrics = tgbot::metrics;
+namespace http = tgbot::utils::http;
+
+namespace {
+
+	// what CURLOPT_PRIVATE of a transfer driven by the loop points to
+	struct Transfer {
+		bool poll;
+	};
+
+	struct Submitted : Transfer {
+		CURL *handle;
+
+		// shared: the submitter may return as soon as the value is set
+		std::shared_ptr<std::promise<CURLcode>> done;
+
+		void finish(CURLcode code) {
+			const std::shared_ptr<std::promise<CURLcode>> keep = done;
+			keep->set_value(code);
+		}
+	};
+
+	struct Poller : Transfer {
+		tgbot::Bot *bot;
+		std::string name;
+		http::CurlHandle handle;
+		http::PendingGet get;
+		bool active;
+		std::chrono::steady_clock::time_point retryAt;
+		std::vector<tgbot::types::Update> updates;
+
+		metrics::Counter *polls;
+		metrics::Counter *errors;
+		metrics::Counter *received;
+	};
+
+	thread_local bool onLoopThread = false;
+
+}  // namespace
+
+namespace tgbot {
+
+/*!
+ * @brief curl multi handle of a BotHost, plus transfers submitted to it by
+ * other threads
+ */
+	class __HostLoop : public utils::http::TransferExecutor {
+	public:
+		__HostLoop();
+
+		~__HostLoop();
+
+		/*!
+		 * @brief from any thread: run c on the loop, wait for its result
+		 */
+		CURLcode perform(CURL *c) override;
+
+		void wake();
+
+		/*!
+		 * @brief start accepting transfers
+		 */
+		void open();
+
+		/*!
+		 * @brief stop accepting transfers, fail the pending ones
+		 */
+		void close();
+
+		/*!
+		 * @brief add submitted transfers to the multi handle
+		 */
+		void admitSubmitted();
+
+		/*!
+		 * @brief submitted transfer is done
+		 */
+		void complete(Submitted *submitted, CURLcode code);
+
+		/*!
+		 * @brief wait for network activity or wake(), at most timeout
+		 */
+		void wait(std::chrono::milliseconds timeout);
+
+		CURLM *multi;
+		std::atomic<bool> stopRequested{false};
+
+	private:
+		std::mutex mtx;
+		bool accepting{false};
+		std::vector<Submitted *> queued;
+		std::unordered_set<Submitted *> running;
+		int wakeUp[2]{-1, -1};
+	};
+
+}  // namespace tgbot
+
+tgbot::__HostLoop::__HostLoop() : multi(curl_multi_init()) {
+	if (!multi) throw std::runtime_error("curl_multi_init() failed");
+
+	if (pipe(wakeUp) < 0) {
+		curl_multi_cleanup(multi);
+		throw std::runtime_error("BotHost: cannot create wake up pipe");
+	}
+
+	for (const int &fd : wakeUp)
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+tgbot::__HostLoop::~__HostLoop() {
+	::close(wakeUp[0]);
+	::close(wakeUp[1]);
+	curl_multi_cleanup(multi);
+}
+
+CURLcode tgbot::__HostLoop::perform(CURL *c) {
+	if (onLoopThread) return curl_easy_perform(c);
+
+	Submitted submitted;
+	submitted.poll = false;
+	submitted.handle = c;
+	submitted.done = std::make_shared<std::promise<CURLcode>>();
+	std::future<CURLcode> done = submitted.done->get_future();
+
+	bool submit;
+	{
+		std::lock_guard<std::mutex> guard(mtx);
+		submit = accepting;
+		if (submit) queued.push_back(&submitted);
+	}
+
+	// host not running: do it here
+	if (!submit) return curl_easy_perform(c);
+
+	wake();
+	return done.get();
+}
+
+void tgbot::__HostLoop::wake() {
+	const char byte = 0;
+	if (write(wakeUp[1], &byte, 1) < 0) {
+		// pipe full: loop is going to wake up anyway
+	}
+}
+
+void tgbot::__HostLoop::open() {
+	std::lock_guard<std::mutex> guard(mtx);
+	accepting = true;
+}
+
+void tgbot::__HostLoop::close() {
+	std::lock_guard<std::mutex> guard(mtx);
+	accepting = false;
+
+	for (Submitted *submitted : running) {
+		curl_multi_remove_handle(multi, submitted->handle);
+		submitted->finish(CURLE_ABORTED_BY_CALLBACK);
+	}
+
+	for (Submitted *submitted : queued)
+		submitted->finish(CURLE_ABORTED_BY_CALLBACK);
+
+	running.clear();
+	queued.clear();
+}
+
+void tgbot::__HostLoop::admitSubmitted() {
+	std::lock_guard<std::mutex> guard(mtx);
+
+	for (Submitted *submitted : queued) {
+		curl_easy_setopt(submitted->handle, CURLOPT_PRIVATE,
+		                 static_cast<Transfer *>(submitted));
+
+		if (curl_multi_add_handle(multi, submitted->handle) != CURLM_OK) {
+			submitted->finish(CURLE_FAILED_INIT);
+			continue;
+		}
+
+		running.insert(submitted);
+	}
+
+	queued.clear();
+}
+
+void tgbot::__HostLoop::complete(Submitted *submitted, CURLcode code) {
+	std::lock_guard<std::mutex> guard(mtx);
+
+	running.erase(submitted);
+	submitted->finish(code);
+}
+
+void tgbot::__HostLoop::wait(std::chrono::milliseconds timeout) {
+	curl_waitfd wakeUpFd;
+	wakeUpFd.fd = wakeUp[0];
+	wakeUpFd.events = CURL_WAIT_POLLIN;
+	wakeUpFd.revents = 0;
+
+	curl_multi_wait(multi, &wakeUpFd, 1, static_cast<int>(timeout.count()),
+	                nullptr);
+
+	if (wakeUpFd.revents) {
+		char drain[64];
+		while (read(wakeUp[0], drain, sizeof(drain)) > 0);
+	}
+}
+
+tgbot::BotHost::BotHost(std::size_t nWorkers)
+		: workers(std::make_shared<utils::WorkerPool>(nWorkers)),
+		  loop(std::make_shared<__HostLoop>()) {}
+
+tgbot::BotHost::~BotHost() {
+	stop();
+
+	// bots may outlive the host and share the pool: don't leave it to them
+	workers->join();
+	for (const Hosted &hosted : bots) hosted.bot->runHandlersOn(nullptr, 0);
+}
+
+void tgbot::BotHost::add(LongPollBot &bot, const std::string &name) {
+	const std::string &botName =
+			name.empty() ? "bot" + std::to_string(bots.size()) : name;
+
+	bot.runHandlersOn(workers, workers->addQueue(metrics::label("bot", botName)));
+	bots.push_back(Hosted{&bot, botName});
+}
+
+void tgbot::BotHost::stop() {
+	loop->stopRequested.store(true);
+	loop->wake();
+}
+
+static http::CurlHandle pollConnection() {
+	http::CurlHandle connection(http::curlEasyInit());
+
+	curl_easy_setopt(connection.get(), CURLOPT_TCP_KEEPALIVE, 1L);
+	curl_easy_setopt(connection.get(), CURLOPT_TCP_KEEPIDLE, 60);
+
+	return connection;
+}
+
+void tgbot::BotHost::run() {
+	using Clock = std::chrono::steady_clock;
+
+	metrics::Registry &registry = metrics::Registry::global();
+
+	std::vector<Poller> pollers(bots.size());
+	for (std::size_t i = 0; i < bots.size(); ++i) {
+		const std::string &botLabel = metrics::label("bot", bots[i].name);
+
+		Poller &poller = pollers[i];
+		poller.poll = true;
+		poller.bot = bots[i].bot;
+		poller.name = bots[i].name;
+		poller.handle = pollConnection();
+		poller.active = false;
+		poller.polls = &registry.counter("tgbot_host_polls_total", botLabel,
+		                                 "getUpdates completed by hosted bots");
+		poller.errors = &registry.counter("tgbot_host_poll_errors_total", botLabel,
+		                                  "getUpdates failed for hosted bots");
+		poller.received = &registry.counter("tgbot_host_updates_total", botLabel,
+		                                    "Updates received by hosted bots");
+
+		poller.bot->replayJournal();
+		poller.bot->deriveAllowedUpdates();
+		poller.bot->getLogger().info(poller.name + ": hosted, starting HTTP long poll...");
+	}
+
+	onLoopThread = true;
+	loop->open();
+	http::setTransferExecutor(loop);
+
+	const auto finishPoll = [](Poller &poller, CURLcode code) {
+		poller.active = false;
+
+		try {
+			const std::string &body = http::endGet(poller.handle.get(), poller.get, code);
+			poller.polls->increment();
+
+			const int nUpdates =
+					poller.bot->receiveUpdates(body, poller.get.start, poller.updates);
+			if (nUpdates) {
+				poller.received->increment(static_cast<std::uint64_t>(nUpdates));
+				poller.bot->makeCallback(poller.updates);
+			}
+		} catch (const http::TransferTimeout &e) {
+			poller.errors->increment();
+			poller.bot->getLogger().warn(poller.name + ": getUpdates stalled (" +
+			                             e.what() + "), reconnecting");
+
+			poller.handle = pollConnection();
+		} catch (const std::exception &e) {
+			// don't let one bot take the others down: retry later
+			poller.errors->increment();
+			poller.bot->getLogger().error(poller.name + ": getUpdates failed (" +
+			                              e.what() + "), retrying in 5s");
+			poller.retryAt = Clock::now() + std::chrono::seconds(5);
+		}
+
+		poller.updates.clear();
+	};
+
+	while (!loop->stopRequested.load()) {
+		const auto now = Clock::now();
+		std::chrono::milliseconds waitFor(1000);
+
+		for (auto &poller : pollers) {
+			if (poller.active) continue;
+
+			if (now < poller.retryAt) {
+				waitFor = std::min(waitFor, std::chrono::duration_cast<
+						std::chrono::milliseconds>(poller.retryAt - now));
+				continue;
+			}
+
+			poller.get.url = poller.bot->updatesRequest();
+			http::beginGet(poller.handle.get(), poller.get,
+			               poller.bot->updatesTimeouts());
+			curl_easy_setopt(poller.handle.get(), CURLOPT_PRIVATE,
+			                 static_cast<Transfer *>(&poller));
+
+			if (curl_multi_add_handle(loop->multi, poller.handle.get()) == CURLM_OK)
+				poller.active = true;
+		}
+
+		loop->admitSubmitted();
+
+		int stillRunning;
+		curl_multi_perform(loop->multi, &stillRunning);
+
+		int nMessages;
+		while (CURLMsg *message = curl_multi_info_read(loop->multi, &nMessages)) {
+			if (message->msg != CURLMSG_DONE) continue;
+
+			CURL *handle = message->easy_handle;
+			const CURLcode code = message->data.result;
+			curl_multi_remove_handle(loop->multi, handle);
+
+			Transfer *transfer = nullptr;
+			curl_easy_getinfo(handle, CURLINFO_PRIVATE, &transfer);
+
+			if (transfer->poll)
+				finishPoll(*static_cast<Poller *>(transfer), code);
+			else
+				loop->complete(static_cast<Submitted *>(transfer), code);
+		}
+
+		loop->wait(waitFor);
+	}
+
+	http::setTransferExecutor(nullptr);
+	loop->close();
+	onLoopThread = false;
+
+	for (auto &poller : pollers)
+		if (poller.active) curl_multi_remove_handle(loop->multi, poller.handle.get());
+
+	// this run is over: a stop() from now on is for the next one
+	loop->stopRequested.store(false);
+}
@@ -0,0 +1,377 @@
+#include <json/json.h>
+#include <tgbot/broadcast.h>
+#include <tgbot/utils/encode.h>
+#include <tgbot/utils/https.h>
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+tgbot::Broadcast::ChatSource tgbot::Broadcast::fromFile(const std::string &path) {
+	const std::shared_ptr<std::ifstream> &file = std::make_shared<std::ifstream>(path);
+	if (!file->is_open()) throw std::runtime_error("broadcast: cannot open " + path);
+
+	return [file](std::int64_t &chatId) {
+		for (std::string line; std::getline(*file, line);) {
+			char *end;
+			chatId = std::strtoll(line.c_str(), &end, 10);
+			if (end != line.c_str()) return true;
+		}
+
+		return false;
+	};
+}
+
+tgbot::Broadcast::Broadcast(const std::string &token, const std::string &name,
+                            const Options &_options)
+		: options(_options), baseApi("https://api.telegram.org/bot" + token),
+		  sent(metrics::Registry::global().counter(
+				  "tgbot_broadcast_sent_total", metrics::label("broadcast", name),
+				  "Broadcast messages delivered")),
+		  undeliverable(metrics::Registry::global().counter(
+				  "tgbot_broadcast_undeliverable_total", metrics::label("broadcast", name),
+				  "Broadcast chats refused by Telegram (blocked, deactivated...)")),
+		  failed(metrics::Registry::global().counter(
+				  "tgbot_broadcast_failed_total", metrics::label("broadcast", name),
+				  "Broadcast chats given up after network or server errors")),
+		  retries(metrics::Registry::global().counter(
+				  "tgbot_broadcast_retries_total", metrics::label("broadcast", name),
+				  "Broadcast sends retried (flood waits included)")) {}
+
+void tgbot::Broadcast::message(const std::string &text,
+                               const methods::types::ParseMode &parseMode,
+                               bool disableWebPagePreview, bool disableNotification,
+                               const methods::types::ReplyMarkup &replyMarkup) {
+	// encoded once, only chat_id changes between sends
+	std::stringstream params;
+	params << "&text=";
+	utils::encode(params, text);
+
+	if (parseMode == methods::types::ParseMode::HTML)
+		params << "&parse_mode=HTML";
+	else if (parseMode == methods::types::ParseMode::MARKDOWN)
+		params << "&parse_mode=Markdown";
+
+	if (disableWebPagePreview) params << "&disable_web_page_preview=true";
+
+	if (disableNotification) params << "&disable_notification=true";
+
+	const std::string &markup = replyMarkup.toString();
+	if (!markup.empty()) {
+		params << "&reply_markup=";
+		utils::encode(params, markup);
+	}
+
+	messageParams = params.str();
+}
+
+tgbot::Broadcast::Report tgbot::Broadcast::run(ChatSource chats) {
+	stopping = false;
+	source = std::move(chats);
+	report = Report();
+	fatalError.clear();
+	doneAhead.clear();
+	failingInARow = 0;
+	watermark = 0;
+
+	if (!options.checkpointFile.empty()) {
+		std::ifstream checkpoint(options.checkpointFile);
+		if (!(checkpoint >> watermark)) watermark = 0;
+	}
+
+	std::int64_t chatId;
+	for (nextIndex = 0; nextIndex < watermark && source(chatId); ++nextIndex)
+		++report.skipped;
+
+	if (!options.undeliverableFile.empty()) {
+		undeliverableOut.open(options.undeliverableFile, std::ios::app);
+		if (!undeliverableOut.is_open())
+			throw std::runtime_error("broadcast: cannot open " + options.undeliverableFile);
+	}
+
+	nextSlot = pausedUntil = checkpointedAt = Clock::now();
+
+	std::vector<std::thread> senders;
+	for (std::size_t i = 0; i < std::max<std::size_t>(options.connections, 1); ++i)
+		senders.emplace_back(&Broadcast::send, this);
+
+	for (std::thread &sender : senders) sender.join();
+
+	if (undeliverableOut.is_open()) undeliverableOut.close();
+
+	const bool checkpointed = writeCheckpoint();
+
+	if (!fatalError.empty()) throw std::runtime_error("broadcast: " + fatalError);
+
+	if (!checkpointed)
+		throw std::runtime_error("broadcast: cannot write " + options.checkpointFile);
+
+	return report;
+}
+
+void tgbot::Broadcast::stop() {
+	{
+		std::lock_guard<std::mutex> guard(rateMtx);
+		stopping = true;
+	}
+
+	wake.notify_all();
+}
+
+void tgbot::Broadcast::send() {
+	// one connection per sender, kept alive across sends
+	utils::http::CurlHandle connection(utils::http::curlEasyInit());
+	// stays out of the way of interactive answers (see utils::http::setLanes())
+	utils::http::PriorityScope bulk(utils::http::Priority::BULK);
+
+	while (!stopping) {
+		std::int64_t chatId;
+		std::uint64_t index;
+
+		{
+			std::lock_guard<std::mutex> guard(sourceMtx);
+			if (!source(chatId)) break;
+			index = nextIndex++;
+		}
+
+		const Outcome outcome = sendTo(connection.get(), chatId);
+		if (outcome == Outcome::STOPPED) break;  // not done: sent again on resume
+
+		completed(index, outcome);
+	}
+}
+
+tgbot::Broadcast::Outcome tgbot::Broadcast::sendTo(void *c, std::int64_t chatId) {
+	bool migrated = false;
+	std::uint64_t answeredBefore = 0;  // at this chat's first network failure
+
+	for (int attempt = 1;; ++attempt) {
+		if (!acquireSlot()) return Outcome::STOPPED;
+
+		Json::Value value;
+		std::string error;
+
+		try {
+			const std::string &body = utils::http::get(
+					c, baseApi + "/sendMessage?chat_id=" + std::to_string(chatId) +
+					   messageParams);
+
+			std::unique_ptr<Json::CharReader> reader(
+					Json::CharReaderBuilder().newCharReader());
+			if (!reader->parse(body.data(), body.data() + body.size(), &value, &error))
+				value = Json::Value();
+		} catch (const std::exception &e) {
+			error = e.what();
+		}
+
+		if (value.get("ok", false).asBool()) {
+			gotAnswer();
+			return Outcome::SENT;
+		}
+
+		const Json::Value &response = value;
+		const int errorCode = response.get("error_code", 0).asInt();
+		const Json::Value &parameters = response["parameters"];
+		const std::string &description =
+				response.isMember("description") ? response["description"].asString()
+				                                 : error;
+
+		if (errorCode && errorCode < 500) gotAnswer();
+
+		if (errorCode == 429) {
+			// flood wait: applies to the bot, every sender holds off
+			retried();
+			pauseAll(std::chrono::seconds(std::max(1, parameters["retry_after"].asInt())));
+			--attempt;
+			continue;
+		}
+
+		if (!migrated && parameters.isMember("migrate_to_chat_id")) {
+			chatId = parameters["migrate_to_chat_id"].asInt64();
+			migrated = true;
+			--attempt;
+			continue;
+		}
+
+		if (errorCode && errorCode < 500) {
+			if (refusedByChat(errorCode, description)) {
+				recordUndeliverable(chatId, errorCode, description);
+				return Outcome::UNDELIVERABLE;
+			}
+
+			// bad token, bad message...: no chat would get it
+			return stopWith(description);
+		}
+
+		// network or server error
+		if (attempt == 1) answeredBefore = answered;
+
+		if (++failingInARow >= options.connections)
+			// every sender is failing: hold them all off
+			pauseAll(std::chrono::seconds(attempt));
+
+		if (attempt >= options.maxAttempts) {
+			if (answered == answeredBefore)
+				// nothing got through meanwhile: an outage, not this chat
+				return stopWith("sends keep failing (" + description + ")");
+
+			recordUndeliverable(chatId, errorCode, description);
+			return Outcome::FAILED;
+		}
+
+		retried();
+		if (!sleepFor(std::chrono::seconds(attempt))) return Outcome::STOPPED;
+	}
+}
+
+bool tgbot::Broadcast::refusedByChat(int errorCode, const std::string &description) {
+	if (errorCode == 403) return true;  // blocked, kicked, deactivated...
+	if (errorCode != 400) return false;
+
+	// 400 is also what a malformed message gets, for every chat
+	static const char *const chatErrors[] = {
+			"chat not found", "user not found", "user is deactivated",
+			"chat is deactivated", "group chat was deactivated", "peer_id_invalid",
+			"not enough rights", "have no rights", "need administrator rights",
+			"chat_write_forbidden", "topic_closed", "bot was blocked", "bot was kicked"
+	};
+
+	std::string lower(description);
+	std::transform(lower.begin(), lower.end(), lower.begin(),
+	               [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+	for (const char *chatError : chatErrors)
+		if (lower.find(chatError) != std::string::npos) return true;
+
+	return false;
+}
+
+tgbot::Broadcast::Outcome tgbot::Broadcast::stopWith(const std::string &error) {
+	{
+		std::lock_guard<std::mutex> guard(progressMtx);
+		if (fatalError.empty()) fatalError = error;
+	}
+
+	stop();
+	return Outcome::STOPPED;
+}
+
+bool tgbot::Broadcast::acquireSlot() {
+	const auto interval = std::chrono::duration_cast<Clock::duration>(
+			std::chrono::duration<double>(1 / std::max(options.messagesPerSecond, 0.001)));
+
+	std::unique_lock<std::mutex> lock(rateMtx);
+	Clock::time_point slot{};
+
+	while (!stopping) {
+		if (slot < pausedUntil) {
+			// reserved now, in arrival order: a waiting sender can't be overtaken
+			// (a late one may catch up one slot, no more)
+			slot = std::max(std::max(nextSlot, Clock::now() - interval), pausedUntil);
+			nextSlot = slot + interval;
+		}
+
+		if (slot <= Clock::now()) return true;
+
+		wake.wait_until(lock, slot);
+	}
+
+	return false;
+}
+
+void tgbot::Broadcast::pauseAll(std::chrono::seconds pause) {
+	std::lock_guard<std::mutex> guard(rateMtx);
+	pausedUntil = std::max(pausedUntil, Clock::now() + pause);
+}
+
+bool tgbot::Broadcast::sleepFor(std::chrono::milliseconds duration) {
+	std::unique_lock<std::mutex> lock(rateMtx);
+	return !wake.wait_for(lock, duration, [this] { return stopping.load(); });
+}
+
+void tgbot::Broadcast::gotAnswer() {
+	++answered;
+	failingInARow = 0;
+}
+
+void tgbot::Broadcast::retried() {
+	retries.increment();
+
+	std::lock_guard<std::mutex> guard(progressMtx);
+	++report.retries;
+}
+
+void tgbot::Broadcast::completed(std::uint64_t index, Outcome outcome) {
+	switch (outcome) {
+		case Outcome::SENT:
+			sent.increment();
+			break;
+		case Outcome::UNDELIVERABLE:
+			undeliverable.increment();
+			break;
+		case Outcome::FAILED:
+			failed.increment();
+			break;
+		case Outcome::STOPPED:
+			return;
+	}
+
+	std::lock_guard<std::mutex> guard(progressMtx);
+
+	switch (outcome) {
+		case Outcome::SENT:
+			++report.sent;
+			break;
+		case Outcome::UNDELIVERABLE:
+			++report.undeliverable;
+			break;
+		default:
+			++report.failed;
+			break;
+	}
+
+	if (index != watermark) {
+		doneAhead.insert(index);
+		return;
+	}
+
+	++watermark;
+	while (!doneAhead.empty() && *doneAhead.begin() == watermark) {
+		doneAhead.erase(doneAhead.begin());
+		++watermark;
+	}
+
+	const Clock::time_point now = Clock::now();
+	if (now - checkpointedAt >= std::chrono::seconds(1)) {
+		checkpointedAt = now;
+		writeCheckpoint();  // next one may succeed
+	}
+}
+
+bool tgbot::Broadcast::writeCheckpoint() {
+	if (options.checkpointFile.empty()) return true;
+
+	// readers see either the previous checkpoint or this one
+	const std::string &temporary = options.checkpointFile + ".tmp";
+	{
+		std::ofstream out(temporary, std::ios::trunc);
+		out << watermark << '\n';
+		if (!out.flush()) return false;
+	}
+
+	return std::rename(temporary.c_str(), options.checkpointFile.c_str()) == 0;
+}
+
+void tgbot::Broadcast::recordUndeliverable(std::int64_t chatId, int errorCode,
+                                           const std::string &description) {
+	std::lock_guard<std::mutex> guard(progressMtx);
+	if (!undeliverableOut.is_open()) return;
+
+	undeliverableOut << chatId << '\t' << errorCode << '\t' << description << '\n';
+	undeliverableOut.flush();
+}
@@ -0,0 +1,123 @@
+#include <tgbot/utils/callback_data.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+// token: marker, then 64 bits id as 11 base64url characters
+static constexpr char tokenMarker = '~';
+static constexpr std::size_t tokenSize = 12;
+static const char tokenAlphabet[] =
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+static std::string tokenOf(std::int64_t id) {
+	std::uint64_t bits = static_cast<std::uint64_t>(id);
+
+	std::string token(tokenSize, tokenMarker);
+	for (std::size_t i = tokenSize - 1; i > 0; --i, bits >>= 6)
+		token[i] = tokenAlphabet[bits & 63];
+
+	return token;
+}
+
+static bool idOf(const std::string &token, std::int64_t &id) {
+	if (token.size() != tokenSize || token[0] != tokenMarker) return false;
+
+	std::uint64_t bits = 0;
+	for (std::size_t i = 1; i < tokenSize; ++i) {
+		const char c = token[i];
+		std::uint64_t digit;
+
+		if (c >= 'A' && c <= 'Z') digit = static_cast<std::uint64_t>(c - 'A');
+		else if (c >= 'a' && c <= 'z') digit = static_cast<std::uint64_t>(c - 'a' + 26);
+		else if (c >= '0' && c <= '9') digit = static_cast<std::uint64_t>(c - '0' + 52);
+		else if (c == '-') digit = 62;
+		else if (c == '_') digit = 63;
+		else return false;
+
+		bits = (bits << 6) | digit;
+	}
+
+	id = static_cast<std::int64_t>(bits);
+	return true;
+}
+
+// fills buffer from the system CSPRNG
+static void fillRandom(void *buffer, std::size_t size) {
+#if defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || \
+    defined(__NetBSD__)
+	arc4random_buf(buffer, size);
+#else
+	// opened once, kept open for the whole process
+	static int openError = 0;
+	static const int urandom = [] {
+		const int fd = open("/dev/urandom", O_RDONLY | O_CLOEXEC);
+		if (fd < 0) openError = errno;
+		return fd;
+	}();
+
+	if (urandom < 0)
+		throw std::runtime_error(std::string("/dev/urandom: ") +
+		                         std::strerror(openError));
+
+	std::size_t filled = 0;
+	while (filled < size) {
+		const ssize_t got = read(urandom, static_cast<char *>(buffer) + filled,
+		                         size - filled);
+		if (got < 0) {
+			if (errno == EINTR) continue;
+			throw std::runtime_error(std::string("/dev/urandom: ") +
+			                         std::strerror(errno));
+		}
+
+		filled += static_cast<std::size_t>(got);
+	}
+#endif
+}
+
+tgbot::utils::CallbackDataStore::CallbackDataStore(
+		std::chrono::milliseconds ttl, const std::string &file,
+		std::chrono::milliseconds snapshotInterval)
+		: payloads("callback_data", ttl) {
+	if (file.empty()) return;
+
+	payloads.restore(file);
+	payloads.snapshotEvery(file, snapshotInterval);
+}
+
+std::int64_t tgbot::utils::CallbackDataStore::newId() {
+	std::lock_guard<std::mutex> guard(randomMtx);
+
+	// tokens must not be guessable: system CSPRNG, one read per batch of ids
+	if (nextRandom == sizeof(randomIds) / sizeof(randomIds[0])) {
+		fillRandom(randomIds, sizeof(randomIds));
+		nextRandom = 0;
+	}
+
+	return static_cast<std::int64_t>(randomIds[nextRandom++]);
+}
+
+std::string tgbot::utils::CallbackDataStore::put(const std::string &payload) {
+	std::int64_t id = newId();
+	while (!payloads.insert(id, payload)) id = newId();  // taken, unlikely
+
+	return tokenOf(id);
+}
+
+bool tgbot::utils::CallbackDataStore::get(const std::string &token,
+                                          std::string &payload) {
+	std::int64_t id;
+	return idOf(token, id) && payloads.get(id, payload);
+}
+
+void tgbot::utils::CallbackDataStore::erase(const std::string &token) {
+	std::int64_t id;
+	if (idOf(token, id)) payloads.erase(id);
+}
+
+bool tgbot::utils::CallbackDataStore::isToken(const std::string &data) {
+	std::int64_t id;
+	return idOf(data, id);
+}
@@ -0,0 +1,14 @@
+#include <tgbot/utils/cancel.h>
+
+using namespace tgbot::utils;
+
+static thread_local const CancelToken *currentToken = nullptr;
+
+const CancelToken *tgbot::utils::CancelToken::current() { return currentToken; }
+
+tgbot::utils::CancelToken::Scope::Scope(const CancelToken &token)
+		: previous(currentToken) {
+	currentToken = &token;
+}
+
+tgbot::utils::CancelToken::Scope::~Scope() { currentToken = previous; }
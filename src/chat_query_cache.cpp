@@ -0,0 +1,69 @@
+#include <json/json.h>
+#include <tgbot/methods/chat_query_cache.h>
+#include <cstring>
+
+tgbot::methods::ChatQueryCache::ChatQueryCache(std::size_t maxBytes)
+		: ChatQueryCache(maxBytes, Ttls()) {}
+
+tgbot::methods::ChatQueryCache::ChatQueryCache(std::size_t maxBytes, Ttls _ttls)
+		: ttls(_ttls),
+		  responses("chat_queries", maxBytes, _ttls.chat,
+		            [](const std::string &body) { return body.size(); }) {}
+
+std::string tgbot::methods::ChatQueryCache::keyOf(const char *method,
+                                                  const std::string &chatId) {
+	return method + ('\0' + chatId);
+}
+
+std::string tgbot::methods::ChatQueryCache::keyOf(const char *method,
+                                                  const std::string &chatId,
+                                                  int userId) {
+	return keyOf(method, chatId) + '\0' + std::to_string(userId);
+}
+
+void tgbot::methods::ChatQueryCache::invalidateChat(const std::string &chatId) {
+	responses.erase(keyOf("getChat", chatId));
+	responses.erase(keyOf("getChatAdministrators", chatId));
+	responses.erase(keyOf("getChatMembersCount", chatId));
+}
+
+void tgbot::methods::ChatQueryCache::invalidateMember(const std::string &chatId,
+                                                      int userId) {
+	responses.erase(keyOf("getChatMember", chatId, userId));
+}
+
+void tgbot::methods::ChatQueryCache::observe(const Json::Value &update) {
+	for (const char *kind : {"message", "channel_post"}) {
+		const Json::Value *message = update.find(kind, kind + std::strlen(kind));
+		if (!message || !message->isObject()) continue;
+
+		const Json::Value &id = (*message)["chat"]["id"];
+		if (!id.isIntegral()) return;
+
+		const std::string &chatId = std::to_string(id.asInt64());
+
+		if (message->isMember("migrate_to_chat_id")) {
+			invalidateChat(chatId);
+			return;
+		}
+
+		const Json::Value &joined = (*message)["new_chat_members"];
+		const Json::Value &left = (*message)["left_chat_member"];
+		if (joined.isArray() || left.isObject()) {
+			// a leaving admin changes the administrators too
+			responses.erase(keyOf("getChatMembersCount", chatId));
+			responses.erase(keyOf("getChatAdministrators", chatId));
+
+			for (const Json::Value &user : joined)
+				invalidateMember(chatId, user["id"].asInt());
+
+			if (left.isObject()) invalidateMember(chatId, left["id"].asInt());
+		}
+
+		if (message->isMember("new_chat_title") || message->isMember("new_chat_photo") ||
+		    message->isMember("delete_chat_photo") || message->isMember("pinned_message"))
+			responses.erase(keyOf("getChat", chatId));
+
+		return;
+	}
+}
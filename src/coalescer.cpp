@@ -0,0 +1,59 @@
+#include <tgbot/metrics.h>
+#include <tgbot/utils/coalescer.h>
+
+tgbot::utils::Coalescer::Coalescer(const std::string &work)
+		: superseded(metrics::Registry::global().counter(
+				"tgbot_coalesced_superseded_total", metrics::label("work", work),
+				"Work skipped because newer work for the same key arrived")),
+		  cancelled(metrics::Registry::global().counter(
+				  "tgbot_coalesced_cancelled_total", metrics::label("work", work),
+				  "Running work cancelled because newer work for the same key arrived")) {}
+
+std::uint64_t tgbot::utils::Coalescer::submit(std::int64_t key) {
+	std::lock_guard<std::mutex> guard(mtx);
+
+	const std::uint64_t generation = ++nextGeneration;
+
+	auto found = latest.find(key);
+	if (found == latest.end()) {
+		latest.emplace(key, Latest{generation, 0, CancelToken()});
+		return generation;
+	}
+
+	Latest &entry = found->second;
+	if (entry.runningGeneration && !entry.running.cancelled()) {
+		entry.running.cancel();
+		cancelled.increment();
+	}
+
+	entry.generation = generation;
+	return generation;
+}
+
+bool tgbot::utils::Coalescer::start(std::int64_t key, std::uint64_t generation,
+                                    const CancelToken &token) {
+	std::lock_guard<std::mutex> guard(mtx);
+
+	auto found = latest.find(key);
+	if (found == latest.end() || found->second.generation != generation) {
+		superseded.increment();
+		return false;
+	}
+
+	found->second.runningGeneration = generation;
+	found->second.running = token;
+	return true;
+}
+
+void tgbot::utils::Coalescer::finish(std::int64_t key, std::uint64_t generation) {
+	std::lock_guard<std::mutex> guard(mtx);
+
+	auto found = latest.find(key);
+	if (found == latest.end()) return;
+
+	Latest &entry = found->second;
+	if (entry.generation == generation)
+		latest.erase(found);  // nothing newer: forget key
+	else if (entry.runningGeneration == generation)
+		entry.runningGeneration = 0;
+}
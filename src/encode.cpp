@@ -34,3 +34,16 @@ void tgbot::utils::encode(std::stringstream &stream,
 		}
 	}
 }
+
+void tgbot::utils::encodeJson(std::ostream &stream, const std::string &target) {
+	stream << '"';
+	for (const char &c : target) {
+		if (c == '"' || c == '\\')
+			stream << '\\' << c;
+		else if (static_cast<unsigned char>(c) < 0x20)
+			stream << ' ';
+		else
+			stream << c;
+	}
+	stream << '"';
+}
@@ -0,0 +1,253 @@
+#include <json/json.h>
+#include <tgbot/update_filter.h>
+#include <tgbot/utils/entity_cache.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+static const char *senderKinds[] = {"inline_query", "chosen_inline_result",
+                                    "callback_query", "shipping_query",
+                                    "pre_checkout_query"};
+
+static const Json::Value *member(const Json::Value &object, const char *key) {
+	const Json::Value *found = object.find(key, key + std::strlen(key));
+	return found && !found->isNull() ? found : nullptr;
+}
+
+static bool named(const char *name, const char *end, const char *key) {
+	const std::size_t length = std::strlen(key);
+	return static_cast<std::size_t>(end - name) == length &&
+	       !std::memcmp(name, key, length);
+}
+
+// FNV-1a over names and scalar values of the members of object, in one
+// pass: changes when a field (name, username...) does, so the entity can
+// be kept without comparing it field by field
+static std::uint64_t fingerprintOf(const Json::Value &object) {
+	std::uint64_t hash = 14695981039346656037ull;
+	const auto mix = [&hash](const char *begin, const char *end) {
+		for (; begin != end; ++begin) {
+			hash ^= static_cast<unsigned char>(*begin);
+			hash *= 1099511628211ull;
+		}
+
+		hash ^= 0xff;  // separator: "ab","c" isn't "a","bc"
+		hash *= 1099511628211ull;
+	};
+
+	for (auto field = object.begin(); field != object.end(); ++field) {
+		const char *nameEnd;
+		const char *name = field.memberName(&nameEnd);
+		mix(name, nameEnd);
+
+		const char *begin;
+		const char *end;
+		if (field->isString() && field->getString(&begin, &end)) {
+			mix(begin, end);
+		} else if (field->isBool()) {
+			const char flag = field->asBool() ? '1' : '0';
+			mix(&flag, &flag + 1);
+		}
+	}
+
+	return hash;
+}
+
+tgbot::utils::EntityCache::EntityCache(std::size_t _maxEntities)
+		: maxEntities(_maxEntities ? _maxEntities : 1),
+		  userGauge(metrics::Registry::global().gauge(
+				  "tgbot_entities", metrics::label("kind", "user"), "Entities held")),
+		  chatGauge(metrics::Registry::global().gauge(
+				  "tgbot_entities", metrics::label("kind", "chat"), "Entities held")),
+		  usersRefreshed(metrics::Registry::global().counter(
+				  "tgbot_entities_refreshed_total", metrics::label("kind", "user"),
+				  "Entities rebuilt because a field changed")),
+		  chatsRefreshed(metrics::Registry::global().counter(
+				  "tgbot_entities_refreshed_total", metrics::label("kind", "chat"),
+				  "Entities rebuilt because a field changed")) {}
+
+tgbot::utils::EntityCache::~EntityCache() {
+	userGauge.sub(static_cast<std::int64_t>(userTable.size()));
+	chatGauge.sub(static_cast<std::int64_t>(chatTable.size()));
+}
+
+std::shared_ptr<const tgbot::types::User> tgbot::utils::EntityCache::user(int id) const {
+	std::lock_guard<std::mutex> guard(mtx);
+
+	auto found = userTable.find(id);
+	return found != userTable.end() ? found->second.entity : nullptr;
+}
+
+std::shared_ptr<const tgbot::types::Chat> tgbot::utils::EntityCache::chat(
+		std::int64_t id) const {
+	std::lock_guard<std::mutex> guard(mtx);
+
+	auto found = chatTable.find(id);
+	return found != chatTable.end() ? found->second.entity : nullptr;
+}
+
+std::size_t tgbot::utils::EntityCache::users() const {
+	std::lock_guard<std::mutex> guard(mtx);
+	return userTable.size();
+}
+
+std::size_t tgbot::utils::EntityCache::chats() const {
+	std::lock_guard<std::mutex> guard(mtx);
+	return chatTable.size();
+}
+
+using Seen = tgbot::utils::EntityCache::Seen;
+
+static void collect(const Json::Value &object, bool chat, std::vector<Seen> &seen) {
+	if (!object.isObject()) return;
+
+	const Json::Value *id = member(object, "id");
+	if (!id || !id->isIntegral()) return;
+
+	seen.push_back(Seen{&object, id->asInt64(), fingerprintOf(object), chat});
+}
+
+static void collectMessage(const Json::Value &message, std::vector<Seen> &seen) {
+	if (!message.isObject()) return;
+
+	// one pass over the message rather than a lookup per field
+	for (auto field = message.begin(); field != message.end(); ++field) {
+		const char *end;
+		const char *name = field.memberName(&end);
+
+		if (named(name, end, "from") || named(name, end, "forward_from") ||
+		    named(name, end, "left_chat_member"))
+			collect(*field, false, seen);
+		else if (named(name, end, "chat") || named(name, end, "forward_from_chat"))
+			collect(*field, true, seen);
+		else if (named(name, end, "new_chat_members") && field->isArray())
+			for (const Json::Value &object : *field) collect(object, false, seen);
+	}
+}
+
+// users and chats as parsed (no Ptr member)
+static std::shared_ptr<const tgbot::types::User> build(const Json::Value &object,
+                                                       const tgbot::types::User *) {
+	return std::make_shared<const tgbot::types::User>(object);
+}
+
+// a group becoming a supergroup gets a new id: chat type can't change
+static std::shared_ptr<const tgbot::types::Chat> build(const Json::Value &object,
+                                                       const tgbot::types::Chat *) {
+	if (!member(object, "photo") && !member(object, "pinned_message"))
+		return std::make_shared<const tgbot::types::Chat>(object);
+
+	// getChat only: not kept, chats are those of updates
+	Json::Value basic(object);
+	basic.removeMember("photo");
+	basic.removeMember("pinned_message");
+	return std::make_shared<const tgbot::types::Chat>(basic);
+}
+
+void tgbot::utils::EntityCache::observe(const Json::Value &update) {
+	// reused from one update to the next: no allocation per update
+	static thread_local std::vector<Seen> seen;
+	seen.clear();
+
+	if (const Json::Value *message = filters::messageOf(update))
+		collectMessage(*message, seen);
+	else
+		for (const char *kind : senderKinds) {
+			const Json::Value *query = member(update, kind);
+			if (!query) continue;
+
+			if (const Json::Value *from = member(*query, "from")) collect(*from, false, seen);
+			if (const Json::Value *inner = member(*query, "message"))
+				collectMessage(*inner, seen);
+			break;
+		}
+
+	if (seen.empty()) return;
+
+	// most updates change nothing: one lock, nothing built
+	std::size_t nChanged = 0;
+	{
+		std::lock_guard<std::mutex> guard(mtx);
+		++tick;
+
+		for (const Seen &entity : seen)
+			if (entity.chat ? touch(chatTable, entity) : touch(userTable, entity))
+				seen[nChanged++] = entity;
+	}
+
+	if (!nChanged) return;
+
+	// built without the lock, then stored
+	std::vector<std::shared_ptr<const types::User>> users(nChanged);
+	std::vector<std::shared_ptr<const types::Chat>> chats(nChanged);
+	for (std::size_t i = 0; i < nChanged; ++i) {
+		if (seen[i].chat)
+			chats[i] = build(*seen[i].object, static_cast<const types::Chat *>(nullptr));
+		else
+			users[i] = build(*seen[i].object, static_cast<const types::User *>(nullptr));
+	}
+
+	std::lock_guard<std::mutex> guard(mtx);
+	for (std::size_t i = 0; i < nChanged; ++i) {
+		if (seen[i].chat)
+			store(chatTable, seen[i], std::move(chats[i]), chatGauge, chatsRefreshed);
+		else
+			store(userTable, seen[i], std::move(users[i]), userGauge, usersRefreshed);
+	}
+}
+
+template<typename Entity>
+bool tgbot::utils::EntityCache::touch(Table<Entity> &table, const Seen &seen) {
+	auto found = table.find(seen.id);
+	if (found == table.end()) return true;
+
+	found->second.lastSeen = tick;
+	return found->second.fingerprint != seen.fingerprint;
+}
+
+template<typename Entity>
+void tgbot::utils::EntityCache::store(Table<Entity> &table, const Seen &seen,
+                                      std::shared_ptr<const Entity> entity,
+                                      metrics::Gauge &gauge,
+                                      metrics::Counter &refreshed) {
+	Slot<Entity> &slot = table[seen.id];
+	slot.lastSeen = tick;
+
+	if (slot.entity) {
+		// another bot sharing this cache may have been quicker
+		if (slot.fingerprint == seen.fingerprint) return;
+		refreshed.increment();
+	} else
+		gauge.add();
+
+	slot.fingerprint = seen.fingerprint;
+	slot.entity = std::move(entity);
+
+	if (table.size() > maxEntities) evictOldest(table, gauge);
+}
+
+template<typename Entity>
+void tgbot::utils::EntityCache::evictOldest(Table<Entity> &table,
+                                            metrics::Gauge &gauge) {
+	std::vector<std::uint64_t> seen;
+	seen.reserve(table.size());
+	for (const auto &entry : table) seen.push_back(entry.second.lastSeen);
+
+	// evicting half at once keeps this off the per-update path; those seen
+	// by the latest update (the one just inserted among them) are kept
+	const std::size_t keep = std::max<std::size_t>(maxEntities / 2, 1);
+	auto oldestKept = seen.begin() + static_cast<std::ptrdiff_t>(seen.size() - keep);
+	std::nth_element(seen.begin(), oldestKept, seen.end());
+	const std::uint64_t threshold = std::min(*oldestKept, tick);
+
+	std::size_t dropped = 0;
+	for (auto entry = table.begin(); entry != table.end();) {
+		if (entry->second.lastSeen < threshold) {
+			entry = table.erase(entry);
+			++dropped;
+		} else
+			++entry;
+	}
+
+	gauge.sub(static_cast<std::int64_t>(dropped));
+}
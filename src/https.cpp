@@ -1,7 +1,20 @@
 #include <errno.h>
+#include <tgbot/metrics.h>
+#include <tgbot/trace.h>
+#include <tgbot/utils/cancel.h>
 #include <tgbot/utils/https.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
 #define unused __attribute__((__unused__))
 
@@ -10,12 +23,496 @@
 
 using namespace tgbot::utils::http;
 
-static size_t write_data(const char *ptr, unused size_t nbs, size_t count,
+static size_t write_data(const char *ptr, size_t nbs, size_t count,
                          void *dest) {
-	static_cast<std::string *>(dest)->append(ptr);
-	return count;
+	static_cast<std::string *>(dest)->append(ptr, nbs * count);
+	return nbs * count;
 }
 
+namespace {
+
+	struct MethodMetrics {
+		tgbot::metrics::Counter &requests;
+		tgbot::metrics::Histogram &latency;
+		tgbot::metrics::Counter &sentBytes;
+		tgbot::metrics::Counter &receivedBytes;
+	};
+
+	// statuses Telegram answers errors with, most of them
+	constexpr long httpErrors[] = {400, 401, 403, 404, 409, 413, 429, 500, 502, 503, 504};
+	constexpr std::size_t nHttpErrors = sizeof(httpErrors) / sizeof(*httpErrors);
+
+	// error counters of a method: httpErrors, then curl codes
+	struct ErrorCounters {
+		std::atomic<tgbot::metrics::Counter *> byCode[nHttpErrors + CURL_LAST];
+	};
+
+	// handles of a known method, resolved once then read without locking
+	struct KnownMethod {
+		std::atomic<MethodMetrics *> metrics;
+		std::atomic<ErrorCounters *> errors;
+	};
+
+}  // namespace
+
+// Bot API methods called by the library, sorted
+static const char *const knownMethods[] = {
+		"addStickerToSet", "answerCallbackQuery", "answerInlineQuery",
+		"answerPreCheckoutQuery", "answerShippingQuery", "createNewStickerSet",
+		"deleteChatPhoto", "deleteChatStickerSet", "deleteMessage",
+		"deleteStickerFromSet", "deleteWebhook", "editMessageCaption",
+		"editMessageLiveLocation", "editMessageMedia", "editMessageReplyMarkup",
+		"editMessageText", "exportChatInviteLink", "forwardMessage", "getChat",
+		"getChatAdministrators", "getChatMember", "getChatMembersCount", "getFile",
+		"getGameHighScores", "getMe", "getStickerSet", "getUpdates",
+		"getUserProfilePhotos", "getWebhookInfo", "kickChatMember", "leaveChat",
+		"pinChatMessage", "promoteChatMember", "restrictChatMember", "sendAudio",
+		"sendChatAction", "sendContact", "sendDocument", "sendGame", "sendInvoice",
+		"sendLocation", "sendMediaGroup", "sendMessage", "sendPhoto", "sendPoll",
+		"sendSticker", "sendVenue", "sendVideo", "sendVideoNote", "sendVoice",
+		"setChatDescription", "setChatPhoto", "setChatStickerSet", "setChatTitle",
+		"setGameScore", "setStickerPositionInSet", "setWebhook",
+		"stopMessageLiveLocation", "stopPoll", "unbanChatMember",
+		"unpinChatMessage", "uploadStickerFile"
+};
+
+static KnownMethod knownSlots[sizeof(knownMethods) / sizeof(*knownMethods)];
+
+// API method name is the last path component: .../bot<token>/<method>?...
+static std::string methodOf(const std::string &url) {
+	const std::size_t query = url.find('?');
+	const std::size_t slash = url.rfind('/', query);
+
+	if (slash == std::string::npos) return "unknown";
+
+	return url.substr(slash + 1, query == std::string::npos ? std::string::npos
+	                                                        : query - slash - 1);
+}
+
+// nullptr for methods not in knownMethods
+static KnownMethod *knownOf(const std::string &method) {
+	const char *const *end = std::end(knownMethods);
+	const char *const *found = std::lower_bound(
+			std::begin(knownMethods), end, method.c_str(),
+			[](const char *a, const char *b) { return std::strcmp(a, b) < 0; });
+
+	if (found == end || method != *found) return nullptr;
+	return &knownSlots[found - std::begin(knownMethods)];
+}
+
+static MethodMetrics &registeredMetricsOf(const std::string &method) {
+	static std::mutex mtx;
+	static std::unordered_map<std::string, MethodMetrics> byMethod;
+
+	std::lock_guard<std::mutex> guard(mtx);
+
+	auto found = byMethod.find(method);
+	if (found != byMethod.end()) return found->second;
+
+	tgbot::metrics::Registry &registry = tgbot::metrics::Registry::global();
+	const std::string &methodLabel = tgbot::metrics::label("method", method);
+
+	MethodMetrics methodMetrics{
+			registry.counter("tgbot_api_requests_total", methodLabel,
+			                 "Bot API requests performed"),
+			registry.histogram("tgbot_api_request_duration_seconds", methodLabel,
+			                   "Bot API request latency"),
+			registry.counter("tgbot_api_sent_bytes_total", methodLabel,
+			                 "Bytes sent to Bot API"),
+			registry.counter("tgbot_api_received_bytes_total", methodLabel,
+			                 "Bytes received from Bot API")};
+
+	// elements of an unordered_map stay put: known methods keep a pointer
+	return byMethod.emplace(method, methodMetrics).first->second;
+}
+
+static MethodMetrics &metricsOf(const std::string &method, KnownMethod *known) {
+	if (!known) return registeredMetricsOf(method);
+
+	MethodMetrics *metrics = known->metrics.load(std::memory_order_acquire);
+	if (!metrics) {
+		// racing threads resolve the same entry
+		metrics = &registeredMetricsOf(method);
+		known->metrics.store(metrics, std::memory_order_release);
+	}
+
+	return *metrics;
+}
+
+static tgbot::metrics::Counter &registeredErrorsOf(const std::string &method,
+                                                   CURLcode code, long status) {
+	const std::string &errorCode =
+			code != CURLE_OK && code != CURLE_GOT_NOTHING
+			? "curl_" + std::to_string(static_cast<int>(code))
+			: std::to_string(status);
+
+	return tgbot::metrics::Registry::global().counter(
+			"tgbot_api_errors_total",
+			tgbot::metrics::label("method", method) + "," +
+			tgbot::metrics::label("code", errorCode),
+			"Bot API requests failed, by error code");
+}
+
+static tgbot::metrics::Counter &errorsOf(const std::string &method, KnownMethod *known,
+                                         CURLcode code, long status) {
+	std::size_t slot;
+	if (code != CURLE_OK && code != CURLE_GOT_NOTHING)
+		slot = nHttpErrors + static_cast<std::size_t>(code);
+	else
+		slot = static_cast<std::size_t>(
+				std::find(httpErrors, httpErrors + nHttpErrors, status) - httpErrors);
+
+	if (!known || slot == nHttpErrors || slot >= nHttpErrors + CURL_LAST)
+		return registeredErrorsOf(method, code, status);
+
+	ErrorCounters *errors = known->errors.load(std::memory_order_acquire);
+	if (!errors) {
+		// first error of this method
+		ErrorCounters *made = new ErrorCounters();
+		if (known->errors.compare_exchange_strong(errors, made, std::memory_order_acq_rel))
+			errors = made;
+		else
+			delete made;
+	}
+
+	tgbot::metrics::Counter *counter = errors->byCode[slot].load(std::memory_order_acquire);
+	if (!counter) {
+		counter = &registeredErrorsOf(method, code, status);
+		errors->byCode[slot].store(counter, std::memory_order_release);
+	}
+
+	return *counter;
+}
+
+static void recordRequest(CURL *c, const std::string &full,
+                          const std::string &method, CURLcode code,
+                          std::size_t received,
+                          std::chrono::steady_clock::time_point start) {
+	KnownMethod *known = knownOf(method);
+	MethodMetrics &methodMetrics = metricsOf(method, known);
+
+	curl_off_t uploaded = 0;
+	curl_easy_getinfo(c, CURLINFO_SIZE_UPLOAD_T, &uploaded);
+
+	methodMetrics.requests.increment();
+	methodMetrics.latency.record(tgbot::metrics::microsSince(start));
+	methodMetrics.sentBytes.increment(full.size() + static_cast<std::size_t>(uploaded));
+	methodMetrics.receivedBytes.increment(received);
+
+	// Bot API reports its error_code as HTTP status as well
+	long status = 0;
+	curl_easy_getinfo(c, CURLINFO_RESPONSE_CODE, &status);
+
+	if ((code == CURLE_OK || code == CURLE_GOT_NOTHING) && status < 400) return;
+
+	errorsOf(method, known, code, status).increment();
+}
+
+static int abortIfCancelled(void *token, curl_off_t unused dltotal,
+                            curl_off_t unused dlnow, curl_off_t unused ultotal,
+                            curl_off_t unused ulnow) {
+	return static_cast<const tgbot::utils::CancelToken *>(token)->cancelled();
+}
+
+// abort the transfer if the token current on this thread gets cancelled
+static void watchCancellation(CURL *c) {
+	const tgbot::utils::CancelToken *token = tgbot::utils::CancelToken::current();
+
+	if (!token) {
+		curl_easy_setopt(c, CURLOPT_NOPROGRESS, 1L);
+		return;
+	}
+
+	if (token->cancelled()) throw TransferCancelled();
+
+	curl_easy_setopt(c, CURLOPT_XFERINFOFUNCTION, abortIfCancelled);
+	curl_easy_setopt(c, CURLOPT_XFERINFODATA, token);
+	curl_easy_setopt(c, CURLOPT_NOPROGRESS, 0L);
+}
+
+static std::mutex timeoutsMutex;
+static Timeouts timeoutsByOperation[] = {
+		{10000, 15000, 0, 0},    // POLL: margin over the long poll timeout
+		{10000, 30000, 0, 0},    // REQUEST
+		{10000, 0, 1024, 30}     // UPLOAD: no deadline, just keep moving
+};
+
+void tgbot::utils::http::setTimeouts(Operation operation,
+                                     const Timeouts &timeouts) {
+	std::lock_guard<std::mutex> guard(timeoutsMutex);
+	timeoutsByOperation[static_cast<int>(operation)] = timeouts;
+}
+
+Timeouts tgbot::utils::http::getTimeouts(Operation operation) {
+	std::lock_guard<std::mutex> guard(timeoutsMutex);
+	return timeoutsByOperation[static_cast<int>(operation)];
+}
+
+static void applyTimeouts(CURL *c, const Timeouts &timeouts) {
+	curl_easy_setopt(c, CURLOPT_CONNECTTIMEOUT_MS, timeouts.connect);
+	curl_easy_setopt(c, CURLOPT_TIMEOUT_MS, timeouts.total);
+	curl_easy_setopt(c, CURLOPT_LOW_SPEED_LIMIT, timeouts.lowSpeedLimit);
+	curl_easy_setopt(c, CURLOPT_LOW_SPEED_TIME,
+	                 timeouts.lowSpeedLimit ? timeouts.lowSpeedTime : 0L);
+}
+
+// map curl failures to exceptions
+static void throwOnFailure(CURLcode code) {
+	switch (code) {
+		case CURLE_OK:
+			return;
+		case CURLE_ABORTED_BY_CALLBACK:
+			throw TransferCancelled();
+		case CURLE_OPERATION_TIMEDOUT:
+			throw TransferTimeout(curl_easy_strerror(code));
+		default:
+			throw std::runtime_error(curl_easy_strerror(code));
+	}
+}
+
+static std::mutex prioritiesMutex;
+static std::unordered_map<std::string, Priority> priorityByMethod = {
+		{"answerCallbackQuery",    Priority::INTERACTIVE},
+		{"answerInlineQuery",      Priority::INTERACTIVE},
+		{"answerPreCheckoutQuery", Priority::INTERACTIVE},
+		{"answerShippingQuery",    Priority::INTERACTIVE},
+		{"sendPhoto",              Priority::BULK},
+		{"sendAudio",              Priority::BULK},
+		{"sendDocument",           Priority::BULK},
+		{"sendSticker",            Priority::BULK},
+		{"sendVideo",              Priority::BULK},
+		{"sendVoice",              Priority::BULK},
+		{"sendVideoNote",          Priority::BULK},
+		{"sendMediaGroup",         Priority::BULK}
+};
+
+static thread_local const Priority *scopedPriority = nullptr;
+
+void tgbot::utils::http::setPriority(const std::string &method, Priority priority) {
+	std::lock_guard<std::mutex> guard(prioritiesMutex);
+	priorityByMethod[method] = priority;
+}
+
+// fallback: lane of methods not listed
+static Priority laneOf(const std::string &method, Priority fallback) {
+	if (scopedPriority) return *scopedPriority;
+
+	std::lock_guard<std::mutex> guard(prioritiesMutex);
+	auto found = priorityByMethod.find(method);
+	return found != priorityByMethod.end() ? found->second : fallback;
+}
+
+Priority tgbot::utils::http::priorityOf(const std::string &method) {
+	return laneOf(method, Priority::NORMAL);
+}
+
+tgbot::utils::http::PriorityScope::PriorityScope(Priority _priority)
+		: previous(scopedPriority), priority(_priority) {
+	scopedPriority = &priority;
+}
+
+tgbot::utils::http::PriorityScope::~PriorityScope() { scopedPriority = previous; }
+
+namespace {
+
+	// Requests wait for their turn in their lane's queue, served in order
+	// of arrival: a lane is served only once those above it are empty
+	class LaneGate {
+	public:
+		static constexpr int nLanes = 3;
+
+		LaneGate() {
+			static const char *names[nLanes] = {"interactive", "normal", "bulk"};
+
+			for (int lane = 0; lane < nLanes; ++lane) {
+				const std::string &laneLabel = tgbot::metrics::label("lane", names[lane]);
+
+				queueDuration[lane] = &tgbot::metrics::Registry::global().histogram(
+						"tgbot_api_queue_duration_seconds", laneLabel,
+						"Time Bot API requests waited in their lane");
+				inFlightGauge[lane] = &tgbot::metrics::Registry::global().gauge(
+						"tgbot_api_in_flight", laneLabel, "Bot API requests in flight");
+			}
+		}
+
+		void configure(const Lanes &_lanes) {
+			{
+				std::lock_guard<std::mutex> guard(mtx);
+				lanes = _lanes;
+				on.store(lanes.maxInFlight != 0, std::memory_order_relaxed);
+			}
+
+			for (std::condition_variable &lane : freed) lane.notify_all();
+		}
+
+		Lanes get() {
+			std::lock_guard<std::mutex> guard(mtx);
+			return lanes;
+		}
+
+		/*!
+		 * @brief without locking; acquire() looks again
+		 */
+		bool enabled() const { return on.load(std::memory_order_relaxed); }
+
+		/*!
+		 * @return false if lanes are disabled: nothing to release
+		 */
+		bool acquire(Priority priority) {
+			const int lane = static_cast<int>(priority);
+			const auto start = std::chrono::steady_clock::now();
+			const tgbot::utils::CancelToken *token = tgbot::utils::CancelToken::current();
+
+			std::unique_lock<std::mutex> lock(mtx);
+			if (!lanes.maxInFlight) return false;
+
+			const std::uint64_t ticket = nextTicket[lane]++;
+			++waiting[lane];
+
+			while (lanes.maxInFlight && !admissible(lane, ticket)) {
+				if (token && token->cancelled()) {
+					leave(lane, ticket);
+					throw TransferCancelled();
+				}
+
+				// cancellation has no way to wake us up: look at it now and then
+				freed[lane].wait_for(lock, std::chrono::milliseconds(token ? 50 : 1000));
+			}
+
+			if (!lanes.maxInFlight) {
+				// disabled meanwhile
+				leave(lane, ticket);
+				return false;
+			}
+
+			--waiting[lane];
+
+			++nowServing[lane];
+			advance(lane);
+			++inFlight[lane];
+			lock.unlock();
+
+			inFlightGauge[lane]->add();
+			queueDuration[lane]->record(tgbot::metrics::microsSince(start));
+			return true;
+		}
+
+		void release(Priority priority) {
+			const int lane = static_cast<int>(priority);
+			inFlightGauge[lane]->sub();
+
+			{
+				std::lock_guard<std::mutex> guard(mtx);
+				--inFlight[lane];
+			}
+
+			// admission of each lane depends on the others
+			for (std::condition_variable &other : freed) other.notify_all();
+		}
+
+	private:
+		bool admissible(int lane, std::uint64_t ticket) const {
+			if (ticket != nowServing[lane]) return false;
+
+			const std::size_t total = inFlight[0] + inFlight[1] + inFlight[2];
+			if (total >= lanes.maxInFlight) return false;
+
+			if (lane == static_cast<int>(Priority::INTERACTIVE)) return true;
+
+			const std::size_t shared = lanes.maxInFlight > lanes.reservedInteractive
+			                           ? lanes.maxInFlight - lanes.reservedInteractive : 0;
+			if (total >= shared) return false;
+
+			for (int above = 0; above < lane; ++above)
+				if (waiting[above]) return false;
+
+			return lane != static_cast<int>(Priority::BULK) || !lanes.maxBulk ||
+			       inFlight[lane] < lanes.maxBulk;
+		}
+
+		// give up ticket, in whatever position of the queue
+		void leave(int lane, std::uint64_t ticket) {
+			--waiting[lane];
+			skipped[lane].push_back(ticket);
+			advance(lane);
+		}
+
+		// skip tickets given up while waiting, then let the next one in;
+		// called whenever waiting[] changes
+		void advance(int lane) {
+			std::vector<std::uint64_t> &gone = skipped[lane];
+
+			for (bool moved = true; moved;) {
+				moved = false;
+
+				for (auto ticket = gone.begin(); ticket != gone.end(); ++ticket) {
+					if (*ticket == nowServing[lane]) {
+						gone.erase(ticket);
+						++nowServing[lane];
+						moved = true;
+						break;
+					}
+				}
+			}
+
+			// waiting[] changed too: lower lanes may now be admissible
+			for (std::condition_variable &other : freed) other.notify_all();
+		}
+
+		std::mutex mtx;
+		Lanes lanes{0, 0, 0};
+		std::atomic<bool> on{false};
+		std::condition_variable freed[nLanes];
+		std::uint64_t nextTicket[nLanes]{};
+		std::uint64_t nowServing[nLanes]{};
+		std::vector<std::uint64_t> skipped[nLanes];
+		std::size_t waiting[nLanes]{};
+		std::size_t inFlight[nLanes]{};
+
+		tgbot::metrics::Histogram *queueDuration[nLanes];
+		tgbot::metrics::Gauge *inFlightGauge[nLanes];
+	};
+
+	LaneGate &laneGate() {
+		static LaneGate gate;
+		return gate;
+	}
+
+	// holds a place in the lane of method for its lifetime
+	class LaneSlot {
+	public:
+		explicit LaneSlot(const std::string &method, Priority fallback = Priority::NORMAL) {
+			// lanes are off by default: no priority lookup then
+			if (method == "getUpdates" || !laneGate().enabled()) return;
+
+			priority = laneOf(method, fallback);
+			held = laneGate().acquire(priority);
+		}
+
+		~LaneSlot() {
+			if (held) laneGate().release(priority);
+		}
+
+		LaneSlot(const LaneSlot &) = delete;
+
+		LaneSlot &operator=(const LaneSlot &) = delete;
+
+	private:
+		Priority priority{Priority::NORMAL};
+		bool held{false};
+	};
+
+}  // namespace
+
+void tgbot::utils::http::setLanes(const Lanes &lanes) {
+	if (lanes.maxInFlight && lanes.reservedInteractive >= lanes.maxInFlight)
+		throw std::invalid_argument("lanes: nothing left for non interactive requests");
+
+	laneGate().configure(lanes);
+}
+
+Lanes tgbot::utils::http::getLanes() { return laneGate().get(); }
+
 void tgbot::utils::http::__internal_Curl_GlobalInit() {
 	if(curl_global_sslset(CURLSSLBACKEND_GNUTLS, NULL, NULL) != CURLSSLSET_OK)
 		throw std::runtime_error("curl_global_sslset() error: libcurl does not support GnuTLS");
@@ -29,23 +526,67 @@ CURL *tgbot::utils::http::curlEasyInit() {
 
 	curl_easy_setopt(curlInst, CURLOPT_FOLLOWLOCATION, 1L);
 	curl_easy_setopt(curlInst, CURLOPT_WRITEFUNCTION, write_data);
+	// timeouts from many threads: no SIGALRM during name resolution
+	curl_easy_setopt(curlInst, CURLOPT_NOSIGNAL, 1L);
 
 	return curlInst;
 }
 
 std::string tgbot::utils::http::get(CURL *c, const std::string &full) {
-	if (!c) throw std::runtime_error("CURL is actually a null pointer :/");
+	return get(c, full, getTimeouts(Operation::REQUEST));
+}
+
+static std::shared_ptr<TransferExecutor> transferExecutor;
+
+void tgbot::utils::http::setTransferExecutor(
+		std::shared_ptr<TransferExecutor> executor) {
+	std::atomic_store(&transferExecutor, executor);
+}
+
+static CURLcode perform(CURL *c) {
+	const std::shared_ptr<TransferExecutor> &executor =
+			std::atomic_load(&transferExecutor);
+
+	return executor ? executor->perform(c) : curl_easy_perform(c);
+}
+
+void tgbot::utils::http::beginGet(CURL *c, PendingGet &pending,
+                                  const Timeouts &timeouts) {
+	pending.method = methodOf(pending.url);
+	pending.body.clear();
 
-	std::string body;
 	curl_easy_setopt(c, CURLOPT_HTTPGET, 1L);
-	curl_easy_setopt(c, CURLOPT_WRITEDATA, &body);
-	curl_easy_setopt(c, CURLOPT_URL, full.c_str());
+	curl_easy_setopt(c, CURLOPT_WRITEDATA, &pending.body);
+	curl_easy_setopt(c, CURLOPT_URL, pending.url.c_str());
+	applyTimeouts(c, timeouts);
+	watchCancellation(c);
 
-	CURLcode code = curl_easy_perform(c);
-	if (code != CURLE_OK && code != CURLE_GOT_NOTHING)
-		throw std::runtime_error(curl_easy_strerror(code));
+	pending.start = std::chrono::steady_clock::now();
+}
 
-	return body;
+std::string tgbot::utils::http::endGet(CURL *c, PendingGet &pending,
+                                       CURLcode code) {
+	recordRequest(c, pending.url, pending.method, code, pending.body.size(),
+	              pending.start);
+
+	if (code != CURLE_GOT_NOTHING) throwOnFailure(code);
+
+	return std::move(pending.body);
+}
+
+std::string tgbot::utils::http::get(CURL *c, const std::string &full,
+                                    const Timeouts &timeouts) {
+	if (!c) throw std::runtime_error("CURL is actually a null pointer :/");
+
+	PendingGet pending;
+	pending.url = full;
+
+	// queueing isn't part of the request latency
+	LaneSlot lane(methodOf(full));
+	beginGet(c, pending, timeouts);
+	tgbot::trace::ScopedSpan span(pending.method.c_str());
+
+	return endGet(c, pending, perform(c));
 }
 
 std::string tgbot::utils::http::multiPartUpload(CURL *c, const std::string &full, PostForms const &forms) {
@@ -76,10 +617,18 @@ std::string tgbot::utils::http::multiPartUpload(CURL *c, const std::string &full
 	curl_easy_setopt(c, CURLOPT_HTTPPOST, multiPost);
 	curl_easy_setopt(c, CURLOPT_WRITEDATA, &body);
 	curl_easy_setopt(c, CURLOPT_URL, full.c_str());
+	applyTimeouts(c, getTimeouts(Operation::UPLOAD));
+	watchCancellation(c);
+
+	const std::string &method = methodOf(full);
+	LaneSlot lane(method, Priority::BULK);
+	tgbot::trace::ScopedSpan span(method.c_str());
+
+	const auto start = std::chrono::steady_clock::now();
+	CURLcode code = perform(c);
+	recordRequest(c, full, method, code, body.size(), start);
 
-	CURLcode code;
-	if ((code = curl_easy_perform(c)) != CURLE_OK)
-		throw std::runtime_error(curl_easy_strerror(code));
+	throwOnFailure(code);
 
 	return body;
 }
@@ -0,0 +1,315 @@
+#include <tgbot/utils/journal.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+//
+// File layout: Header, then records back to back from Header::start up to
+// Header::end. Record: RecordHeader, JSON, padding to 8 bytes. Completed
+// records past the checkpoint get their marker switched, so they aren't
+// replayed. RecordHeader::attempts counts dispatches, bumped before each
+// replay.
+//
+// Header::end only moves after a record is fully written, so a crash can't
+// leave a half written record in. Compaction copies pending records to the
+// start of the file only when source and destination don't overlap, and
+// points Header::start at the originals meanwhile: a crash during the copy
+// leaves them to recover(). Only then does the header point at the copy
+// (start before end: a crash in between leaves the whole copy, then stale
+// records that recover() rejects). With syncEachBatch each step reaches the
+// disk before the next.
+//
+
+static const char journalMagic[8] = {'T', 'G', 'B', 'J', 'R', 'N', 'L', '2'};
+static constexpr std::uint32_t recordMarker = 0x7e1e6a31;
+static constexpr std::uint32_t completedMarker = 0x7e1e6a32;
+
+struct tgbot::utils::UpdateJournal::Header {
+	char magic[8];
+	std::int64_t checkpoint;
+	std::uint64_t end;
+	std::uint64_t start;  // 0: firstRecord
+};
+
+namespace {
+
+	struct RecordHeader {
+		std::uint32_t marker;
+		std::uint32_t length;
+		std::int32_t updateId;
+		std::uint32_t checksum;
+		std::uint32_t attempts;
+		std::uint32_t reserved;
+	};
+
+	// FNV-1a
+	std::uint32_t checksumOf(const char *data, std::size_t length) {
+		std::uint32_t hash = 2166136261u;
+		for (std::size_t i = 0; i < length; ++i) {
+			hash ^= static_cast<unsigned char>(data[i]);
+			hash *= 16777619u;
+		}
+
+		return hash;
+	}
+
+	std::size_t recordSize(std::size_t length) {
+		return sizeof(RecordHeader) + ((length + 7) & ~static_cast<std::size_t>(7));
+	}
+
+	std::runtime_error ioError(const std::string &what, const std::string &path) {
+		return std::runtime_error("update journal " + path + ": " + what + ": " +
+		                          std::strerror(errno));
+	}
+
+}  // namespace
+
+static constexpr std::size_t firstRecord = 32;  // sizeof(Header)
+
+tgbot::utils::UpdateJournal::UpdateJournal(const std::string &_path,
+                                           bool _syncEachBatch,
+                                           std::size_t initialSize)
+		: path(_path), syncEachBatch(_syncEachBatch) {
+	fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+	if (fd < 0) throw ioError("open()", path);
+
+	struct stat info;
+	if (fstat(fd, &info) < 0) {
+		close(fd);
+		throw ioError("fstat()", path);
+	}
+
+	try {
+		if (static_cast<std::size_t>(info.st_size) < firstRecord) {
+			const std::size_t size = std::max<std::size_t>(initialSize, 4096);
+			if (ftruncate(fd, static_cast<off_t>(size)) < 0)
+				throw ioError("ftruncate()", path);
+
+			map(size);
+			std::memcpy(header()->magic, journalMagic, sizeof(journalMagic));
+			header()->checkpoint = 0;
+			header()->end = firstRecord;
+			header()->start = firstRecord;
+		} else {
+			map(static_cast<std::size_t>(info.st_size));
+			if (std::memcmp(header()->magic, journalMagic, sizeof(journalMagic)))
+				throw std::runtime_error("update journal " + path + ": bad magic");
+
+			recover();
+		}
+	} catch (...) {
+		if (base) munmap(base, capacity);
+		close(fd);
+		throw;
+	}
+}
+
+tgbot::utils::UpdateJournal::~UpdateJournal() {
+	msync(base, capacity, MS_ASYNC);
+	munmap(base, capacity);
+	close(fd);
+}
+
+tgbot::utils::UpdateJournal::Header *tgbot::utils::UpdateJournal::header() const {
+	static_assert(sizeof(Header) == firstRecord, "journal header layout");
+	return reinterpret_cast<Header *>(base);
+}
+
+void tgbot::utils::UpdateJournal::map(std::size_t size) {
+	void *mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (mapped == MAP_FAILED) throw ioError("mmap()", path);
+
+	base = static_cast<char *>(mapped);
+	capacity = size;
+}
+
+void tgbot::utils::UpdateJournal::recover() {
+	Header *h = header();
+	const std::size_t end = std::min<std::size_t>(h->end, capacity);
+
+	std::size_t position = std::max<std::size_t>(h->start, firstRecord);
+	bool any = false;
+	std::int32_t last = 0;
+
+	while (position + sizeof(RecordHeader) <= end) {
+		RecordHeader record;
+		std::memcpy(&record, base + position, sizeof(record));
+
+		const std::size_t size = recordSize(record.length);
+		if ((record.marker != recordMarker && record.marker != completedMarker) ||
+		    size > end - position ||
+		    (any && record.updateId <= last) ||
+		    record.checksum != checksumOf(base + position + sizeof(record), record.length))
+			break;
+
+		if (record.marker == recordMarker && record.updateId >= h->checkpoint)
+			inFlight[record.updateId] = position;
+
+		any = true;
+		last = record.updateId;
+		position += size;
+	}
+
+	lastAppended = any ? last : static_cast<int>(h->checkpoint) - 1;
+
+	if (inFlight.empty()) {
+		h->start = firstRecord;
+		h->end = firstRecord;
+	} else {
+		// records before start may be an interrupted compaction: keep them out
+		h->end = position;
+	}
+}
+
+void tgbot::utils::UpdateJournal::reserve(std::size_t size) {
+	Header *h = header();
+	if (h->end + size <= capacity) return;
+
+	// move pending records back to the start, if it can be done safely
+	if (!inFlight.empty()) {
+		const std::size_t from = inFlight.begin()->second;
+		const std::size_t length = h->end - from;
+
+		if (from - firstRecord >= length && firstRecord + length + size <= capacity) {
+			// records before from are completed: recover() may skip them
+			h->start = from;
+			sync(0, firstRecord);
+
+			std::memcpy(base + firstRecord, base + from, length);
+			sync(firstRecord, length);
+
+			h->start = firstRecord;
+			h->end = firstRecord + length;
+			sync(0, firstRecord);
+
+			for (auto &record : inFlight) record.second -= from - firstRecord;
+			return;
+		}
+	}
+
+	const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+	std::size_t newCapacity = std::max(capacity * 2, h->end + size);
+	newCapacity = (newCapacity + pageSize - 1) / pageSize * pageSize;
+
+	if (ftruncate(fd, static_cast<off_t>(newCapacity)) < 0)
+		throw ioError("ftruncate()", path);
+
+	munmap(base, capacity);
+	base = nullptr;
+	map(newCapacity);
+}
+
+bool tgbot::utils::UpdateJournal::append(int updateId, const char *json,
+                                         std::size_t length) {
+	std::lock_guard<std::mutex> guard(mtx);
+
+	// already journaled (e.g. getUpdates retried)
+	if (updateId <= lastAppended) return false;
+
+	const std::size_t size = recordSize(length);
+	reserve(size);
+
+	Header *h = header();
+	char *position = base + h->end;
+
+	RecordHeader record;
+	record.marker = recordMarker;
+	record.length = static_cast<std::uint32_t>(length);
+	record.updateId = updateId;
+	record.checksum = checksumOf(json, length);
+	record.attempts = 1;  // dispatched right after
+	record.reserved = 0;
+
+	std::memcpy(position, &record, sizeof(record));
+	std::memcpy(position + sizeof(record), json, length);
+
+	inFlight[updateId] = h->end;
+	h->end += size;
+	lastAppended = updateId;
+	return true;
+}
+
+void tgbot::utils::UpdateJournal::sync(std::size_t from, std::size_t length) {
+	if (!syncEachBatch) return;
+
+	// msync() wants a page aligned address
+	const std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+	const std::size_t page = from / pageSize * pageSize;
+
+	if (msync(base + page, from + length - page, MS_SYNC) < 0)
+		throw ioError("msync()", path);
+}
+
+void tgbot::utils::UpdateJournal::commitBatch() {
+	if (!syncEachBatch) return;
+
+	std::lock_guard<std::mutex> guard(mtx);
+	sync(0, header()->end);
+}
+
+void tgbot::utils::UpdateJournal::completed(int updateId) {
+	std::lock_guard<std::mutex> guard(mtx);
+
+	auto record = inFlight.find(updateId);
+	if (record == inFlight.end()) return;
+
+	std::memcpy(base + record->second, &completedMarker, sizeof(completedMarker));
+	inFlight.erase(record);
+
+	Header *h = header();
+	if (inFlight.empty()) {
+		h->checkpoint = lastAppended + 1;
+		// nothing to keep: rewind
+		h->start = firstRecord;
+		h->end = firstRecord;
+	} else {
+		h->checkpoint = inFlight.begin()->first;
+	}
+}
+
+unsigned tgbot::utils::UpdateJournal::attempt(int updateId) {
+	std::lock_guard<std::mutex> guard(mtx);
+
+	auto inFlightRecord = inFlight.find(updateId);
+	if (inFlightRecord == inFlight.end()) return 0;
+
+	RecordHeader record;
+	std::memcpy(&record, base + inFlightRecord->second, sizeof(record));
+	++record.attempts;
+	std::memcpy(base + inFlightRecord->second, &record, sizeof(record));
+
+	return record.attempts;
+}
+
+int tgbot::utils::UpdateJournal::checkpoint() const {
+	std::lock_guard<std::mutex> guard(mtx);
+	return static_cast<int>(header()->checkpoint);
+}
+
+int tgbot::utils::UpdateJournal::nextOffset() const {
+	std::lock_guard<std::mutex> guard(mtx);
+	return std::max(static_cast<int>(header()->checkpoint), lastAppended + 1);
+}
+
+std::vector<std::pair<int, std::string>> tgbot::utils::UpdateJournal::pending() const {
+	std::lock_guard<std::mutex> guard(mtx);
+
+	std::vector<std::pair<int, std::string>> records;
+	records.reserve(inFlight.size());
+
+	for (const auto &inFlightRecord : inFlight) {
+		RecordHeader record;
+		std::memcpy(&record, base + inFlightRecord.second, sizeof(record));
+
+		records.emplace_back(inFlightRecord.first,
+		                     std::string(base + inFlightRecord.second + sizeof(record),
+		                                 record.length));
+	}
+
+	return records;
+}
@@ -1,11 +1,225 @@
 #include <tgbot/logger.h>
 #include <tgbot/utils/time.h>
+#include <atomic>
+#include <condition_variable>
+#include <ctime>
 #include <mutex>
-#include <sstream>
+#include <thread>
 
 std::mutex mtx;
 
+namespace tgbot {
+
+/*!
+ * @brief Background writer for asynchronous logging: bounded lock-free
+ * multi-producer queue (one sequence number per slot), drained by a
+ * single thread
+ */
+	class __AsyncLogWriter {
+	public:
+		__AsyncLogWriter(std::ostream *_stream, const std::string &_dateFormat,
+		                 std::chrono::milliseconds _flushInterval,
+		                 std::size_t capacity, Logger::OverflowPolicy _policy);
+
+		~__AsyncLogWriter();
+
+		void push(const char *prefix, const std::string &message);
+
+		void setStream(std::ostream *newStream);
+
+		void setDateFormat(const std::string &newDateFormat);
+
+		inline std::size_t dropped() const {
+			return nDropped.load(std::memory_order_relaxed);
+		}
+
+	private:
+		struct Record {
+			std::time_t when;
+			const char *prefix;
+			std::string message;
+		};
+
+		struct Slot {
+			std::atomic<std::size_t> sequence;
+			Record record;
+		};
+
+		bool tryPush(Record &record);
+
+		bool tryPop(Record &record);
+
+		void drain();
+
+		void run();
+
+		std::unique_ptr<Slot[]> slots;
+		std::size_t mask;
+		std::atomic<std::size_t> enqueuePos{0};
+		std::size_t dequeuePos{0};
+		std::atomic<std::size_t> nDropped{0};
+		std::atomic<bool> running{true};
+		std::atomic<std::size_t> nBlocked{0};  // producers waiting for room
+
+		std::mutex configMutex;
+		std::ostream *stream;
+		std::string dateFormat;
+
+		std::mutex waitMutex;
+		std::condition_variable wakeUp;
+		std::condition_variable roomMade;
+		std::chrono::milliseconds flushInterval;
+		Logger::OverflowPolicy policy;
+
+		std::time_t cachedTime{-1};
+		std::string cachedTimeString;
+
+		std::thread writer;
+	};
+
+}  // namespace tgbot
+
+tgbot::__AsyncLogWriter::__AsyncLogWriter(
+		std::ostream *_stream, const std::string &_dateFormat,
+		std::chrono::milliseconds _flushInterval, std::size_t capacity,
+		Logger::OverflowPolicy _policy)
+		: stream(_stream), dateFormat(_dateFormat),
+		  flushInterval(_flushInterval), policy(_policy) {
+	std::size_t size = 2;
+	while (size < capacity) size <<= 1;
+
+	slots = std::unique_ptr<Slot[]>(new Slot[size]);
+	mask = size - 1;
+
+	for (std::size_t i = 0; i < size; ++i)
+		slots[i].sequence.store(i, std::memory_order_relaxed);
+
+	writer = std::thread(&__AsyncLogWriter::run, this);
+}
+
+tgbot::__AsyncLogWriter::~__AsyncLogWriter() {
+	running.store(false, std::memory_order_release);
+	wakeUp.notify_one();
+	writer.join();
+}
+
+bool tgbot::__AsyncLogWriter::tryPush(Record &record) {
+	std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+	Slot *slot;
+
+	while (true) {
+		slot = &slots[pos & mask];
+		const std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		const std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(sequence) -
+		                            static_cast<std::ptrdiff_t>(pos);
+
+		if (!diff) {
+			if (enqueuePos.compare_exchange_weak(pos, pos + 1,
+			                                     std::memory_order_relaxed))
+				break;
+		} else if (diff < 0)
+			return false;  // full
+		else
+			pos = enqueuePos.load(std::memory_order_relaxed);
+	}
+
+	slot->record = std::move(record);
+	slot->sequence.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+bool tgbot::__AsyncLogWriter::tryPop(Record &record) {
+	Slot *slot = &slots[dequeuePos & mask];
+	if (slot->sequence.load(std::memory_order_acquire) != dequeuePos + 1)
+		return false;  // empty
+
+	record = std::move(slot->record);
+	slot->sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+	++dequeuePos;
+	return true;
+}
+
+void tgbot::__AsyncLogWriter::push(const char *prefix,
+                                   const std::string &message) {
+	Record record{std::time(nullptr), prefix, message};
+
+	if (tryPush(record)) return;
+
+	if (policy == Logger::OverflowPolicy::DROP) {
+		nDropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	// the writer makes room under waitMutex: no wakeup gets lost
+	std::unique_lock<std::mutex> lock(waitMutex);
+	nBlocked.fetch_add(1, std::memory_order_relaxed);
+	wakeUp.notify_one();
+	roomMade.wait(lock, [this, &record] { return tryPush(record); });
+	nBlocked.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void tgbot::__AsyncLogWriter::setStream(std::ostream *newStream) {
+	std::lock_guard<std::mutex> guard(configMutex);
+	stream = newStream;
+}
+
+void tgbot::__AsyncLogWriter::setDateFormat(const std::string &newDateFormat) {
+	std::lock_guard<std::mutex> guard(configMutex);
+	dateFormat = newDateFormat;
+	cachedTime = -1;
+}
+
+void tgbot::__AsyncLogWriter::drain() {
+	std::lock_guard<std::mutex> configGuard(configMutex);
+
+	std::string batch;
+	Record record;
+
+	while (tryPop(record)) {
+		if (nBlocked.load(std::memory_order_relaxed)) {
+			std::lock_guard<std::mutex> guard(waitMutex);
+			roomMade.notify_all();
+		}
+
+		// records come mostly in time order, format each second once
+		if (record.when != cachedTime) {
+			cachedTimeString = utils::format_time(record.when, dateFormat);
+			cachedTime = record.when;
+		}
+
+		batch.append(record.prefix)
+				.append(cachedTimeString)
+				.append(" - ")
+				.append(record.message)
+				.push_back('\n');
+	}
+
+	if (batch.empty() || stream->fail()) return;
+
+	std::lock_guard<std::mutex> guard(mtx);
+	stream->write(batch.c_str(), batch.size());
+	stream->flush();
+}
+
+void tgbot::__AsyncLogWriter::run() {
+	while (running.load(std::memory_order_acquire)) {
+		drain();
+
+		std::unique_lock<std::mutex> lock(waitMutex);
+		wakeUp.wait_for(lock, flushInterval, [this] {
+			return !running.load(std::memory_order_acquire) ||
+			       nBlocked.load(std::memory_order_relaxed);
+		});
+	}
+
+	drain();
+}
+
 tgbot::Logger::~Logger() {
+	// the background writer owns the stream, and flushes it
+	if (async) return;
+
+	std::lock_guard<std::mutex> guard(mtx);
 	if (!stream->fail()) stream->flush();
 }
 
@@ -14,30 +228,102 @@ tgbot::Logger::operator bool() const {
 	return stream->fail();
 }
 
-void tgbot::Logger::info(std::string const &sInfo) const {
-	if (stream->fail()) return;
+void tgbot::Logger::setStream(std::ostream &newStream) {
+	stream = &newStream;
+	if (async) async->setStream(stream);
+}
 
-	std::stringstream fullLog;
-	fullLog << "I: " << tgbot::utils::get_current_time(dateFormat) << " - "
-	        << sInfo << '\n';
+void tgbot::Logger::setDateFormat(std::string &newDateFormat) {
+	dateFormat = std::move(newDateFormat);
+	if (async) async->setDateFormat(dateFormat);
+}
 
-	std::string const &logString = fullLog.str();
+void tgbot::Logger::setAsync(std::chrono::milliseconds flushInterval,
+                             std::size_t capacity, OverflowPolicy policy) {
+	async = std::make_shared<__AsyncLogWriter>(stream, dateFormat, flushInterval,
+	                                           capacity, policy);
+}
 
-	std::lock_guard<std::mutex> guard(mtx);
-	stream->write(logString.c_str(), logString.size());
-	stream->flush();
+void tgbot::Logger::setSync() { async.reset(); }
+
+std::size_t tgbot::Logger::dropped() const {
+	return async ? async->dropped() : 0;
 }
 
-void tgbot::Logger::error(std::string const &sError) const {
-	if (stream->fail()) return;
+// formatting localtime is expensive: do it once per second per thread
+static const std::string &cachedCurrentTime(const std::string &dateFormat) {
+	static thread_local std::time_t cachedTime = -1;
+	static thread_local std::string cachedFormat;
+	static thread_local std::string cachedTimeString;
+
+	const std::time_t now = std::time(nullptr);
+	if (now != cachedTime || dateFormat != cachedFormat) {
+		cachedTimeString = tgbot::utils::format_time(now, dateFormat);
+		cachedFormat = dateFormat;
+		cachedTime = now;
+	}
 
-	std::stringstream fullLog;
-	fullLog << "E! " << tgbot::utils::get_current_time(dateFormat) << " - "
-	        << sError << '\n';
+	return cachedTimeString;
+}
+
+void tgbot::Logger::write(const char *prefix,
+                          std::string const &message) const {
+	if (async) {
+		async->push(prefix, message);
+		return;
+	}
 
-	std::string const &logString = fullLog.str();
+	std::string logString(prefix);
+	logString.append(cachedCurrentTime(dateFormat))
+			.append(" - ")
+			.append(message)
+			.push_back('\n');
 
 	std::lock_guard<std::mutex> guard(mtx);
+	if (stream->fail()) return;
+
 	stream->write(logString.c_str(), logString.size());
 	stream->flush();
 }
+
+void tgbot::Logger::log(LogLevel logLevel, std::string const &message) const {
+	if (logLevel < level) return;
+
+	switch (logLevel) {
+		case LogLevel::LEVEL_TRACE:
+			write("T: ", message);
+			break;
+		case LogLevel::LEVEL_DEBUG:
+			write("D: ", message);
+			break;
+		case LogLevel::LEVEL_INFO:
+			write("I: ", message);
+			break;
+		case LogLevel::LEVEL_WARN:
+			write("W! ", message);
+			break;
+		case LogLevel::LEVEL_ERROR:
+			write("E! ", message);
+			break;
+	}
+}
+
+void tgbot::Logger::trace(std::string const &sTrace) const {
+	log(LogLevel::LEVEL_TRACE, sTrace);
+}
+
+void tgbot::Logger::debug(std::string const &sDebug) const {
+	log(LogLevel::LEVEL_DEBUG, sDebug);
+}
+
+void tgbot::Logger::info(std::string const &sInfo) const {
+	log(LogLevel::LEVEL_INFO, sInfo);
+}
+
+void tgbot::Logger::warn(std::string const &sWarn) const {
+	log(LogLevel::LEVEL_WARN, sWarn);
+}
+
+void tgbot::Logger::error(std::string const &sError) const {
+	log(LogLevel::LEVEL_ERROR, sError);
+}
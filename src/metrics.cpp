@@ -0,0 +1,299 @@
+#include <tgbot/metrics.h>
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+using namespace tgbot::metrics;
+
+constexpr std::size_t Histogram::nBuckets;
+
+std::size_t tgbot::metrics::Histogram::bucketOf(std::uint64_t value) noexcept {
+	if (value < subBuckets) return static_cast<std::size_t>(value);
+
+	const unsigned msb = 63 - __builtin_clzll(value);
+	const unsigned shift = msb - subBucketBits;
+	const std::size_t mantissa = static_cast<std::size_t>(value >> shift);
+
+	return subBuckets + shift * subBuckets + (mantissa - subBuckets);
+}
+
+std::uint64_t tgbot::metrics::Histogram::upperBoundOf(
+		std::size_t bucket) noexcept {
+	if (bucket < subBuckets) return bucket;
+
+	const unsigned shift = static_cast<unsigned>((bucket - subBuckets) / subBuckets);
+	const std::uint64_t mantissa = subBuckets + (bucket - subBuckets) % subBuckets;
+
+	return ((mantissa + 1) << shift) - 1;
+}
+
+void tgbot::metrics::Histogram::record(std::uint64_t value) noexcept {
+	buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+	sum.fetch_add(value, std::memory_order_relaxed);
+
+	std::uint64_t currentMax = max.load(std::memory_order_relaxed);
+	while (value > currentMax &&
+	       !max.compare_exchange_weak(currentMax, value, std::memory_order_relaxed));
+}
+
+HistogramSnapshot tgbot::metrics::Histogram::snapshot() const {
+	HistogramSnapshot snapshot;
+
+	for (std::size_t i = 0; i < nBuckets; ++i) {
+		const std::uint64_t n = buckets[i].load(std::memory_order_relaxed);
+		if (n) {
+			snapshot.buckets.emplace_back(upperBoundOf(i), n);
+			snapshot.count += n;
+		}
+	}
+
+	snapshot.sum = sum.load(std::memory_order_relaxed);
+	snapshot.max = max.load(std::memory_order_relaxed);
+
+	return snapshot;
+}
+
+std::uint64_t tgbot::metrics::HistogramSnapshot::percentile(double q) const {
+	if (!count) return 0;
+
+	const double target = q * static_cast<double>(count);
+	std::uint64_t seen = 0;
+
+	for (auto const &bucket : buckets) {
+		seen += bucket.second;
+		if (static_cast<double>(seen) >= target)
+			return bucket.first < max ? bucket.first : max;
+	}
+
+	return max;
+}
+
+Registry &tgbot::metrics::Registry::global() {
+	static Registry registry;
+	return registry;
+}
+
+Registry::Entry &tgbot::metrics::Registry::entry(const std::string &name,
+                                                 const std::string &labels,
+                                                 const std::string &help,
+                                                 MetricType type, double unit) {
+	std::lock_guard<std::mutex> guard(mtx);
+
+	Entry &found = entries[std::make_pair(name, labels)];
+	if (!found.counter && !found.gauge && !found.histogram) {
+		found.help = help;
+		found.type = type;
+		found.unit = unit;
+
+		switch (type) {
+			case MetricType::COUNTER:
+				found.counter = std::unique_ptr<Counter>(new Counter);
+				break;
+			case MetricType::GAUGE:
+				found.gauge = std::unique_ptr<Gauge>(new Gauge);
+				break;
+			case MetricType::HISTOGRAM:
+				found.histogram = std::unique_ptr<Histogram>(new Histogram);
+				break;
+		}
+
+		// entries never move nor go away: publish their addresses
+		std::shared_ptr<std::vector<const Node *>> nodes =
+				std::make_shared<std::vector<const Node *>>();
+		nodes->reserve(entries.size());
+		for (auto const &node : entries) nodes->push_back(&node);
+
+		std::atomic_store(&published,
+		                  std::shared_ptr<const std::vector<const Node *>>(std::move(nodes)));
+	}
+
+	return found;
+}
+
+Counter &tgbot::metrics::Registry::counter(const std::string &name,
+                                           const std::string &labels,
+                                           const std::string &help) {
+	Entry &found = entry(name, labels, help, MetricType::COUNTER, 1);
+	if (!found.counter)
+		throw std::invalid_argument(name + " is registered with another type");
+
+	return *found.counter;
+}
+
+Gauge &tgbot::metrics::Registry::gauge(const std::string &name,
+                                       const std::string &labels,
+                                       const std::string &help) {
+	Entry &found = entry(name, labels, help, MetricType::GAUGE, 1);
+	if (!found.gauge)
+		throw std::invalid_argument(name + " is registered with another type");
+
+	return *found.gauge;
+}
+
+Histogram &tgbot::metrics::Registry::histogram(const std::string &name,
+                                               const std::string &labels,
+                                               const std::string &help,
+                                               double unit) {
+	Entry &found = entry(name, labels, help, MetricType::HISTOGRAM, unit);
+	if (!found.histogram)
+		throw std::invalid_argument(name + " is registered with another type");
+
+	return *found.histogram;
+}
+
+std::vector<MetricSnapshot> tgbot::metrics::Registry::snapshot() const {
+	const std::shared_ptr<const std::vector<const Node *>> &nodes =
+			std::atomic_load(&published);
+
+	std::vector<MetricSnapshot> snapshots;
+	snapshots.reserve(nodes->size());
+
+	for (const Node *node : *nodes) {
+		const Entry &entry = node->second;
+
+		MetricSnapshot snapshot;
+		snapshot.name = node->first.first;
+		snapshot.labels = node->first.second;
+		snapshot.help = entry.help;
+		snapshot.type = entry.type;
+		snapshot.unit = entry.unit;
+		snapshot.value = 0;
+
+		if (entry.counter)
+			snapshot.value = static_cast<std::int64_t>(entry.counter->get());
+		else if (entry.gauge)
+			snapshot.value = entry.gauge->get();
+		else if (entry.histogram)
+			snapshot.histogram = entry.histogram->snapshot();
+
+		snapshots.push_back(std::move(snapshot));
+	}
+
+	return snapshots;
+}
+
+static inline void labelsOf(std::ostream &out, const std::string &labels,
+                            const char *extra = nullptr) {
+	if (labels.empty() && !extra) return;
+
+	out << '{' << labels;
+	if (extra) out << (labels.empty() ? "" : ",") << extra;
+	out << '}';
+}
+
+std::string tgbot::metrics::Registry::toPrometheus() const {
+	std::stringstream out;
+	const std::string *previousName = nullptr;
+
+	const std::vector<MetricSnapshot> &snapshots = snapshot();
+	for (auto const &metric : snapshots) {
+		if (!previousName || *previousName != metric.name) {
+			if (!metric.help.empty())
+				out << "# HELP " << metric.name << ' ' << metric.help << '\n';
+
+			out << "# TYPE " << metric.name << ' '
+			    << (metric.type == MetricType::COUNTER
+			        ? "counter"
+			        : metric.type == MetricType::GAUGE ? "gauge" : "summary")
+			    << '\n';
+		}
+		previousName = &metric.name;
+
+		if (metric.type != MetricType::HISTOGRAM) {
+			out << metric.name;
+			labelsOf(out, metric.labels);
+			out << ' ' << metric.value << '\n';
+			continue;
+		}
+
+		static const struct {
+			double q;
+			const char *label;
+		} quantiles[] = {
+				{0.5,  "quantile=\"0.5\""},
+				{0.9,  "quantile=\"0.9\""},
+				{0.99, "quantile=\"0.99\""}
+		};
+
+		for (auto const &quantile : quantiles) {
+			out << metric.name;
+			labelsOf(out, metric.labels, quantile.label);
+			out << ' ' << metric.histogram.percentile(quantile.q) * metric.unit << '\n';
+		}
+
+		out << metric.name << "_sum";
+		labelsOf(out, metric.labels);
+		out << ' ' << metric.histogram.sum * metric.unit << '\n';
+
+		out << metric.name << "_count";
+		labelsOf(out, metric.labels);
+		out << ' ' << metric.histogram.count << '\n';
+	}
+
+	return out.str();
+}
+
+std::string tgbot::metrics::label(const std::string &key,
+                                  const std::string &value) {
+	std::string pair(key);
+	pair.append("=\"");
+
+	for (const char &c : value) {
+		if (c == '\\' || c == '"')
+			pair.push_back('\\');
+		else if (c == '\n') {
+			pair.append("\\n");
+			continue;
+		}
+
+		pair.push_back(c);
+	}
+
+	pair.push_back('"');
+	return pair;
+}
+
+static inline bool slowerThan(const SlowLog::Entry &a, const SlowLog::Entry &b) {
+	return a.micros > b.micros;
+}
+
+void tgbot::metrics::SlowLog::insert(std::uint64_t micros, std::string what) {
+	std::lock_guard<std::mutex> guard(mtx);
+
+	// min-heap on duration: the fastest entry kept sits at the front
+	if (heap.size() == capacity) {
+		if (micros <= heap.front().micros) return;
+
+		std::pop_heap(heap.begin(), heap.end(), slowerThan);
+		heap.pop_back();
+	}
+
+	heap.push_back(Entry{micros, std::move(what), std::time(nullptr)});
+	std::push_heap(heap.begin(), heap.end(), slowerThan);
+
+	if (heap.size() == capacity)
+		threshold.store(heap.front().micros, std::memory_order_relaxed);
+}
+
+std::vector<SlowLog::Entry> tgbot::metrics::SlowLog::entries() const {
+	std::vector<Entry> sorted;
+
+	{
+		std::lock_guard<std::mutex> guard(mtx);
+		sorted = heap;
+	}
+
+	std::sort(sorted.begin(), sorted.end(), slowerThan);
+	return sorted;
+}
+
+void tgbot::metrics::SlowLog::clear() {
+	std::lock_guard<std::mutex> guard(mtx);
+	heap.clear();
+	threshold.store(0, std::memory_order_relaxed);
+}
+
+SlowLog &tgbot::metrics::slowHandlers() {
+	static SlowLog log;
+	return log;
+}
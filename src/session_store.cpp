@@ -0,0 +1,135 @@
+#include <tgbot/utils/session_store.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdio>
+
+//
+// Snapshot layout: magic, uint64 count, then per session
+// int64 key, int64 expiresAt, uint32 length, value bytes
+//
+
+static const char snapshotMagic[8] = {'T', 'G', 'B', 'S', 'E', 'S', 'S', '1'};
+static constexpr std::size_t recordHeaderSize = 8 + 8 + 4;
+
+static std::runtime_error snapshotError(const std::string &what,
+                                        const std::string &path) {
+	return std::runtime_error("session snapshot " + path + ": " + what + ": " +
+	                          std::strerror(errno));
+}
+
+void tgbot::utils::__writeSessionSnapshot(const std::string &path,
+                                          const std::vector<SessionRecord> &records) {
+	std::size_t size = sizeof(snapshotMagic) + 8;
+	for (const SessionRecord &record : records)
+		size += recordHeaderSize + record.value.size();
+
+	const std::string &temporary = path + ".tmp";
+	const int fd = open(temporary.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0) throw snapshotError("open()", temporary);
+
+	if (ftruncate(fd, static_cast<off_t>(size)) < 0) {
+		close(fd);
+		throw snapshotError("ftruncate()", temporary);
+	}
+
+	void *mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (mapped == MAP_FAILED) {
+		close(fd);
+		throw snapshotError("mmap()", temporary);
+	}
+
+	char *out = static_cast<char *>(mapped);
+	const std::uint64_t count = records.size();
+
+	std::memcpy(out, snapshotMagic, sizeof(snapshotMagic));
+	std::memcpy(out + sizeof(snapshotMagic), &count, 8);
+	out += sizeof(snapshotMagic) + 8;
+
+	for (const SessionRecord &record : records) {
+		const std::uint32_t length = static_cast<std::uint32_t>(record.value.size());
+
+		std::memcpy(out, &record.key, 8);
+		std::memcpy(out + 8, &record.expiresAt, 8);
+		std::memcpy(out + 16, &length, 4);
+		std::memcpy(out + recordHeaderSize, record.value.data(), length);
+		out += recordHeaderSize + length;
+	}
+
+	const bool synced = msync(mapped, size, MS_SYNC) == 0;
+	munmap(mapped, size);
+	close(fd);
+
+	if (!synced) throw snapshotError("msync()", temporary);
+
+	// readers see either the previous snapshot or this one
+	if (std::rename(temporary.c_str(), path.c_str()) < 0)
+		throw snapshotError("rename()", path);
+}
+
+std::vector<tgbot::utils::SessionRecord> tgbot::utils::__readSessionSnapshot(
+		const std::string &path) {
+	std::vector<SessionRecord> records;
+
+	const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		if (errno == ENOENT) return records;
+		throw snapshotError("open()", path);
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) < 0) {
+		close(fd);
+		throw snapshotError("fstat()", path);
+	}
+
+	const std::size_t size = static_cast<std::size_t>(info.st_size);
+	if (size < sizeof(snapshotMagic) + 8) {
+		close(fd);
+		throw std::runtime_error("session snapshot " + path + ": truncated");
+	}
+
+	void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapped == MAP_FAILED) throw snapshotError("mmap()", path);
+
+	const char *in = static_cast<const char *>(mapped);
+	const char *end = in + size;
+
+	std::uint64_t count;
+	std::memcpy(&count, in + sizeof(snapshotMagic), 8);
+
+	bool valid = !std::memcmp(in, snapshotMagic, sizeof(snapshotMagic));
+	in += sizeof(snapshotMagic) + 8;
+
+	for (std::uint64_t i = 0; valid && i < count; ++i) {
+		if (static_cast<std::size_t>(end - in) < recordHeaderSize) {
+			valid = false;
+			break;
+		}
+
+		SessionRecord record;
+		std::uint32_t length;
+		std::memcpy(&record.key, in, 8);
+		std::memcpy(&record.expiresAt, in + 8, 8);
+		std::memcpy(&length, in + 16, 4);
+		in += recordHeaderSize;
+
+		if (static_cast<std::size_t>(end - in) < length) {
+			valid = false;
+			break;
+		}
+
+		record.value.assign(in, length);
+		in += length;
+		records.push_back(std::move(record));
+	}
+
+	munmap(mapped, size);
+
+	if (!valid) throw std::runtime_error("session snapshot " + path + ": corrupted");
+
+	return records;
+}
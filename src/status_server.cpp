@@ -0,0 +1,285 @@
+#include <tgbot/methods/api.h>
+#include <tgbot/metrics.h>
+#include <tgbot/status_server.h>
+#include <tgbot/utils/encode.h>
+#include <tgbot/watchdog.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <sstream>
+#include <stdexcept>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace metrics = tgbot::metrics;
+
+static constexpr std::size_t maxRequestSize = 4096;
+
+tgbot::StatusServer::StatusServer(unsigned short _port,
+                                  const std::string &_address,
+                                  std::chrono::seconds _staleAfter)
+		: port(_port), address(_address), staleAfter(_staleAfter) {}
+
+tgbot::StatusServer::~StatusServer() { stop(); }
+
+void tgbot::StatusServer::watch(const methods::Api &bot, const std::string &name) {
+	std::lock_guard<std::mutex> guard(watchedMtx);
+	watched.emplace_back(name, bot.lastPollTime());
+}
+
+void tgbot::StatusServer::start() {
+	if (running.load()) return;
+
+	sockaddr_in bindAddress;
+	std::memset(&bindAddress, 0, sizeof(bindAddress));
+	bindAddress.sin_family = AF_INET;
+	bindAddress.sin_port = htons(port);
+
+	if (inet_pton(AF_INET, address.c_str(), &bindAddress.sin_addr) != 1)
+		throw std::runtime_error("status server: invalid address " + address);
+
+	listener = socket(AF_INET, SOCK_STREAM, 0);
+	if (listener < 0)
+		throw std::runtime_error(std::string("status server: socket(): ") +
+		                         std::strerror(errno));
+
+	const int reuse = 1;
+	setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	socklen_t addressLength = sizeof(bindAddress);
+	if (bind(listener, reinterpret_cast<sockaddr *>(&bindAddress),
+	         sizeof(bindAddress)) < 0 ||
+	    listen(listener, 16) < 0 ||
+	    getsockname(listener, reinterpret_cast<sockaddr *>(&bindAddress),
+	                &addressLength) < 0 ||
+	    pipe(wakeUp) < 0) {
+		const std::string reason(std::strerror(errno));
+		close(listener);
+		listener = -1;
+		throw std::runtime_error("status server: cannot listen on " + address +
+		                         ":" + std::to_string(port) + ": " + reason);
+	}
+
+	port = ntohs(bindAddress.sin_port);
+	running.store(true);
+	server = std::thread(&StatusServer::run, this);
+}
+
+void tgbot::StatusServer::stop() {
+	if (!running.exchange(false)) return;
+
+	const char byte = 0;
+	if (write(wakeUp[1], &byte, 1) < 0) {
+		// listener wakes up within its poll period anyway
+	}
+
+	server.join();
+
+	close(listener);
+	close(wakeUp[0]);
+	close(wakeUp[1]);
+	listener = wakeUp[0] = wakeUp[1] = -1;
+}
+
+void tgbot::StatusServer::run() {
+	pollfd fds[2];
+	fds[0].fd = listener;
+	fds[0].events = POLLIN;
+	fds[1].fd = wakeUp[0];
+	fds[1].events = POLLIN;
+
+	while (running.load()) {
+		if (poll(fds, 2, 1000) <= 0 || !(fds[0].revents & POLLIN)) continue;
+
+		const int client = accept(listener, nullptr, nullptr);
+		if (client < 0) continue;
+
+		// one slow client must not hold the listener for long
+		timeval ioTimeout{1, 0};
+		setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &ioTimeout, sizeof(ioTimeout));
+		setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &ioTimeout, sizeof(ioTimeout));
+
+		serve(client);
+		close(client);
+	}
+}
+
+static std::string readRequestLine(int client) {
+	std::string request;
+	char buffer[512];
+
+	while (request.size() < maxRequestSize &&
+	       request.find("\r\n\r\n") == std::string::npos) {
+		const ssize_t got = recv(client, buffer, sizeof(buffer), 0);
+		if (got <= 0) break;
+		request.append(buffer, static_cast<std::size_t>(got));
+	}
+
+	return request.substr(0, request.find("\r\n"));
+}
+
+static void respond(int client, int status, const char *contentType,
+                    const std::string &body) {
+	const char *reason = status == 200 ? "OK"
+	                     : status == 404 ? "Not Found"
+	                     : status == 405 ? "Method Not Allowed"
+	                     : status == 503 ? "Service Unavailable" : "Bad Request";
+
+	std::stringstream response;
+	response << "HTTP/1.1 " << status << ' ' << reason << "\r\n"
+	         << "Content-Type: " << contentType << "\r\n"
+	         << "Content-Length: " << body.size() << "\r\n"
+	         << "Connection: close\r\n\r\n"
+	         << body;
+
+	const std::string &raw = response.str();
+	std::size_t sent = 0;
+	while (sent < raw.size()) {
+		const ssize_t n = send(client, raw.data() + sent, raw.size() - sent,
+		                       MSG_NOSIGNAL);
+		if (n <= 0) break;
+		sent += static_cast<std::size_t>(n);
+	}
+}
+
+void tgbot::StatusServer::serve(int client) const {
+	const std::string &requestLine = readRequestLine(client);
+
+	const std::size_t methodEnd = requestLine.find(' ');
+	const std::size_t pathEnd = requestLine.find(' ', methodEnd + 1);
+	if (methodEnd == std::string::npos || pathEnd == std::string::npos) {
+		respond(client, 400, "text/plain", "bad request\n");
+		return;
+	}
+
+	const std::string &method = requestLine.substr(0, methodEnd);
+	std::string path = requestLine.substr(methodEnd + 1, pathEnd - methodEnd - 1);
+	path = path.substr(0, path.find('?'));
+
+	if (method != "GET") {
+		respond(client, 405, "text/plain", "only GET is supported\n");
+		return;
+	}
+
+	if (path == "/metrics")
+		respond(client, 200, "text/plain; version=0.0.4",
+		        metrics::Registry::global().toPrometheus());
+	else if (path == "/healthz") {
+		int status;
+		const std::string &body = healthz(status);
+		respond(client, status, "application/json", body);
+	} else if (path == "/debug/handlers")
+		respond(client, 200, "application/json", debugHandlers());
+	else
+		respond(client, 404, "text/plain", "not found\n");
+}
+
+// age of the last poll at lastPollTime, -1 if none yet
+static std::int64_t ageOf(std::int64_t lastPollTime) {
+	return lastPollTime ? static_cast<std::int64_t>(std::time(nullptr)) - lastPollTime : -1;
+}
+
+static const char *statusOf(std::int64_t lastPollTime, bool healthy) {
+	return healthy ? "ok" : lastPollTime ? "stale" : "starting";
+}
+
+std::string tgbot::StatusServer::healthz(int &status) const {
+	static metrics::Gauge &lastPoll = metrics::Registry::global().gauge(
+			"tgbot_updates_last_poll_timestamp_seconds", "",
+			"Unix time of the last successful getUpdates");
+	static metrics::Gauge &inFlight = metrics::Registry::global().gauge(
+			"tgbot_handlers_in_flight", "", "Handlers dispatched and not yet finished");
+
+	std::vector<std::pair<std::string, std::int64_t>> bots;
+	{
+		std::lock_guard<std::mutex> guard(watchedMtx);
+		for (auto const &bot : watched)
+			bots.emplace_back(bot.first, bot.second->load(std::memory_order_relaxed));
+	}
+
+	auto fresh = [this](std::int64_t age) { return age >= 0 && age <= staleAfter.count(); };
+
+	std::stringstream botsBody;
+	bool healthy = true;
+	std::int64_t lastPollTime = 0;  // least recent, 0 if some bot didn't poll yet
+	std::int64_t age = 0;
+	bool stale = false;
+
+	if (bots.empty()) {
+		lastPollTime = lastPoll.get();
+		age = ageOf(lastPollTime);
+		healthy = fresh(age);
+		stale = !healthy && lastPollTime;
+	}
+
+	for (std::size_t i = 0; i < bots.size(); ++i) {
+		const std::int64_t botAge = ageOf(bots[i].second);
+		const bool botHealthy = fresh(botAge);
+
+		if (!i || !bots[i].second || (lastPollTime && bots[i].second < lastPollTime)) {
+			lastPollTime = bots[i].second;
+			age = botAge;
+		}
+		healthy = healthy && botHealthy;
+		stale = stale || (!botHealthy && bots[i].second);
+
+		botsBody << (i ? "," : "");
+		tgbot::utils::encodeJson(botsBody, bots[i].first);
+		botsBody << ":{\"status\":\"" << statusOf(bots[i].second, botHealthy)
+		         << "\",\"last_poll_age_seconds\":" << botAge << '}';
+	}
+
+	status = healthy ? 200 : 503;
+
+	std::stringstream body;
+	body << "{\"status\":\"" << (healthy ? "ok" : stale ? "stale" : "starting")
+	     << "\",\"last_poll_age_seconds\":" << age
+	     << ",\"handlers_in_flight\":" << inFlight.get();
+
+	if (!bots.empty()) body << ",\"bots\":{" << botsBody.str() << '}';
+
+	body << "}\n";
+	return body.str();
+}
+
+std::string tgbot::StatusServer::debugHandlers() const {
+	std::stringstream body;
+	body << "{\"slowest\":[";
+
+	const std::vector<metrics::SlowLog::Entry> &slowest =
+			metrics::slowHandlers().entries();
+	for (std::size_t i = 0; i < slowest.size(); ++i) {
+		if (i) body << ',';
+
+		body << "{\"handler\":";
+		tgbot::utils::encodeJson(body, slowest[i].what);
+		body << ",\"seconds\":" << static_cast<double>(slowest[i].micros) * 1e-6
+		     << ",\"finished_at\":" << slowest[i].when << '}';
+	}
+
+	body << "],\"in_flight\":[";
+
+	const auto now = std::chrono::steady_clock::now();
+	const std::vector<InFlightHandler> &handlers = inFlightHandlers();
+	for (std::size_t i = 0; i < handlers.size(); ++i) {
+		if (i) body << ',';
+
+		body << "{\"update_id\":" << handlers[i].updateId << ",\"type\":\""
+		     << types::updateTypeName(handlers[i].updateType) << "\",\"seconds\":"
+		     << std::chrono::duration_cast<std::chrono::duration<double>>(
+				     now - handlers[i].start).count()
+		     << ",\"over_budget\":" << (handlers[i].overBudget ? "true" : "false")
+		     << ",\"cancelled\":" << (handlers[i].cancelled ? "true" : "false")
+		     << '}';
+	}
+
+	body << "]}\n";
+	return body.str();
+}
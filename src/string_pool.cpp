@@ -0,0 +1,125 @@
+#include <tgbot/utils/string_pool.h>
+#include <cstring>
+
+static std::uint64_t fnv1a(const char *data, std::size_t size) {
+	std::uint64_t hash = 0xcbf29ce484222325ULL;
+	for (std::size_t i = 0; i < size; ++i) {
+		hash ^= static_cast<unsigned char>(data[i]);
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+tgbot::utils::StringPool &tgbot::utils::StringPool::global() {
+	static StringPool pool;
+	return pool;
+}
+
+tgbot::utils::StringPool::StringPool()
+		: strings(metrics::Registry::global().gauge(
+				"tgbot_string_pool_strings", "", "Strings held by the interning pool")),
+		  hits(metrics::Registry::global().counter(
+				  "tgbot_string_pool_hits_total", "",
+				  "Strings shared instead of allocated")) {}
+
+tgbot::utils::StringPool::~StringPool() {
+	strings.sub(static_cast<std::int64_t>(used));
+}
+
+void tgbot::utils::StringPool::setCapacity(std::size_t capacity, std::size_t _maxLength) {
+	std::lock_guard<std::mutex> guard(mtx);
+
+	std::size_t nSlots = 0;
+	if (capacity) {
+		nSlots = 2;
+		while (nSlots < 2 * capacity) nSlots <<= 1;
+	}
+
+	strings.sub(static_cast<std::int64_t>(used));
+	slots.assign(nSlots, Slot());
+	used = 0;
+	missesBeforeSweep = 0;
+	maxLength.store(_maxLength, std::memory_order_relaxed);
+	maxStrings = capacity;
+}
+
+std::shared_ptr<const std::string> tgbot::utils::StringPool::intern(const char *data,
+                                                                    std::size_t size) {
+	if (!maxStrings.load(std::memory_order_relaxed) ||
+	    size > maxLength.load(std::memory_order_relaxed))
+		return std::make_shared<const std::string>(data, size);
+
+	const std::uint64_t hash = fnv1a(data, size);
+
+	std::lock_guard<std::mutex> guard(mtx);
+	if (slots.empty()) return std::make_shared<const std::string>(data, size);
+
+	Slot *slot = find(hash, data, size);
+	if (slot->string) {
+		hits.increment();
+		return slot->string;
+	}
+
+	std::shared_ptr<const std::string> string =
+			std::make_shared<const std::string>(data, size);
+
+	if (used == maxStrings) {
+		// sweeping a pool full of strings in use would happen at each miss
+		if (missesBeforeSweep) {
+			--missesBeforeSweep;
+			return string;
+		}
+
+		if (sweep() < maxStrings / 4) missesBeforeSweep = maxStrings / 4;
+		if (used == maxStrings) return string;
+
+		slot = find(hash, data, size);
+	}
+
+	slot->hash = hash;
+	slot->string = string;
+	++used;
+	strings.add();
+	return string;
+}
+
+std::size_t tgbot::utils::StringPool::size() const {
+	std::lock_guard<std::mutex> guard(mtx);
+	return used;
+}
+
+// slot holding the string, or the empty slot where it belongs
+tgbot::utils::StringPool::Slot *tgbot::utils::StringPool::find(std::uint64_t hash,
+                                                               const char *data,
+                                                               std::size_t size) {
+	const std::size_t mask = slots.size() - 1;
+
+	for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+		Slot &slot = slots[i];
+		if (!slot.string) return &slot;
+
+		if (slot.hash == hash && slot.string->size() == size &&
+		    !std::memcmp(slot.string->data(), data, size))
+			return &slot;
+	}
+}
+
+// drops strings only the pool references, rehashing the others
+std::size_t tgbot::utils::StringPool::sweep() {
+	std::vector<Slot> previous(slots.size());
+	previous.swap(slots);
+
+	const std::size_t before = used;
+	used = 0;
+
+	for (Slot &slot : previous) {
+		if (!slot.string || slot.string.use_count() == 1) continue;
+
+		*find(slot.hash, slot.string->data(), slot.string->size()) = std::move(slot);
+		++used;
+	}
+
+	strings.sub(static_cast<std::int64_t>(before - used));
+	return before - used;
+}
@@ -2,12 +2,16 @@
 #include <ctime>
 
 std::string tgbot::utils::get_current_time(const std::string &format) {
-	const std::time_t current_time = std::time(nullptr);
-	const std::tm *local = std::localtime(&current_time);
+	return format_time(std::time(nullptr), format);
+}
+
+std::string tgbot::utils::format_time(std::time_t when,
+                                      const std::string &format) {
+	std::tm local;
 
-	if (local) {
+	if (localtime_r(&when, &local)) {
 		char timebuf[100];
-		if (std::strftime(timebuf, 100, format.c_str(), local))
+		if (std::strftime(timebuf, 100, format.c_str(), &local))
 			return timebuf;
 		else
 			return "clock: bad result";
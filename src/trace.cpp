@@ -0,0 +1,187 @@
+#include <tgbot/trace.h>
+#include <tgbot/utils/encode.h>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+using namespace tgbot::trace;
+
+static std::atomic<bool> tracing{false};
+static std::atomic<std::uint64_t> lastId{0};
+static thread_local Context currentContext;
+
+// ring of finished spans
+static std::mutex spansMutex;
+static std::vector<Span> ring;
+static std::size_t ringCapacity{0};
+static std::size_t ringNext{0};
+
+void tgbot::trace::enable(std::size_t capacity) {
+	{
+		std::lock_guard<std::mutex> guard(spansMutex);
+		if (capacity != ringCapacity) {
+			ring.clear();
+			ring.reserve(capacity);
+			ringCapacity = capacity;
+			ringNext = 0;
+		}
+	}
+
+	tracing.store(capacity != 0, std::memory_order_release);
+}
+
+void tgbot::trace::disable() {
+	tracing.store(false, std::memory_order_release);
+}
+
+bool tgbot::trace::enabled() {
+	return tracing.load(std::memory_order_relaxed);
+}
+
+std::uint64_t tgbot::trace::newId() {
+	return lastId.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+Context tgbot::trace::current() { return currentContext; }
+
+void tgbot::trace::record(Span span) {
+	if (!enabled()) return;
+
+	std::lock_guard<std::mutex> guard(spansMutex);
+	if (!ringCapacity) return;
+
+	if (ring.size() < ringCapacity)
+		ring.push_back(std::move(span));
+	else
+		ring[ringNext] = std::move(span);
+
+	ringNext = (ringNext + 1) % ringCapacity;
+}
+
+std::vector<Span> tgbot::trace::spans() {
+	std::lock_guard<std::mutex> guard(spansMutex);
+
+	if (ring.size() < ringCapacity) return ring;
+
+	std::vector<Span> ordered(ring.begin() + ringNext, ring.end());
+	ordered.insert(ordered.end(), ring.begin(), ring.begin() + ringNext);
+	return ordered;
+}
+
+void tgbot::trace::clear() {
+	std::lock_guard<std::mutex> guard(spansMutex);
+	ring.clear();
+	ringNext = 0;
+}
+
+static inline long long microsBetween(Clock::time_point from,
+                                      Clock::time_point to) {
+	return std::chrono::duration_cast<std::chrono::microseconds>(to - from)
+			.count();
+}
+
+void tgbot::trace::writeChromeTrace(std::ostream &out) {
+	const std::vector<Span> &collected = spans();
+
+	Clock::time_point origin = Clock::time_point::max();
+	std::unordered_map<std::uint64_t, Clock::time_point> starts;
+	for (auto const &span : collected) {
+		if (span.start < origin) origin = span.start;
+		starts.emplace(span.spanId, span.start);
+	}
+
+	out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+	bool first = true;
+	for (auto const &span : collected) {
+		if (!first) out << ',';
+		first = false;
+
+		out << "\n{\"name\":";
+		tgbot::utils::encodeJson(out, span.name);
+		out << ",\"cat\":\"tgbot\",\"ph\":\"X\",\"pid\":1"
+		    << ",\"tid\":" << span.traceId
+		    << ",\"ts\":" << microsBetween(origin, span.start)
+		    << ",\"dur\":" << microsBetween(span.start, span.end)
+		    << ",\"args\":{\"trace_id\":" << span.traceId
+		    << ",\"span_id\":" << span.spanId
+		    << ",\"parent_id\":" << span.parentId;
+
+		if (!span.detail.empty()) {
+			out << ",\"detail\":";
+			tgbot::utils::encodeJson(out, span.detail);
+		}
+
+		if (span.link)
+			out << ",\"link_trace_id\":" << span.link.traceId
+			    << ",\"link_span_id\":" << span.link.spanId;
+
+		out << "}}";
+
+		// arrow from the linked span, if still collected
+		const auto linked = starts.find(span.link.spanId);
+		if (span.link && linked != starts.end())
+			out << ",\n{\"name\":\"link\",\"cat\":\"tgbot\",\"ph\":\"s\",\"pid\":1"
+			    << ",\"tid\":" << span.link.traceId
+			    << ",\"ts\":" << microsBetween(origin, linked->second)
+			    << ",\"id\":" << span.spanId
+			    << "},\n{\"name\":\"link\",\"cat\":\"tgbot\",\"ph\":\"f\",\"bp\":\"e\",\"pid\":1"
+			    << ",\"tid\":" << span.traceId
+			    << ",\"ts\":" << microsBetween(origin, span.start)
+			    << ",\"id\":" << span.spanId << '}';
+	}
+
+	out << "\n]}\n";
+}
+
+void tgbot::trace::writeChromeTrace(const std::string &path) {
+	std::ofstream out(path);
+	if (!out) throw std::runtime_error("cannot open " + path);
+
+	writeChromeTrace(out);
+
+	if (!out) throw std::runtime_error("cannot write " + path);
+}
+
+tgbot::trace::ScopedSpan::ScopedSpan(const char *_name,
+                                     const std::string &_detail) {
+	if (!enabled()) return;
+
+	Context parent = currentContext;
+	if (!parent) parent.traceId = newId();
+
+	open(_name, parent, _detail);
+}
+
+tgbot::trace::ScopedSpan::ScopedSpan(const char *_name, const Context &parent,
+                                     const std::string &_detail) {
+	if (!enabled() || !parent) return;
+
+	open(_name, parent, _detail);
+}
+
+void tgbot::trace::ScopedSpan::open(const char *_name, const Context &parent,
+                                    const std::string &_detail) {
+	active = true;
+	previous = currentContext;
+
+	span.name = _name;
+	span.detail = _detail;
+	span.traceId = parent.traceId;
+	span.parentId = parent.spanId;
+	span.spanId = newId();
+	span.start = Clock::now();
+
+	currentContext.traceId = span.traceId;
+	currentContext.spanId = span.spanId;
+}
+
+tgbot::trace::ScopedSpan::~ScopedSpan() {
+	if (!active) return;
+
+	currentContext = previous;
+	span.end = Clock::now();
+	record(std::move(span));
+}
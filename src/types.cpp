@@ -1,5 +1,7 @@
 #include <json/json.h>
 #include <tgbot/types.h>
+#include <tgbot/utils/string_pool.h>
+#include <cstring>
 #include <sstream>
 #include <string>
 
@@ -8,85 +10,267 @@
 using ArrayIndex = Json::Value::ArrayIndex;
 using namespace tgbot::types;
 
+// member key of object, "" if missing: like object.get(key, ""), without
+// copying the whole member (nested objects included)
+static const Json::Value &member(const Json::Value &object, const char *key) {
+	static const Json::Value missing("");
+
+	const Json::Value *found = object.find(key, key + std::strlen(key));
+	return found ? *found : missing;
+}
+
+// string member of object, interned if pooling is enabled
+static SharedString sharedString(const Json::Value &object, const char *key) {
+	const char *begin;
+	const char *end;
+	if (!object[key].getString(&begin, &end)) return nullptr;
+
+	return tgbot::utils::StringPool::global().intern(
+			begin, static_cast<std::size_t>(end - begin));
+}
+
+// maps an update object key to the kind of update it carries,
+// returns false for keys not carrying a payload (e.g. update_id)
+static bool updateTypeOf(const char *key, const char *keyEnd,
+                         UpdateType &updateType) {
+	static const struct {
+		const char *key;
+		UpdateType updateType;
+	} kinds[] = {
+			{"message",              UpdateType::MESSAGE},
+			{"edited_message",       UpdateType::EDITED_MESSAGE},
+			{"callback_query",       UpdateType::CALLBACK_QUERY},
+			{"chosen_inline_result", UpdateType::CHOSEN_INLINE_RESULT},
+			{"inline_query",         UpdateType::INLINE_QUERY},
+			{"shipping_query",       UpdateType::SHIPPING_QUERY},
+			{"pre_checkout_query",   UpdateType::PRE_CHECKOUT_QUERY},
+			{"edited_channel_post",  UpdateType::EDITED_CHANNEL_POST},
+			{"channel_post",         UpdateType::CHANNEL_POST}
+	};
+
+	const std::size_t keyLength = keyEnd - key;
+	for (auto const &kind : kinds) {
+		if (std::strlen(kind.key) == keyLength &&
+		    !std::memcmp(kind.key, key, keyLength)) {
+			updateType = kind.updateType;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+const char *tgbot::types::updateTypeName(UpdateType updateType) noexcept {
+	switch (updateType) {
+		case UpdateType::MESSAGE:
+			return "message";
+		case UpdateType::EDITED_MESSAGE:
+			return "edited_message";
+		case UpdateType::EDITED_CHANNEL_POST:
+			return "edited_channel_post";
+		case UpdateType::INLINE_QUERY:
+			return "inline_query";
+		case UpdateType::CHOSEN_INLINE_RESULT:
+			return "chosen_inline_result";
+		case UpdateType::CALLBACK_QUERY:
+			return "callback_query";
+		case UpdateType::SHIPPING_QUERY:
+			return "shipping_query";
+		case UpdateType::PRE_CHECKOUT_QUERY:
+			return "pre_checkout_query";
+		case UpdateType::CHANNEL_POST:
+			return "channel_post";
+	}
+
+	return "unknown";
+}
+
 tgbot::types::Update::Update(const Json::Value &object)
-		: updateId(object.get("update_id", "").asInt()) {
-	if (object.isMember("message")) {
-		this->message = Ptr<Message>(new Message(object.get("message", "")));
-		this->updateType = UpdateType::MESSAGE;
-	} else if (object.isMember("edited_message")) {
-		this->editedMessage =
-				Ptr<Message>(new Message(object.get("edited_message", "")));
-		this->updateType = UpdateType::EDITED_MESSAGE;
-	} else if (object.isMember("callback_query")) {
-		this->callbackQuery =
-				Ptr<CallbackQuery>(new CallbackQuery(object.get("callback_query", "")));
-		this->updateType = UpdateType::CALLBACK_QUERY;
-	} else if (object.isMember("chosen_inline_result")) {
-		this->chosenInlineResult = Ptr<ChosenInlineResult>(
-				new ChosenInlineResult(object.get("chosen_inline_result", "")));
-		this->updateType = UpdateType::CHOSEN_INLINE_RESULT;
-	} else if (object.isMember("inline_query")) {
-		this->inlineQuery =
-				Ptr<InlineQuery>(new InlineQuery(object.get("inline_query", "")));
-		this->updateType = UpdateType::INLINE_QUERY;
-	} else if (object.isMember("shipping_query")) {
-		this->shippingQuery =
-				Ptr<ShippingQuery>(new ShippingQuery(object.get("shipping_query", "")));
-		this->updateType = UpdateType::SHIPPING_QUERY;
-	} else if (object.isMember("pre_checkout_query")) {
-		this->preCheckoutQuery = Ptr<PreCheckoutQuery>(
-				new PreCheckoutQuery(object.get("pre_checkout_query", "")));
-		this->updateType = UpdateType::PRE_CHECKOUT_QUERY;
-	} else if (object.isMember("edited_channel_post")) {
-		this->editedChannelPost =
-				Ptr<Message>(new Message(object.get("edited_channel_post", "")));
-		this->updateType = UpdateType::EDITED_CHANNEL_POST;
-	} else if (object.isMember("channel_post")) {
-		this->channelPost =
-				Ptr<Message>(new Message(object.get("channel_post", "")));
-		this->updateType = UpdateType::CHANNEL_POST;
+		: updateId(member(object, "update_id").asInt()) {
+	for (auto it = object.begin(); it != object.end(); ++it) {
+		const char *keyEnd;
+		const char *key = it.memberName(&keyEnd);
+
+		if (!updateTypeOf(key, keyEnd, this->updateType)) continue;
+
+		switch (this->updateType) {
+			case UpdateType::MESSAGE:
+			case UpdateType::EDITED_MESSAGE:
+			case UpdateType::CHANNEL_POST:
+			case UpdateType::EDITED_CHANNEL_POST:
+				::new(&__message) Message(*it);
+				break;
+			case UpdateType::INLINE_QUERY:
+				::new(&__inlineQuery) InlineQuery(*it);
+				break;
+			case UpdateType::CHOSEN_INLINE_RESULT:
+				::new(&__chosenInlineResult) ChosenInlineResult(*it);
+				break;
+			case UpdateType::CALLBACK_QUERY:
+				::new(&__callbackQuery) CallbackQuery(*it);
+				break;
+			case UpdateType::SHIPPING_QUERY:
+				::new(&__shippingQuery) ShippingQuery(*it);
+				break;
+			case UpdateType::PRE_CHECKOUT_QUERY:
+				::new(&__preCheckoutQuery) PreCheckoutQuery(*it);
+				break;
+		}
+
+		__hasPayload = true;
+		break;
+	}
+}
+
+tgbot::types::Update::Update(Update &&other) noexcept
+		: updateType(other.updateType), updateId(other.updateId) {
+	movePayload(other);
+}
+
+Update &tgbot::types::Update::operator=(Update &&other) noexcept {
+	if (this != &other) {
+		destroyPayload();
+		updateType = other.updateType;
+		updateId = other.updateId;
+		movePayload(other);
+	}
+
+	return *this;
+}
+
+tgbot::types::Update::~Update() { destroyPayload(); }
+
+void tgbot::types::Update::movePayload(Update &other) noexcept {
+	if (!other.__hasPayload) return;
+
+	switch (updateType) {
+		case UpdateType::MESSAGE:
+		case UpdateType::EDITED_MESSAGE:
+		case UpdateType::CHANNEL_POST:
+		case UpdateType::EDITED_CHANNEL_POST:
+			::new(&__message) Message(std::move(other.__message));
+			break;
+		case UpdateType::INLINE_QUERY:
+			::new(&__inlineQuery) InlineQuery(std::move(other.__inlineQuery));
+			break;
+		case UpdateType::CHOSEN_INLINE_RESULT:
+			::new(&__chosenInlineResult)
+					ChosenInlineResult(std::move(other.__chosenInlineResult));
+			break;
+		case UpdateType::CALLBACK_QUERY:
+			::new(&__callbackQuery) CallbackQuery(std::move(other.__callbackQuery));
+			break;
+		case UpdateType::SHIPPING_QUERY:
+			::new(&__shippingQuery) ShippingQuery(std::move(other.__shippingQuery));
+			break;
+		case UpdateType::PRE_CHECKOUT_QUERY:
+			::new(&__preCheckoutQuery)
+					PreCheckoutQuery(std::move(other.__preCheckoutQuery));
+			break;
 	}
+
+	__hasPayload = true;
 }
 
+void tgbot::types::Update::destroyPayload() noexcept {
+	if (!__hasPayload) return;
+
+	switch (updateType) {
+		case UpdateType::MESSAGE:
+		case UpdateType::EDITED_MESSAGE:
+		case UpdateType::CHANNEL_POST:
+		case UpdateType::EDITED_CHANNEL_POST:
+			__message.~Message();
+			break;
+		case UpdateType::INLINE_QUERY:
+			__inlineQuery.~InlineQuery();
+			break;
+		case UpdateType::CHOSEN_INLINE_RESULT:
+			__chosenInlineResult.~ChosenInlineResult();
+			break;
+		case UpdateType::CALLBACK_QUERY:
+			__callbackQuery.~CallbackQuery();
+			break;
+		case UpdateType::SHIPPING_QUERY:
+			__shippingQuery.~ShippingQuery();
+			break;
+		case UpdateType::PRE_CHECKOUT_QUERY:
+			__preCheckoutQuery.~PreCheckoutQuery();
+			break;
+	}
+
+	__hasPayload = false;
+}
+
+#define UPDATE_PAYLOAD(accessor, type, kind, member)                     \
+  type *tgbot::types::Update::accessor() noexcept {                      \
+    return (__hasPayload && updateType == kind) ? &member : nullptr;     \
+  }                                                                      \
+  const type *tgbot::types::Update::accessor() const noexcept {          \
+    return (__hasPayload && updateType == kind) ? &member : nullptr;     \
+  }
+
+UPDATE_PAYLOAD(message, Message, UpdateType::MESSAGE, __message)
+UPDATE_PAYLOAD(editedMessage, Message, UpdateType::EDITED_MESSAGE, __message)
+UPDATE_PAYLOAD(channelPost, Message, UpdateType::CHANNEL_POST, __message)
+UPDATE_PAYLOAD(editedChannelPost, Message, UpdateType::EDITED_CHANNEL_POST,
+               __message)
+UPDATE_PAYLOAD(inlineQuery, InlineQuery, UpdateType::INLINE_QUERY,
+               __inlineQuery)
+UPDATE_PAYLOAD(chosenInlineResult, ChosenInlineResult,
+               UpdateType::CHOSEN_INLINE_RESULT, __chosenInlineResult)
+UPDATE_PAYLOAD(callbackQuery, CallbackQuery, UpdateType::CALLBACK_QUERY,
+               __callbackQuery)
+UPDATE_PAYLOAD(shippingQuery, ShippingQuery, UpdateType::SHIPPING_QUERY,
+               __shippingQuery)
+UPDATE_PAYLOAD(preCheckoutQuery, PreCheckoutQuery,
+               UpdateType::PRE_CHECKOUT_QUERY, __preCheckoutQuery)
+
+#undef UPDATE_PAYLOAD
+
 tgbot::types::Message::Message(const Json::Value &object)
-		: chat(object.get("chat", "")),
-		  messageId(object.get("message_id", "").asInt()),
-		  date(object.get("date", "").asInt()) {
+		: chat(member(object, "chat")),
+		  messageId(member(object, "message_id").asInt()),
+		  date(member(object, "date").asInt()) {
+	const auto extra = [this]() -> MessageExtras & {
+		if (!extras) extras = Ptr<MessageExtras>(new MessageExtras);
+		return *extras;
+	};
+
 	if (object.isMember("connected_website", ""))
-		this->connectedWebsite = Ptr<std::string>(
-				new std::string(object.get("connected_website", "").asCString()));
+		extra().connectedWebsite = Ptr<std::string>(
+				new std::string(member(object, "connected_website").asCString()));
 
 	if (object.isMember("caption_entities")) {
 		this->captionEntities =
 				Ptr<std::vector<MessageEntity>>(new std::vector<MessageEntity>{});
 
-		for (auto const &singleCaptionEntity : object.get("caption_entities", ""))
+		for (auto const &singleCaptionEntity : member(object, "caption_entities"))
 			this->captionEntities->emplace_back(singleCaptionEntity);
 	}
 
 	if (object.isMember("migrate_to_chat_id"))
-		this->migrateToChatId = object.get("migrate_to_chat_id", "").asInt64();
+		extra().migrateToChatId = member(object, "migrate_to_chat_id").asInt64();
 
 	if (object.isMember("migrate_from_chat_id"))
-		this->migrateFromChatId = object.get("migrate_from_chat_id", "").asInt64();
+		extra().migrateFromChatId = member(object, "migrate_from_chat_id").asInt64();
 
 	if (object.isMember("entities")) {
 		this->entities =
 				Ptr<std::vector<MessageEntity>>(new std::vector<MessageEntity>{});
 
-		for (auto const &singleEntity : object.get("entities", ""))
+		for (auto const &singleEntity : member(object, "entities"))
 			this->entities->emplace_back(singleEntity);
 	}
 
 	if (object.isMember("caption"))
-		this->caption = Ptr<std::string>(
-				new std::string(object.get("caption", "").asCString()));
+		this->caption.emplace(member(object, "caption").asCString());
 
 	// we may have just entered a new chat
 
 	if (object.isMember("reply_to_message")) {
 		this->replyToMessage =
-				Ptr<Message>(new Message(object.get("reply_to_message", "")));
+				Ptr<Message>(new Message(member(object, "reply_to_message")));
 		if (object.isMember("supergroup_chat_created"))
 			this->supergroupChatCreated = true;
 
@@ -99,11 +283,11 @@ tgbot::types::Message::Message(const Json::Value &object)
 	// is the message sent from user or channel?
 
 	if (object.isMember("from"))
-		this->from = Ptr<User>(new User(object.get("from", "")));
+		this->from = Ptr<User>(new User(member(object, "from")));
 	else {
 		if (object.isMember("author_signature"))
-			this->authorSignature = Ptr<std::string>(
-					new std::string(object.get("author_signature", "").asCString()));
+			extra().authorSignature = Ptr<std::string>(
+					new std::string(member(object, "author_signature").asCString()));
 	}
 
 	// end
@@ -111,81 +295,80 @@ tgbot::types::Message::Message(const Json::Value &object)
 	// forwarded messages
 
 	if (object.isMember("forward_date")) {
-		this->forwardDate = object.get("forward_date", "").asInt();
+		extra().forwardDate = member(object, "forward_date").asInt();
 		if (object.isMember("forward_from"))
-			this->forwardFrom = Ptr<User>(new User(object.get("forward_from", "")));
+			extra().forwardFrom = Ptr<User>(new User(member(object, "forward_from")));
 		else if (object.isMember("forward_from_chat")) {
-			this->forwardFromChat =
-					Ptr<Chat>(new Chat(object.get("forward_from_chat", "")));
+			extra().forwardFromChat =
+					Ptr<Chat>(new Chat(member(object, "forward_from_chat")));
 
-			this->forwardFromMessageId =
-					object.get("forward_from_message_id", "").asInt();
+			extra().forwardFromMessageId =
+					member(object, "forward_from_message_id").asInt();
 
 			if (object.isMember("forward_signature"))
-				this->forwardSignature = Ptr<std::string>(
-						new std::string(object.get("forward_signature", "").asCString()));
+				extra().forwardSignature = Ptr<std::string>(
+						new std::string(member(object, "forward_signature").asCString()));
 		}
 
 		if(object.isMember("forward_sender_name"))
-			this->forwardSenderName = Ptr<std::string>(
-					new std::string(object.get("forward_sender_name","").asCString()));
+			extra().forwardSenderName = Ptr<std::string>(
+					new std::string(member(object, "forward_sender_name").asCString()));
 	} else if (object.isMember("edit_date"))
-		this->editDate = object.get("edit_date", "").asInt();
+		this->editDate = member(object, "edit_date").asInt();
 
 	// end
 
 	// single message type
 
 	if (object.isMember("text"))
-		this->text =
-				Ptr<std::string>(new std::string(object.get("text", "").asCString()));
+		this->text.emplace(member(object, "text").asCString());
 
 	else if (object.isMember("audio"))
-		this->audio = Ptr<Audio>(new Audio(object.get("audio", "")));
+		extra().audio = Ptr<Audio>(new Audio(member(object, "audio")));
 
 	else if (object.isMember("document"))
-		this->document = Ptr<Document>(new Document(object.get("document", "")));
+		extra().document = Ptr<Document>(new Document(member(object, "document")));
 
 	else if (object.isMember("game"))
-		this->game = Ptr<Game>(new Game(object.get("game", "")));
+		extra().game = Ptr<Game>(new Game(member(object, "game")));
 
 	else if (object.isMember("sticker"))
-		this->sticker = Ptr<Sticker>(new Sticker(object.get("sticker", "")));
+		extra().sticker = Ptr<Sticker>(new Sticker(member(object, "sticker")));
 
 	else if (object.isMember("video"))
-		this->video = Ptr<Video>(new Video(object.get("video", "")));
+		extra().video = Ptr<Video>(new Video(member(object, "video")));
 
 	else if (object.isMember("video_note"))
-		this->videoNote =
-				Ptr<VideoNote>(new VideoNote(object.get("video_note", "")));
+		extra().videoNote =
+				Ptr<VideoNote>(new VideoNote(member(object, "video_note")));
 
 	else if (object.isMember("animation"))
-		this->animation =
-				Ptr<Animation>(new Animation(object.get("animation","")));
+		extra().animation =
+				Ptr<Animation>(new Animation(member(object, "animation")));
 
 	else if (object.isMember("invoice"))
-		this->invoice = Ptr<Invoice>(new Invoice(object.get("invoice", "")));
+		extra().invoice = Ptr<Invoice>(new Invoice(member(object, "invoice")));
 
 	else if (object.isMember("successful_payment"))
-		this->successfulPayment = Ptr<SuccessfulPayment>(
-				new SuccessfulPayment(object.get("successful_payment", "")));
+		extra().successfulPayment = Ptr<SuccessfulPayment>(
+				new SuccessfulPayment(member(object, "successful_payment")));
 
 	else if (object.isMember("contact"))
-		this->contact = Ptr<Contact>(new Contact(object.get("contact", "")));
+		extra().contact = Ptr<Contact>(new Contact(member(object, "contact")));
 
 	else if (object.isMember("location"))
-		this->location = Ptr<Location>(new Location(object.get("location", "")));
+		extra().location = Ptr<Location>(new Location(member(object, "location")));
 
 	else if (object.isMember("venue"))
-		this->venue = Ptr<Venue>(new Venue(object.get("venue", "")));
+		extra().venue = Ptr<Venue>(new Venue(member(object, "venue")));
 
 	else if (object.isMember("poll"))
-		this->poll = Ptr<Poll>(new Poll(object.get("poll","")));
+		extra().poll = Ptr<Poll>(new Poll(member(object, "poll")));
 
 	else if (object.isMember("photo")) {
 		this->photo = Ptr<std::vector<PhotoSize>>(new std::vector<PhotoSize>{});
 
-		for (auto const &singlePhoto : object.get("photo", ""))
+		for (auto const &singlePhoto : member(object, "photo"))
 			this->photo->emplace_back(singlePhoto);
 	} else {
 		if (object.isMember("delete_chat_photo"))
@@ -195,98 +378,113 @@ tgbot::types::Message::Message(const Json::Value &object)
 			this->groupChatCreated = true;
 
 		else if (object.isMember("left_chat_member"))
-			this->leftChatMember =
-					Ptr<User>(new User(object.get("left_chat_member", "")));
+			extra().leftChatMember =
+					Ptr<User>(new User(member(object, "left_chat_member")));
 
 		else if (object.isMember("new_chat_title"))
-			this->newChatTitle = Ptr<std::string>(
-					new std::string(object.get("new_chat_title", "").asCString()));
+			extra().newChatTitle = Ptr<std::string>(
+					new std::string(member(object, "new_chat_title").asCString()));
 
 		else if (object.isMember("pinned_message"))
-			this->pinnedMessage =
-					Ptr<Message>(new Message(object.get("pinned_message", "")));
+			extra().pinnedMessage =
+					Ptr<Message>(new Message(member(object, "pinned_message")));
 
 		else if (object.isMember("new_chat_photo")) {
-			this->newChatPhoto =
+			extra().newChatPhoto =
 					Ptr<std::vector<PhotoSize>>(new std::vector<PhotoSize>{});
 
-			for (auto const &singlePhoto : object.get("new_chat_photo", ""))
-				this->newChatPhoto->emplace_back(singlePhoto);
+			for (auto const &singlePhoto : member(object, "new_chat_photo"))
+				extras->newChatPhoto->emplace_back(singlePhoto);
 		} else if (object.isMember("new_chat_members")) {
-			this->newChatMembers = Ptr<std::vector<User>>(new std::vector<User>{});
+			extra().newChatMembers = Ptr<std::vector<User>>(new std::vector<User>{});
 
-			for (auto const &singleUser : object.get("new_chat_members", ""))
-				this->newChatMembers->emplace_back(singleUser);
+			for (auto const &singleUser : member(object, "new_chat_members"))
+				extras->newChatMembers->emplace_back(singleUser);
 		}
 	}
 
 	// end
 }
 
+// rarely present members belong in MessageExtras: Message must stay smaller
+// than with every optional member behind a Ptr (408 bytes on LP64)
+static_assert(sizeof(void *) != 8 || sizeof(Message) <= 408,
+              "Message grew: move rarely present members to MessageExtras");
+
+const MessageExtras &tgbot::types::Message::extrasOrEmpty() const noexcept {
+	static const MessageExtras none;
+	return extras ? *extras : none;
+}
+
 tgbot::types::CallbackQuery::CallbackQuery(const Json::Value &object)
-		: from(object.get("from", "")),
-		  id(object.get("id", "").asCString()),
-		  chatInstance(object.get("chat_instance", "").asCString()) {
+		: from(member(object, "from")),
+		  id(member(object, "id").asCString()),
+		  chatInstance(member(object, "chat_instance").asCString()) {
 	if (object.isMember("message"))
-		this->message = Ptr<Message>(new Message(object.get("message", "")));
+		this->message = Ptr<Message>(new Message(member(object, "message")));
 
 	if (object.isMember("inline_message_id"))
 		this->inlineMessageId = Ptr<std::string>(
-				new std::string(object.get("inline_message_id", "").asCString()));
+				new std::string(member(object, "inline_message_id").asCString()));
 
 	if (object.isMember("data"))
 		this->data =
-				Ptr<std::string>(new std::string(object.get("data", "").asCString()));
+				Ptr<std::string>(new std::string(member(object, "data").asCString()));
 
 	if (object.isMember("game_short_name"))
 		this->gameShortName = Ptr<std::string>(
-				new std::string(object.get("game_short_name", "").asCString()));
+				new std::string(member(object, "game_short_name").asCString()));
 }
 
 tgbot::types::ChosenInlineResult::ChosenInlineResult(const Json::Value &object)
-		: from(object.get("from", "")),
-		  resultId(object.get("result_id", "").asCString()),
-		  query(object.get("query", "").asCString()) {
+		: from(member(object, "from")),
+		  resultId(member(object, "result_id").asCString()),
+		  query(member(object, "query").asCString()) {
 	if (object.isMember("location"))
-		this->location = Ptr<Location>(new Location(object.get("location", "")));
+		this->location = Ptr<Location>(new Location(member(object, "location")));
 
 	if (object.isMember("inline_message_id"))
 		this->inlineMessageId = Ptr<std::string>(
-				new std::string(object.get("inline_message_id", "").asCString()));
+				new std::string(member(object, "inline_message_id").asCString()));
 }
 
 tgbot::types::InlineQuery::InlineQuery(const Json::Value &object)
-		: from(object.get("from", "")),
-		  id(object.get("id", "").asCString()),
-		  query(object.get("query", "").asCString()),
-		  offset(object.get("offset", "").asCString()) {
+		: from(member(object, "from")),
+		  id(member(object, "id").asCString()),
+		  query(member(object, "query").asCString()),
+		  offset(member(object, "offset").asCString()) {
 	if (object.isMember("location"))
-		this->location = Ptr<Location>(new Location(object.get("location", "")));
+		this->location = Ptr<Location>(new Location(member(object, "location")));
 }
 
 tgbot::types::ShippingQuery::ShippingQuery(const Json::Value &object)
-		: shippingAddress(object.get("shipping_address", "")),
-		  from(object.get("from", "")),
-		  id(object.get("id", "").asCString()),
-		  invoicePayload(object.get("invoice_payload", "").asCString()) {}
+		: shippingAddress(member(object, "shipping_address")),
+		  from(member(object, "from")),
+		  id(member(object, "id").asCString()),
+		  invoicePayload(member(object, "invoice_payload").asCString()) {}
 
 tgbot::types::PreCheckoutQuery::PreCheckoutQuery(const Json::Value &object)
-		: from(object.get("from", "")),
-		  currency(object.get("currency", "").asCString()),
-		  invoicePayload(object.get("invoice_payload", "").asCString()),
-		  id(object.get("id", "").asCString()),
-		  totalAmount(object.get("total_amount", "").asInt()) {
+		: from(member(object, "from")),
+		  currency(member(object, "currency").asCString()),
+		  invoicePayload(member(object, "invoice_payload").asCString()),
+		  id(member(object, "id").asCString()),
+		  totalAmount(member(object, "total_amount").asInt()) {
 	if (object.isMember("shipping_option_id"))
 		this->shippingOptionId = Ptr<std::string>(
-				new std::string(object.get("shipping_option_id", "").asCString()));
+				new std::string(member(object, "shipping_option_id").asCString()));
 
 	if (object.isMember("order_info"))
 		this->orderInfo =
-				Ptr<OrderInfo>(new OrderInfo(object.get("order_info", "")));
+				Ptr<OrderInfo>(new OrderInfo(member(object, "order_info")));
 }
 
-tgbot::types::Chat::Chat(const Json::Value &object) {
-	const std::string &chatType = object.get("type", "").asCString();
+tgbot::types::Chat::Chat(const Json::Value &object)
+		: allMembersAreAdministrators(false),
+		  canSetStickerSet(false),
+		  __hasTitle(object.isMember("title")),
+		  __hasUsername(object.isMember("username")),
+		  __hasFirstName(object.isMember("first_name")) {
+	const std::string &chatType = member(object, "type").asCString();
 	if (chatType == "private")
 		this->type = ChatType::PRIVATE;
 	else if (chatType == "supergroup")
@@ -296,276 +494,263 @@ tgbot::types::Chat::Chat(const Json::Value &object) {
 	else if (chatType == "channel")
 		this->type = ChatType::CHANNEL;
 
-	id = object.get("id", "").asInt64();
+	id = member(object, "id").asInt64();
 
 	if (this->type != ChatType::PRIVATE &&
 	    object.isMember("all_members_are_administrators"))
 		this->allMembersAreAdministrators = true;
 
-	if (object.isMember("title"))
-		this->title =
-				Ptr<std::string>(new std::string(object.get("title", "").asCString()));
+	if (__hasTitle) __title = member(object, "title").asCString();
 
-	if (object.isMember("username"))
-		this->username = Ptr<std::string>(
-				new std::string(object.get("username", "").asCString()));
+	if (__hasUsername) __username = member(object, "username").asCString();
 
-	if (object.isMember("first_name"))
-		this->firstName = Ptr<std::string>(
-				new std::string(object.get("first_name", "").asCString()));
+	if (__hasFirstName) __firstName = member(object, "first_name").asCString();
 
 	if (object.isMember("last_name"))
 		this->lastName = Ptr<std::string>(
-				new std::string(object.get("last_name", "").asCString()));
+				new std::string(member(object, "last_name").asCString()));
 
 	if (object.isMember("description"))
 		this->description = Ptr<std::string>(
-				new std::string(object.get("description", "").asCString()));
+				new std::string(member(object, "description").asCString()));
 
 	if (object.isMember("invite_link"))
 		this->inviteLink = Ptr<std::string>(
-				new std::string(object.get("invite_link", "").asCString()));
+				new std::string(member(object, "invite_link").asCString()));
 
 	if (object.isMember("pinned_message"))
 		this->pinnedMessage =
-				Ptr<Message>(new Message(object.get("pinned_message", "")));
+				Ptr<Message>(new Message(member(object, "pinned_message")));
 
 	if (object.isMember("photo"))
-		this->photo = Ptr<ChatPhoto>(new ChatPhoto(object.get("photo", "")));
+		this->photo = Ptr<ChatPhoto>(new ChatPhoto(member(object, "photo")));
 
 	if (object.isMember("sticker_set_name"))
-		this->stickerSetName = Ptr<std::string>(
-				new std::string(object.get("sticker_set_name", "").asCString()));
+		this->stickerSetName = sharedString(object, "sticker_set_name");
 
 	if (object.isMember("can_set_sticker_set"))
-		this->canSetStickerSet = object.get("can_set_sticker_set", "").asBool();
+		this->canSetStickerSet = member(object, "can_set_sticker_set").asBool();
 }
 
 tgbot::types::User::User(const Json::Value &object)
-		: firstName(object.get("first_name", "").asCString()),
-		  id(object.get("id", "").asInt()),
-		  isBot(object.get("is_bot", "").asBool()) {
+		: firstName(member(object, "first_name").asCString()),
+		  id(member(object, "id").asInt()),
+		  isBot(member(object, "is_bot").asBool()),
+		  __hasUsername(object.isMember("username")) {
+	if (__hasUsername) __username = member(object, "username").asCString();
+
 	if (object.isMember("last_name"))
 		this->lastName = Ptr<std::string>(
-				new std::string(object.get("last_name", "").asCString()));
-
-	if (object.isMember("username"))
-		this->username = Ptr<std::string>(
-				new std::string(object.get("username", "").asCString()));
+				new std::string(member(object, "last_name").asCString()));
 
 	if (object.isMember("language_code"))
 		this->languageCode = Ptr<std::string>(
-				new std::string(object.get("language_code", "").asCString()));
+				new std::string(member(object, "language_code").asCString()));
 }
 
 tgbot::types::ShippingAddress::ShippingAddress(const Json::Value &object)
-		: countryCode(object.get("country_code", "").asCString()),
-		  state(object.get("state", "").asCString()),
-		  city(object.get("city", "").asCString()),
-		  streetLineOne(object.get("street_line_one", "").asCString()),
-		  streetLineTwo(object.get("street_line_two", "").asCString()),
-		  postCode(object.get("post_code", "").asCString()) {}
+		: countryCode(member(object, "country_code").asCString()),
+		  state(member(object, "state").asCString()),
+		  city(member(object, "city").asCString()),
+		  streetLineOne(member(object, "street_line_one").asCString()),
+		  streetLineTwo(member(object, "street_line_two").asCString()),
+		  postCode(member(object, "post_code").asCString()) {}
 
 tgbot::types::ChatPhoto::ChatPhoto(const Json::Value &object)
-		: smallFileId(object.get("small_file_id", "").asCString()),
-		  bigFileId(object.get("big_file_id", "").asCString()) {}
+		: smallFileId(member(object, "small_file_id").asCString()),
+		  bigFileId(member(object, "big_file_id").asCString()) {}
 
 tgbot::types::Audio::Audio(const Json::Value &object)
-		: fileId(object.get("file_id", "").asCString()),
-		  duration(object.get("duration", "").asInt()) {
+		: fileId(member(object, "file_id").asCString()),
+		  duration(member(object, "duration").asInt()) {
 	if (object.isMember("file_size"))
-		this->fileSize = object.get("file_size", "").asInt();
+		this->fileSize = member(object, "file_size").asInt();
 
 	if (object.isMember("performer"))
 		this->performer = Ptr<std::string>(
-				new std::string(object.get("performer", "").asCString()));
+				new std::string(member(object, "performer").asCString()));
 
 	if (object.isMember("title"))
 		this->title =
-				Ptr<std::string>(new std::string(object.get("title", "").asCString()));
+				Ptr<std::string>(new std::string(member(object, "title").asCString()));
 
 	if (object.isMember("mime_type"))
-		this->mimeType = Ptr<std::string>(
-				new std::string(object.get("mime_type", "").asCString()));
+		this->mimeType = sharedString(object, "mime_type");
 
 	if(object.isMember("thumb"))
 		this->thumb = Ptr<PhotoSize>(
-				new PhotoSize(object.get("thumb","")));
+				new PhotoSize(member(object, "thumb")));
 }
 
 tgbot::types::Document::Document(const Json::Value &object)
-		: fileId(object.get("file_id", "").asCString()) {
+		: fileId(member(object, "file_id").asCString()) {
 	if (object.isMember("thumb"))
-		this->thumb = Ptr<PhotoSize>(new PhotoSize(object.get("thumb", "")));
+		this->thumb = Ptr<PhotoSize>(new PhotoSize(member(object, "thumb")));
 
 	if (object.isMember("file_name"))
 		this->fileName = Ptr<std::string>(
-				new std::string(object.get("file_name", "").asCString()));
+				new std::string(member(object, "file_name").asCString()));
 
 	if (object.isMember("mime_type"))
-		this->mimeType = Ptr<std::string>(
-				new std::string(object.get("mime_type", "").asCString()));
+		this->mimeType = sharedString(object, "mime_type");
 
 	if (object.isMember("file_size"))
-		this->fileSize = object.get("file_size", "").asInt();
+		this->fileSize = member(object, "file_size").asInt();
 }
 
 tgbot::types::PhotoSize::PhotoSize(const Json::Value &object)
-		: fileId(object.get("file_id", "").asCString()),
-		  width(object.get("width", "").asInt()),
-		  height(object.get("height", "").asInt()) {
+		: fileId(member(object, "file_id").asCString()),
+		  width(member(object, "width").asInt()),
+		  height(member(object, "height").asInt()) {
 	if (object.isMember("file_size"))
-		this->fileSize = object.get("file_size", "").asInt();
+		this->fileSize = member(object, "file_size").asInt();
 }
 
 tgbot::types::Game::Game(const Json::Value &object)
-		: title(object.get("title", "").asCString()),
-		  description(object.get("description", "").asCString()),
+		: title(member(object, "title").asCString()),
+		  description(member(object, "description").asCString()),
 		  photo({}) {
-	for (auto const &singlePhoto : object.get("photo", ""))
+	for (auto const &singlePhoto : member(object, "photo"))
 		this->photo.emplace_back(singlePhoto);
 
 	if (object.isMember("animation"))
 		this->animation =
-				Ptr<Animation>(new Animation(object.get("animation", "")));
+				Ptr<Animation>(new Animation(member(object, "animation")));
 
 	if (object.isMember("text_entities")) {
 		this->textEntities =
 				Ptr<std::vector<MessageEntity>>(new std::vector<MessageEntity>{});
 
-		for (auto const &singleEntity : object.get("text_entities", ""))
+		for (auto const &singleEntity : member(object, "text_entities"))
 			this->textEntities->emplace_back(singleEntity);
 	}
 
 	if (object.isMember("text"))
 		this->text =
-				Ptr<std::string>(new std::string(object.get("text", "").asCString()));
+				Ptr<std::string>(new std::string(member(object, "text").asCString()));
 }
 
 tgbot::types::MaskPosition::MaskPosition(const Json::Value &object)
-		: point(object.get("point", "").asCString()),
-		  xShift(object.get("x_shift", "").asDouble()),
-		  yShift(object.get("y_shift", "").asDouble()),
-		  scale(object.get("scale", "").asDouble()) {}
+		: point(member(object, "point").asCString()),
+		  xShift(member(object, "x_shift").asDouble()),
+		  yShift(member(object, "y_shift").asDouble()),
+		  scale(member(object, "scale").asDouble()) {}
 
 tgbot::types::Sticker::Sticker(const Json::Value &object)
-		: fileId(object.get("file_id", "").asCString()),
-		  width(object.get("width", "").asInt()),
-		  height(object.get("height", "").asInt()),
-		  fileSize(object.get("file_size", "").asInt()) {
+		: fileId(member(object, "file_id").asCString()),
+		  width(member(object, "width").asInt()),
+		  height(member(object, "height").asInt()),
+		  fileSize(member(object, "file_size").asInt()) {
 	if (object.isMember("thumb"))
-		this->thumb = Ptr<PhotoSize>(new PhotoSize(object.get("thumb", "")));
+		this->thumb = Ptr<PhotoSize>(new PhotoSize(member(object, "thumb")));
 
 	if (object.isMember("emoji"))
 		this->emoji =
-				Ptr<std::string>(new std::string(object.get("emoji", "").asCString()));
+				Ptr<std::string>(new std::string(member(object, "emoji").asCString()));
 
 	if (object.isMember("set_name"))
-		this->setName = Ptr<std::string>(
-				new std::string(object.get("set_name", "").asCString()));
+		this->setName = sharedString(object, "set_name");
 
 	if (object.isMember("mask_position"))
 		this->maskPosition =
-				Ptr<MaskPosition>(new MaskPosition(object.get("mask_position", "")));
+				Ptr<MaskPosition>(new MaskPosition(member(object, "mask_position")));
 
 	if (object.isMember("file_size"))
-		this->fileSize = object.get("file_size", "").asInt();
+		this->fileSize = member(object, "file_size").asInt();
 }
 
 tgbot::types::Video::Video(const Json::Value &object)
-		: fileId(object.get("file_id", "").asCString()),
-		  width(object.get("width", "").asInt()),
-		  height(object.get("height", "").asInt()),
-		  duration(object.get("duration", "").asInt()) {
+		: fileId(member(object, "file_id").asCString()),
+		  width(member(object, "width").asInt()),
+		  height(member(object, "height").asInt()),
+		  duration(member(object, "duration").asInt()) {
 	if (object.isMember("file_size"))
-		this->fileSize = object.get("file_size", "").asInt();
+		this->fileSize = member(object, "file_size").asInt();
 
 	if (object.isMember("thumb"))
-		this->thumb = Ptr<PhotoSize>(new PhotoSize(object.get("thumb", "")));
+		this->thumb = Ptr<PhotoSize>(new PhotoSize(member(object, "thumb")));
 
 	if (object.isMember("mime_type"))
-		this->mimeType = Ptr<std::string>(
-				new std::string(object.get("mime_type", "").asCString()));
+		this->mimeType = sharedString(object, "mime_type");
 }
 
 tgbot::types::Voice::Voice(const Json::Value &object)
-		: fileId(object.get("file_id", "").asCString()),
-		  duration(object.get("duration", "").asInt()) {
+		: fileId(member(object, "file_id").asCString()),
+		  duration(member(object, "duration").asInt()) {
 	if (object.isMember("file_size"))
-		this->fileSize = object.get("file_size", "").asInt();
+		this->fileSize = member(object, "file_size").asInt();
 
 	if (object.isMember("mime_type"))
-		this->mimeType = Ptr<std::string>(
-				new std::string(object.get("mime_type", "").asCString()));
+		this->mimeType = sharedString(object, "mime_type");
 }
 
 tgbot::types::VideoNote::VideoNote(const Json::Value &object)
-		: fileId(object.get("file_id", "").asCString()),
-		  length(object.get("length", "").asInt()),
-		  duration(object.get("duration", "").asInt()) {
+		: fileId(member(object, "file_id").asCString()),
+		  length(member(object, "length").asInt()),
+		  duration(member(object, "duration").asInt()) {
 	if (object.isMember("file_size"))
-		this->fileSize = object.get("file_size", "").asInt();
+		this->fileSize = member(object, "file_size").asInt();
 
 	if (object.isMember("thumb"))
-		this->thumb = Ptr<PhotoSize>(new PhotoSize(object.get("thumb", "")));
+		this->thumb = Ptr<PhotoSize>(new PhotoSize(member(object, "thumb")));
 }
 
 tgbot::types::Contact::Contact(const Json::Value &object)
-		: phoneNumber(object.get("phone_number", "").asCString()),
-		  firstName(object.get("first_name", "").asCString()) {
+		: phoneNumber(member(object, "phone_number").asCString()),
+		  firstName(member(object, "first_name").asCString()) {
 	if (object.isMember("last_name"))
 		this->lastName = Ptr<std::string>(
-				new std::string(object.get("last_name", "").asCString()));
+				new std::string(member(object, "last_name").asCString()));
 
 	if (object.isMember("user_id"))
-		this->userId = object.get("user_id", "").asInt();
+		this->userId = member(object, "user_id").asInt();
 }
 
 tgbot::types::Location::Location(const Json::Value &object)
-		: longitude(object.get("longitude", "").asDouble()),
-		  latitude(object.get("latitude", "").asDouble()) {}
+		: longitude(member(object, "longitude").asDouble()),
+		  latitude(member(object, "latitude").asDouble()) {}
 
 tgbot::types::Venue::Venue(const Json::Value &object)
-		: location(object.get("location", "")),
-		  title(object.get("title", "").asCString()),
-		  address(object.get("address", "").asCString()) {
+		: location(member(object, "location")),
+		  title(member(object, "title").asCString()),
+		  address(member(object, "address").asCString()) {
 	if (object.isMember("foursquare_id"))
 		this->foursquareId = Ptr<std::string>(
-				new std::string(object.get("foursquare_id", "").asCString()));
+				new std::string(member(object, "foursquare_id").asCString()));
 
 	if (object.isMember("foursquare_type"))
 		this->foursquareType = Ptr<std::string>(
-				new std::string(object.get("foursquare_type", "").asCString()));
+				new std::string(member(object, "foursquare_type").asCString()));
 }
 
 tgbot::types::Invoice::Invoice(const Json::Value &object)
-		: title(object.get("title", "").asCString()),
-		  description(object.get("description", "").asCString()),
-		  startParameter(object.get("start_parameter", "").asCString()),
-		  currency(object.get("currency", "").asCString()),
-		  totalAmount(object.get("total_amount", "").asInt()) {}
+		: title(member(object, "title").asCString()),
+		  description(member(object, "description").asCString()),
+		  startParameter(member(object, "start_parameter").asCString()),
+		  currency(member(object, "currency").asCString()),
+		  totalAmount(member(object, "total_amount").asInt()) {}
 
 tgbot::types::SuccessfulPayment::SuccessfulPayment(const Json::Value &object)
-		: currency(object.get("currency", "").asCString()),
-		  invoicePayload(object.get("invoice_payload", "").asCString()),
+		: currency(member(object, "currency").asCString()),
+		  invoicePayload(member(object, "invoice_payload").asCString()),
 		  telegramPaymentChargeId(
-				  object.get("telegram_payment_charge_id", "").asCString()),
+				  member(object, "telegram_payment_charge_id").asCString()),
 		  providerPaymentChargeId(
-				  object.get("provider_payment_charge_id", "").asCString()),
-		  totalAmount(object.get("total_amount", "").asInt()) {
+				  member(object, "provider_payment_charge_id").asCString()),
+		  totalAmount(member(object, "total_amount").asInt()) {
 	if (object.isMember("shipping_option_id"))
 		this->shippingOptionId = Ptr<std::string>(
-				new std::string(object.get("shipping_option_id", "").asCString()));
+				new std::string(member(object, "shipping_option_id").asCString()));
 
 	if (object.isMember("order_info"))
 		this->orderInfo =
-				Ptr<OrderInfo>(new OrderInfo(object.get("order_info", "")));
+				Ptr<OrderInfo>(new OrderInfo(member(object, "order_info")));
 }
 
 tgbot::types::MessageEntity::MessageEntity(const Json::Value &object)
-		: offset(object.get("offset", "").asInt()),
-		  length(object.get("length", "").asInt()) {
-	const std::string &entityTypeStr = object.get("type", "").asString();
+		: offset(member(object, "offset").asInt()),
+		  length(member(object, "length").asInt()) {
+	const std::string &entityTypeStr = member(object, "type").asString();
 	if (entityTypeStr == "mention")
 		type = MessageEntityType::MENTION;
 	else if (entityTypeStr == "hashtag")
@@ -594,62 +779,62 @@ tgbot::types::MessageEntity::MessageEntity(const Json::Value &object)
 		type = MessageEntityType::PHONE_NUMBER;
 
 	if (object.isMember("user"))
-		this->user = Ptr<User>(new User(object.get("user", "")));
+		this->user = Ptr<User>(new User(member(object, "user")));
 
 	if (object.isMember("url"))
 		this->url =
-				Ptr<std::string>(new std::string(object.get("url", "").asCString()));
+				Ptr<std::string>(new std::string(member(object, "url").asCString()));
 }
 
 tgbot::types::OrderInfo::OrderInfo(const Json::Value &object) {
 	if (object.isMember("shipping_address"))
 		this->shippingAddress = Ptr<ShippingAddress>(
-				new ShippingAddress(object.get("shipping_address", "")));
+				new ShippingAddress(member(object, "shipping_address")));
 
 	if (object.isMember("name"))
 		this->name =
-				Ptr<std::string>(new std::string(object.get("name", "").asCString()));
+				Ptr<std::string>(new std::string(member(object, "name").asCString()));
 
 	if (object.isMember("phone_number"))
 		this->phoneNumber = Ptr<std::string>(
-				new std::string(object.get("phone_number", "").asCString()));
+				new std::string(member(object, "phone_number").asCString()));
 
 	if (object.isMember("email"))
 		this->email =
-				Ptr<std::string>(new std::string(object.get("email", "").asCString()));
+				Ptr<std::string>(new std::string(member(object, "email").asCString()));
 }
 
 tgbot::types::StickerSet::StickerSet(const Json::Value &object)
-		: name(object.get("name", "").asCString()),
-		  title(object.get("title", "").asCString()),
+		: name(member(object, "name").asCString()),
+		  title(member(object, "title").asCString()),
 		  stickers(std::vector<Sticker>{}),
-		  containsMasks(object.get("contains_masks", "").asBool()) {
-	for (auto const &singleSticker : object.get("stickers", ""))
+		  containsMasks(member(object, "contains_masks").asBool()) {
+	for (auto const &singleSticker : member(object, "stickers"))
 		stickers.emplace_back(singleSticker);
 }
 
 tgbot::types::ResponseParameters::ResponseParameters(
 		const Json::Value &object) {
 	if (object.isMember("migrate_to_chat_id"))
-		this->migrateToChatId = object.get("migrate_to_chat_id", "").asInt64();
+		this->migrateToChatId = member(object, "migrate_to_chat_id").asInt64();
 
 	if (object.isMember("retry_after"))
-		this->retryAfter = object.get("retry_after", "").asInt();
+		this->retryAfter = member(object, "retry_after").asInt();
 }
 
 tgbot::types::File::File(const Json::Value &object)
-		: fileId(object.get("file_id", "").asCString()) {
+		: fileId(member(object, "file_id").asCString()) {
 	if (object.isMember("file_size"))
-		this->fileSize = object.get("file_size", "").asInt();
+		this->fileSize = member(object, "file_size").asInt();
 
 	if (object.isMember("file_path"))
 		this->filePath = Ptr<std::string>(
-				new std::string(object.get("file_path", "").asCString()));
+				new std::string(member(object, "file_path").asCString()));
 }
 
 tgbot::types::UserProfilePhotos::UserProfilePhotos(const Json::Value &object)
-		: totalCount(object.get("total_count", "").asInt()) {
-	const Json::Value &matArr{object.get("photos", "")};
+		: totalCount(member(object, "total_count").asInt()) {
+	const Json::Value &matArr{member(object, "photos")};
 	for (ArrayIndex i = 0; i < matArr.size(); ++i) {
 		this->photos.emplace_back();
 		for (ArrayIndex j = 0; j < matArr[i].size(); ++j)
@@ -658,8 +843,8 @@ tgbot::types::UserProfilePhotos::UserProfilePhotos(const Json::Value &object)
 }
 
 tgbot::types::ChatMember::ChatMember(const Json::Value &object)
-		: user(object.get("user", "")) {
-	const std::string &statusStr{object.get("status", "").asString()};
+		: user(member(object, "user")) {
+	const std::string &statusStr{member(object, "status").asString()};
 	if (statusStr == "creator")
 		status = ChatMemberStatus::CREATOR;
 	else if (statusStr == "administrator")
@@ -674,109 +859,108 @@ tgbot::types::ChatMember::ChatMember(const Json::Value &object)
 		status = ChatMemberStatus::KICKED;
 
 	if (object.isMember("until_date"))
-		this->untilDate = object.get("until_date", "").asInt();
+		this->untilDate = member(object, "until_date").asInt();
 
 	if (object.isMember("can_be_edited"))
-		this->canBeEdited = object.get("can_be_edited", "").asBool();
+		this->canBeEdited = member(object, "can_be_edited").asBool();
 
 	if (object.isMember("can_change_info"))
-		this->canChangeInfo = object.get("can_change_info", "").asBool();
+		this->canChangeInfo = member(object, "can_change_info").asBool();
 
 	if (object.isMember("can_post_messages"))
-		this->canPostMessages = object.get("can_post_messages", "").asBool();
+		this->canPostMessages = member(object, "can_post_messages").asBool();
 
 	if (object.isMember("can_edit_messages"))
-		this->canEditMessages = object.get("can_edit_messages", "").asBool();
+		this->canEditMessages = member(object, "can_edit_messages").asBool();
 
 	if (object.isMember("can_delete_messages"))
-		this->canDeleteMessages = object.get("can_delete_messages", "").asBool();
+		this->canDeleteMessages = member(object, "can_delete_messages").asBool();
 
 	if (object.isMember("can_invite_users"))
-		this->canInviteUsers = object.get("can_invite_users", "").asBool();
+		this->canInviteUsers = member(object, "can_invite_users").asBool();
 
 	if (object.isMember("can_restrict_members"))
-		this->canRestrictMembers = object.get("can_restrict_members", "").asBool();
+		this->canRestrictMembers = member(object, "can_restrict_members").asBool();
 
 	if (object.isMember("can_pin_messages"))
-		this->canPinMessages = object.get("can_pin_messages", "").asBool();
+		this->canPinMessages = member(object, "can_pin_messages").asBool();
 
 	if (object.isMember("can_promote_members"))
-		this->canPromoteMembers = object.get("can_promote_members", "").asBool();
+		this->canPromoteMembers = member(object, "can_promote_members").asBool();
 
 	if (object.isMember("can_send_messages"))
-		this->canSendMessages = object.get("can_send_messages", "").asBool();
+		this->canSendMessages = member(object, "can_send_messages").asBool();
 
 	if (object.isMember("can_send_media_messages"))
 		this->canSendMediaMessages =
-				object.get("can_send_media_messages", "").asBool();
+				member(object, "can_send_media_messages").asBool();
 
 	if (object.isMember("can_send_other_messages"))
 		this->canSendOtherMessages =
-				object.get("can_send_other_messages", "").asBool();
+				member(object, "can_send_other_messages").asBool();
 
 	if (object.isMember("can_add_web_page_previews"))
 		this->canAddWebPagePreviews =
-				object.get("can_add_web_page_previews", "").asBool();
+				member(object, "can_add_web_page_previews").asBool();
 
 	if (object.isMember("is_member"))
 		this->isMember =
-				object.get("is_member","").asBool();
+				member(object, "is_member").asBool();
 }
 
 tgbot::types::Animation::Animation(const Json::Value &object)
-		: fileId(object.get("file_id", "").asCString()) {
+		: fileId(member(object, "file_id").asCString()) {
 	if (object.isMember("file_size"))
-		this->fileSize = object.get("file_size", "").asInt();
+		this->fileSize = member(object, "file_size").asInt();
 
 	if (object.isMember("thumb"))
-		this->thumb = Ptr<PhotoSize>(new PhotoSize(object.get("thumb", "")));
+		this->thumb = Ptr<PhotoSize>(new PhotoSize(member(object, "thumb")));
 
 	if (object.isMember("file_name"))
 		this->fileName = Ptr<std::string>(
-				new std::string(object.get("file_name", "").asCString()));
+				new std::string(member(object, "file_name").asCString()));
 
 	if (object.isMember("mime_type"))
-		this->mimeType = Ptr<std::string>(
-				new std::string(object.get("mime_type", "").asCString()));
+		this->mimeType = sharedString(object, "mime_type");
 }
 
 tgbot::types::WebhookInfo::WebhookInfo(const Json::Value &object)
-		: url(object.get("url", "").asCString()),
-		  pendingUpdateCount(object.get("pending_update_count", "").asInt()),
-		  hasCustomCertificate(object.get("has_custom_certificate", "").asBool()) {
+		: url(member(object, "url").asCString()),
+		  pendingUpdateCount(member(object, "pending_update_count").asInt()),
+		  hasCustomCertificate(member(object, "has_custom_certificate").asBool()) {
 	if (object.isMember("last_error_date"))
-		this->lastErrorDate = object.get("last_error_date", "").asInt();
+		this->lastErrorDate = member(object, "last_error_date").asInt();
 
 	if (object.isMember("last_error_message"))
 		this->lastErrorMessage = Ptr<std::string>(
-				new std::string(object.get("last_error_message", "").asCString()));
+				new std::string(member(object, "last_error_message").asCString()));
 
 	if (object.isMember("max_connections"))
-		this->maxConnections = object.get("max_connections", "").asInt();
+		this->maxConnections = member(object, "max_connections").asInt();
 
 	if (object.isMember("allowed_updates")) {
 		this->allowedUpdates =
 				Ptr<std::vector<std::string>>(new std::vector<std::string>{});
-		for (auto const &singleAllowedUpdate : object.get("allowed_updates", ""))
+		for (auto const &singleAllowedUpdate : member(object, "allowed_updates"))
 			this->allowedUpdates->emplace_back(singleAllowedUpdate.asCString());
 	}
 }
 
 tgbot::types::GameHighScore::GameHighScore(const Json::Value &object)
-		: user(object.get("user", "")),
-		  position(object.get("position", "").asInt()),
-		  score(object.get("score", "").asInt()) {}
+		: user(member(object, "user")),
+		  position(member(object, "position").asInt()),
+		  score(member(object, "score").asInt()) {}
 
 tgbot::types::PollOptions::PollOptions(const Json::Value &object)
-		: text(object.get("text", "").asCString()),
-		  voterCount(object.get("voter_count","").asInt()){}
+		: text(member(object, "text").asCString()),
+		  voterCount(member(object, "voter_count").asInt()){}
 
 
 tgbot::types::Poll::Poll(const Json::Value &object)
-		: question(object.get("question","").asCString()),
-		  id(object.get("id","").asInt()),
-		  isClosed(object.get("is_closed","").asBool()){
+		: question(member(object, "question").asCString()),
+		  id(member(object, "id").asInt()),
+		  isClosed(member(object, "is_closed").asBool()){
 
-	for(auto const& option : object.get("options",""))
+	for(auto const& option : member(object, "options"))
 		options.emplace_back(option);
 }
@@ -0,0 +1,142 @@
+#include <json/json.h>
+#include <tgbot/update_filter.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+using tgbot::filters::UpdateFilter;
+
+static const char *messageKinds[] = {"message", "edited_message", "channel_post",
+                                     "edited_channel_post"};
+
+static bool hasEntityOfType(const Json::Value &entities, const std::string &type) {
+	if (!entities.isArray()) return false;
+
+	for (const auto &entity : entities) {
+		const Json::Value &entityType = entity["type"];
+		if (entityType.isString() && entityType.asString() == type) return true;
+	}
+
+	return false;
+}
+
+static bool sameLetter(char a, char b) {
+	return std::tolower(static_cast<unsigned char>(a)) ==
+	       std::tolower(static_cast<unsigned char>(b));
+}
+
+// mention followed by a non username character (@bot, not @bot_two);
+// usernames are ASCII and case insensitive (@MyBot is @mybot)
+static bool containsMention(const std::string &text, const std::string &mention) {
+	for (auto at = std::search(text.begin(), text.end(), mention.begin(),
+	                           mention.end(), sameLetter);
+	     at != text.end();
+	     at = std::search(at + 1, text.end(), mention.begin(), mention.end(),
+	                      sameLetter)) {
+		const auto after = at + static_cast<std::ptrdiff_t>(mention.size());
+		if (after == text.end() ||
+		    !(std::isalnum(static_cast<unsigned char>(*after)) || *after == '_'))
+			return true;
+	}
+
+	return false;
+}
+
+const Json::Value *tgbot::filters::messageOf(const Json::Value &update) {
+	for (const char *kind : messageKinds) {
+		const Json::Value *message = update.find(kind, kind + std::strlen(kind));
+		if (message && message->isObject()) return message;
+	}
+
+	return nullptr;
+}
+
+std::string tgbot::filters::updateTypeOf(const Json::Value &update) {
+	for (auto member = update.begin(); member != update.end(); ++member)
+		if (member.name() != "update_id") return member.name();
+
+	return "unknown";
+}
+
+UpdateFilter tgbot::filters::commands() {
+	return [](const Json::Value &update) {
+		const Json::Value *message = messageOf(update);
+		if (!message) return true;
+
+		const Json::Value &text = (*message)["text"];
+		if (!text.isString()) return false;
+
+		const char *begin;
+		const char *end;
+		return text.getString(&begin, &end) && begin != end && *begin == '/';
+	};
+}
+
+UpdateFilter tgbot::filters::privateChats() {
+	return [](const Json::Value &update) {
+		const Json::Value *message = messageOf(update);
+		if (!message) return true;
+
+		const Json::Value &chatType = (*message)["chat"]["type"];
+		return chatType.isString() && chatType.asString() == "private";
+	};
+}
+
+UpdateFilter tgbot::filters::chats(std::vector<long long> chatIds) {
+	std::sort(chatIds.begin(), chatIds.end());
+
+	return [chatIds](const Json::Value &update) {
+		const Json::Value *message = messageOf(update);
+		if (!message) return true;
+
+		const Json::Value &chatId = (*message)["chat"]["id"];
+		return chatId.isIntegral() &&
+		       std::binary_search(chatIds.begin(), chatIds.end(),
+		                          static_cast<long long>(chatId.asInt64()));
+	};
+}
+
+UpdateFilter tgbot::filters::withEntity(std::string entityType) {
+	return [entityType](const Json::Value &update) {
+		const Json::Value *message = messageOf(update);
+		if (!message) return true;
+
+		return hasEntityOfType((*message)["entities"], entityType) ||
+		       hasEntityOfType((*message)["caption_entities"], entityType);
+	};
+}
+
+UpdateFilter tgbot::filters::mentioning(const std::string &username) {
+	const std::string mention = "@" + username;
+
+	return [mention](const Json::Value &update) {
+		const Json::Value *message = messageOf(update);
+		if (!message) return true;
+
+		for (const char *field : {"text", "caption"}) {
+			const Json::Value &text = (*message)[field];
+			if (text.isString() && containsMention(text.asString(), mention))
+				return true;
+		}
+
+		return false;
+	};
+}
+
+UpdateFilter tgbot::filters::anyOf(std::vector<UpdateFilter> any) {
+	return [any](const Json::Value &update) {
+		for (const auto &filter : any)
+			if (filter(update)) return true;
+
+		return false;
+	};
+}
+
+UpdateFilter tgbot::filters::allOf(std::vector<UpdateFilter> all) {
+	return [all](const Json::Value &update) {
+		for (const auto &filter : all)
+			if (!filter(update)) return false;
+
+		return true;
+	};
+}
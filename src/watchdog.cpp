@@ -0,0 +1,133 @@
+#include <tgbot/metrics.h>
+#include <tgbot/watchdog.h>
+#include <unordered_map>
+
+namespace metrics = tgbot::metrics;
+
+namespace {
+
+	struct Tracked {
+		tgbot::InFlightHandler handler;
+		tgbot::utils::CancelToken cancelToken;
+	};
+
+}  // namespace
+
+static std::mutex trackedMutex;
+static std::unordered_map<std::uint64_t, Tracked> tracked;
+static std::uint64_t lastTrackedId{0};
+
+std::uint64_t tgbot::__handlerStarted(int updateId,
+                                      types::UpdateType updateType,
+                                      const utils::CancelToken &cancelToken) {
+	const Tracked entry{
+			InFlightHandler{updateId, updateType, std::chrono::steady_clock::now(),
+			                false, false},
+			cancelToken};
+
+	std::lock_guard<std::mutex> guard(trackedMutex);
+	tracked.emplace(++lastTrackedId, entry);
+	return lastTrackedId;
+}
+
+void tgbot::__handlerFinished(std::uint64_t id) {
+	std::lock_guard<std::mutex> guard(trackedMutex);
+	tracked.erase(id);
+}
+
+std::vector<tgbot::InFlightHandler> tgbot::inFlightHandlers() {
+	std::vector<InFlightHandler> handlers;
+
+	std::lock_guard<std::mutex> guard(trackedMutex);
+	handlers.reserve(tracked.size());
+	for (auto const &entry : tracked) handlers.push_back(entry.second.handler);
+
+	return handlers;
+}
+
+tgbot::Watchdog::Watchdog(const Logger &_logger,
+                          std::chrono::milliseconds _budget,
+                          std::chrono::milliseconds _hardDeadline,
+                          std::chrono::milliseconds _checkInterval)
+		: logger(_logger), budget(_budget), hardDeadline(_hardDeadline),
+		  checkInterval(_checkInterval) {}
+
+tgbot::Watchdog::~Watchdog() { stop(); }
+
+void tgbot::Watchdog::start() {
+	if (running.exchange(true)) return;
+	checker = std::thread(&Watchdog::run, this);
+}
+
+void tgbot::Watchdog::stop() {
+	if (!running.exchange(false)) return;
+
+	{
+		std::lock_guard<std::mutex> guard(waitMutex);
+		wakeUp.notify_one();
+	}
+
+	checker.join();
+}
+
+void tgbot::Watchdog::run() {
+	std::unique_lock<std::mutex> lock(waitMutex);
+
+	while (running.load()) {
+		wakeUp.wait_for(lock, checkInterval, [this] { return !running.load(); });
+		if (running.load()) check();
+	}
+}
+
+static std::string describe(const tgbot::InFlightHandler &handler,
+                            std::chrono::steady_clock::time_point now) {
+	return std::string(tgbot::types::updateTypeName(handler.updateType)) +
+	       " handler for update " + std::to_string(handler.updateId) +
+	       " running for " +
+	       std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(
+			       now - handler.start).count()) + "ms";
+}
+
+void tgbot::Watchdog::check() {
+	const auto now = std::chrono::steady_clock::now();
+	std::vector<InFlightHandler> overBudget;
+	std::vector<InFlightHandler> cancelled;
+
+	{
+		std::lock_guard<std::mutex> guard(trackedMutex);
+
+		for (auto &entry : tracked) {
+			InFlightHandler &handler = entry.second.handler;
+			const auto elapsed = now - handler.start;
+
+			if (!handler.overBudget && elapsed > budget) {
+				handler.overBudget = true;
+				overBudget.push_back(handler);
+			}
+
+			if (!handler.cancelled && hardDeadline.count() && elapsed > hardDeadline) {
+				handler.cancelled = true;
+				entry.second.cancelToken.cancel();
+				cancelled.push_back(handler);
+			}
+		}
+	}
+
+	metrics::Registry &registry = metrics::Registry::global();
+
+	for (auto const &handler : overBudget) {
+		registry.counter("tgbot_handlers_over_budget_total",
+		                 metrics::label("type", types::updateTypeName(handler.updateType)),
+		                 "Handlers which exceeded the watchdog budget")
+				.increment();
+		logger.warn("slow " + describe(handler, now));
+	}
+
+	for (auto const &handler : cancelled) {
+		registry.counter("tgbot_handlers_cancelled_total",
+		                 metrics::label("type", types::updateTypeName(handler.updateType)),
+		                 "Handlers whose transfers got cancelled by the watchdog")
+				.increment();
+		logger.error("cancelling transfers of " + describe(handler, now));
+	}
+}
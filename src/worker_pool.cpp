@@ -0,0 +1,114 @@
+#include <tgbot/metrics.h>
+#include <tgbot/utils/worker_pool.h>
+#include <stdexcept>
+
+tgbot::utils::WorkerPool::WorkerPool(std::size_t nThreads)
+		: state(std::make_shared<State>()) {
+	if (!nThreads) nThreads = 1;
+
+	workers.reserve(nThreads);
+	for (std::size_t i = 0; i < nThreads; ++i)
+		workers.emplace_back(&WorkerPool::run, state);
+}
+
+tgbot::utils::WorkerPool::~WorkerPool() { join(); }
+
+void tgbot::utils::WorkerPool::join() {
+	{
+		std::lock_guard<std::mutex> guard(state->mtx);
+		state->stopping = true;
+	}
+
+	state->ready.notify_all();
+
+	// called from a task: can't join the worker running it
+	const std::thread::id self = std::this_thread::get_id();
+	for (auto &worker : workers) {
+		if (worker.get_id() == self)
+			worker.detach();
+		else if (worker.joinable())
+			worker.join();
+	}
+
+	workers.clear();
+}
+
+std::size_t tgbot::utils::WorkerPool::addQueue(const std::string &labels) {
+	metrics::Registry &registry = metrics::Registry::global();
+
+	Queue queue;
+	queue.depth = &registry.gauge("tgbot_worker_queue_depth", labels,
+	                              "Tasks waiting for a worker");
+	queue.wait = &registry.histogram("tgbot_worker_queue_wait_seconds", labels,
+	                                 "Time tasks waited for a worker");
+	queue.errors = &registry.counter("tgbot_worker_task_errors_total", labels,
+	                                 "Tasks that threw an exception");
+
+	std::lock_guard<std::mutex> guard(state->mtx);
+	state->queues.push_back(std::move(queue));
+	return state->queues.size() - 1;
+}
+
+void tgbot::utils::WorkerPool::submit(std::size_t queue,
+                                      std::function<void()> task) {
+	{
+		std::lock_guard<std::mutex> guard(state->mtx);
+		if (queue >= state->queues.size())
+			throw std::out_of_range("no such worker queue");
+
+		if (state->stopping) throw std::logic_error("worker pool joined");
+
+		state->queues[queue].tasks.push_back(
+				Task{std::move(task), std::chrono::steady_clock::now()});
+		state->queues[queue].depth->add();
+		++state->nQueued;
+	}
+
+	state->ready.notify_one();
+}
+
+std::size_t tgbot::utils::WorkerPool::pending(std::size_t queue) const {
+	std::lock_guard<std::mutex> guard(state->mtx);
+	return queue < state->queues.size() ? state->queues[queue].tasks.size() : 0;
+}
+
+void tgbot::utils::WorkerPool::run(std::shared_ptr<State> state) {
+	std::unique_lock<std::mutex> lock(state->mtx);
+
+	while (true) {
+		state->ready.wait(lock,
+		                  [&state] { return state->nQueued || state->stopping; });
+		if (!state->nQueued) return;  // stopping, nothing left
+
+		// round-robin: next non-empty queue after the last one served
+		std::vector<Queue> &queues = state->queues;
+		while (queues[state->nextQueue].tasks.empty())
+			state->nextQueue = (state->nextQueue + 1) % queues.size();
+
+		const std::size_t served = state->nextQueue;
+		Queue &queue = queues[served];
+		Task task = std::move(queue.tasks.front());
+		queue.tasks.pop_front();
+		queue.depth->sub();
+		queue.wait->record(metrics::microsSince(task.queued));
+		--state->nQueued;
+
+		state->nextQueue = (state->nextQueue + 1) % queues.size();
+
+		lock.unlock();
+		bool failed = false;
+		try {
+			task.run();
+		} catch (...) {
+			// would terminate the process: counted in the queue's errors
+			failed = true;
+		}
+
+		// may destroy the pool (last Bot copy): state is still ours
+		task.run = nullptr;
+		lock.lock();
+
+		// queues never shrink, served is still valid
+		if (failed) queues[served].errors->increment();
+	}
+}